@@ -48,9 +48,10 @@ namespace Song {
   static constexpr uint8_t BITS_PER_POT = 7;          // 0-127 range
   static constexpr uint8_t NUM_POTS = 4;              // Per event
 
-  // Memory calculations
+  // Memory calculations (checked against sizeof in Track.h and Pattern.h)
   static constexpr size_t EVENT_SIZE = 4;             // bytes
-  static constexpr size_t TRACK_SIZE = EVENT_SIZE * NUM_STEPS;
+  static constexpr size_t SWITCH_MASK_SIZE = 4;       // uint16_t, padded to Event alignment
+  static constexpr size_t TRACK_SIZE = EVENT_SIZE * NUM_STEPS + SWITCH_MASK_SIZE;
   static constexpr size_t PATTERN_SIZE = TRACK_SIZE * NUM_TRACKS;
   static constexpr size_t SONG_SIZE = PATTERN_SIZE * NUM_PATTERNS * NUM_MODES;
 }
@@ -72,8 +73,36 @@ namespace MIDI {
   // MIDI Clock
   static constexpr uint8_t PULSES_PER_QUARTER = 24;   // PPQN
 
-  // Scheduler
+  // Scheduler pool (MIDIScheduler<>, TimingWheel<>). The sequencer's
+  // scheduler adds one worst-case step of its modes and their live tails
+  // to this (Sequencer::SCHEDULER_CAPACITY)
   static constexpr uint8_t MAX_SCHEDULED_EVENTS = 64;
+
+  // Generators (MIDIScheduler recurrences). One lives for its whole tail,
+  // which outlasts the step that started it by many steps (a Mode4
+  // arpeggio runs up to 16 x 400 ms, a Mode3 echo run up to 127 delays),
+  // so the pool holds tails from earlier steps too. A track keeps at most
+  // MAX_TAILS_PER_TRACK overlapping tails (a newer one evicts its oldest);
+  // the pool has that many for each track of the two recurring modes
+  static constexpr uint8_t MAX_TAILS_PER_TRACK = 2;
+  static constexpr uint8_t MAX_GENERATORS = 2 * Song::NUM_TRACKS * MAX_TAILS_PER_TRACK;
+
+  // Recording buffer (MIDIEventBuffer<>): events per step, all modes combined
+  static constexpr uint8_t MAX_BUFFERED_EVENTS = 32;
+
+  // Fewer free slots than this signals backpressure to the sequencer, for
+  // a pool of MAX_SCHEDULED_EVENTS (MIDIScheduler scales it with its size)
+  static constexpr uint8_t BACKPRESSURE_FREE_SLOTS = 8;
+
+  // Events due within this window are handed to the dispatch interrupt,
+  // which sends them at their exact time (covers main loop jitter)
+  static constexpr uint32_t DISPATCH_LOOKAHEAD_US = 2000;
+
+  // Output bandwidth: CCs are deferred or thinned beyond this rate (one
+  // full-speed USB packet of 16 events per 1 ms frame); clock and notes
+  // always go out
+  static constexpr uint16_t OUTPUT_BUDGET_PER_MS = 16;
+  static constexpr uint16_t OUTPUT_BURST = 32;
 }
 
 // ============================================================================
@@ -89,13 +118,41 @@ namespace Timing {
   // Step timing
   static constexpr uint8_t STEPS_PER_BEAT = 4;        // 16th notes
 
+  // Intervals are fixed point microseconds (Q24.8) so the fractional part
+  // accumulates instead of being truncated (an 18.75 ms step stays 18.75 ms)
+  static constexpr uint8_t INTERVAL_FRACTION_BITS = 8;
+  static constexpr double MICROS_PER_MINUTE = 60000000.0;
+
+  // Master tick: steps, MIDI clock and sub-step placement all derive from
+  // one tick counter. 96 PPQN = 24 ticks per step (divisible by 2, 3, 4, 6)
+  static constexpr uint16_t MASTER_PPQN = 96;
+  static constexpr uint8_t TICKS_PER_STEP = MASTER_PPQN / STEPS_PER_BEAT;
+  static constexpr uint8_t TICKS_PER_CLOCK = MASTER_PPQN / MIDI::PULSES_PER_QUARTER;
+  static_assert(MASTER_PPQN % STEPS_PER_BEAT == 0, "Steps must fall on master ticks");
+  static_assert(MASTER_PPQN % MIDI::PULSES_PER_QUARTER == 0, "Clock must fall on master ticks");
+
+  // Step clock interrupt: polls the master tick, so tick jitter is at most
+  // one period regardless of main loop load
+  static constexpr uint32_t TICK_ISR_PERIOD_US = 100;
+
+  // Main loop stalls: a step picked up more than STALL_THRESHOLD_US after
+  // its tick counts as missed and is handled by the catch-up policy.
+  // COMPRESS replays missed steps within CATCHUP_WINDOW_US
+  static constexpr uint32_t STALL_THRESHOLD_US = 10000;
+  static constexpr uint32_t CATCHUP_WINDOW_US = 20000;
+
   // Calculations
-  inline constexpr unsigned long calculateStepInterval(float bpm) {
-    return static_cast<unsigned long>((60000.0f / bpm) / STEPS_PER_BEAT);
+  inline constexpr uint32_t calculateBeatInterval(float bpm) {
+    return static_cast<uint32_t>(
+        (MICROS_PER_MINUTE / bpm) * (1 << INTERVAL_FRACTION_BITS) + 0.5);
+  }
+
+  inline constexpr uint32_t calculateStepInterval(float bpm) {
+    return calculateBeatInterval(bpm) / STEPS_PER_BEAT;
   }
 
-  inline constexpr unsigned long calculateClockInterval(float bpm) {
-    return static_cast<unsigned long>((60000.0f / bpm) / MIDI::PULSES_PER_QUARTER);
+  inline constexpr uint32_t calculateClockInterval(float bpm) {
+    return calculateBeatInterval(bpm) / MIDI::PULSES_PER_QUARTER;
   }
 }
 
@@ -147,7 +204,7 @@ namespace Debug {
   static constexpr uint8_t CC_PATTERN = 2;
   static constexpr uint8_t CC_TRACK = 3;
 
-  // Slider CCs (on drum machine channel)
+  // Slider CCs (on channel 16)
   static constexpr uint8_t CC_SLIDER_BASE = 20;     // CCs 20-23
 
   // Update intervals
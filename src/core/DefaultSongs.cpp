@@ -3,7 +3,7 @@
 void DefaultSongs::setEvent(Pattern& pattern, uint8_t track, uint8_t step,
                            bool sw, uint8_t pot0, uint8_t pot1,
                            uint8_t pot2, uint8_t pot3) {
-  Event& e = pattern[track][step];
+  EventRef e = pattern[track][step];
   e.setSwitch(sw);
   e.setPot(0, pot0);  // Velocity
   e.setPot(1, pot1);  // Pan
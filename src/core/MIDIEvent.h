@@ -3,33 +3,71 @@
 
 #include <stdint.h>
 #include "Constants.h"
+#include "SlotMask.h"
 
 /**
  * MIDIEvent - A scheduled MIDI message
  *
  * Represents a single MIDI message to be sent at a specific delta time.
  * Pure data structure with no behavior - perfect for functional programming.
+ *
+ * Packed into 8 bytes on every target (12-16 unpacked on ARM and 64-bit
+ * hosts): one word of bit fields, one word of time. Data bytes are 7 bits,
+ * as on the wire, and clamped to 127 rather than wrapped; the channel keeps a fifth bit so an out-of-range channel
+ * (0, 17+) is still seen and rejected by the scheduler rather than wrapped
+ * onto a valid one.
  */
 struct MIDIEvent {
   enum Type : uint8_t {
     NOTE_ON = 0,
     NOTE_OFF = 1,
     CC = 2,
-    STOP_ALL = 3
+    STOP_ALL = 3,
+    TIE = 4,       // Hold a note: extend its pending NOTE_OFF, or start it
+    RECUR = 5      // A run of notes (data1: MIDIEventBuffer recurrence index)
+  };
+
+  /**
+   * Priority class, highest last. When the scheduler overflows, the
+   * lowest class loses first: a stuck note is worse than a missing hit,
+   * a missing hit worse than a late CC.
+   */
+  enum Priority : uint8_t {
+    PRIORITY_DEBUG = 0,    // Debug/UI CCs
+    PRIORITY_CC = 1,       // Musical CCs
+    PRIORITY_NOTE_ON = 2,
+    PRIORITY_NOTE_OFF = 3  // Note offs and all-notes-off
   };
+  static constexpr uint8_t NUM_PRIORITIES = 4;
+
+  /**
+   * Origin of a scheduled event: the (mode, track) that produced it, so a
+   * pattern change can cancel that track's pending events
+   */
+  static constexpr uint8_t NO_ORIGIN = 0xFF;
+  static constexpr uint8_t ALL_TRACKS = 0xFF;
+
+  static uint8_t makeOrigin(uint8_t mode, uint8_t track) {
+    return (uint8_t)((mode << 3) | (track & 0x07));
+  }
 
-  Type type;
-  uint8_t channel;       // MIDI channel (1-16)
-  uint8_t data1;         // Note/controller number (0-127)
-  uint8_t data2;         // Velocity/value (0-127)
-  unsigned long delta;   // Delay from current time (ms)
+  uint32_t type : 4;      // Type
+  uint32_t channel : 5;   // MIDI channel (1-16)
+  uint32_t data1 : 7;     // Note/controller number (0-127)
+  uint32_t data2 : 7;     // Velocity/value (0-127)
+  uint32_t inTicks : 1;   // delta is in master ticks, not microseconds
+  uint32_t origin : 8;    // makeOrigin() of the producer, or NO_ORIGIN
+  uint32_t delta;         // Delay from current time (us, or ticks if inTicks)
 
   // Default constructor
-  MIDIEvent() : type(NOTE_ON), channel(1), data1(0), data2(0), delta(0) {}
+  MIDIEvent() : type(NOTE_ON), channel(1), data1(0), data2(0), inTicks(0), origin(NO_ORIGIN), delta(0) {}
 
-  // Parameterized constructor
+  // Parameterized constructor (data bytes above 127 are clamped)
   MIDIEvent(Type t, uint8_t ch, uint8_t d1, uint8_t d2, unsigned long d)
-    : type(t), channel(ch), data1(d1), data2(d2), delta(d) {}
+    : type(t), channel(ch), data1(GRUVBOK::clampMIDIValue(d1)),
+      data2(GRUVBOK::clampMIDIValue(d2)), inTicks(0), origin(NO_ORIGIN), delta((uint32_t)d) {}
+
+  Type getType() const { return (Type)type; }
 
   // Factory methods for clarity
   static MIDIEvent noteOn(uint8_t channel, uint8_t note, uint8_t velocity, unsigned long delta = 0) {
@@ -47,37 +85,215 @@ struct MIDIEvent {
   static MIDIEvent stopAll(uint8_t channel, unsigned long delta = 0) {
     return MIDIEvent(STOP_ALL, channel, 0, 0, delta);
   }
+
+  /**
+   * Legato: keep the note sounding until delta. Extends the pending
+   * NOTE_OFF of the same note from the same track; if there is none, the
+   * note starts now with this velocity.
+   */
+  static MIDIEvent tie(uint8_t channel, uint8_t note, uint8_t velocity, unsigned long delta) {
+    return MIDIEvent(TIE, channel, note, velocity, delta);
+  }
+
+  /**
+   * Default priority class of an event type
+   */
+  static Priority priorityOf(Type type) {
+    switch (type) {
+      case NOTE_OFF:
+      case STOP_ALL:
+        return PRIORITY_NOTE_OFF;
+      case NOTE_ON:
+      case TIE:
+      case RECUR:
+        return PRIORITY_NOTE_ON;
+      case CC:
+      default:
+        return PRIORITY_CC;
+    }
+  }
+
+  Priority getPriority() const { return priorityOf(getType()); }
 };
 
+static_assert(sizeof(MIDIEvent) == 8, "MIDIEvent is two 32-bit words");
+
 /**
- * MIDIEventBuffer - Fixed-size buffer for MIDI events
+ * Recurrence - A run of notes the scheduler generates one at a time
  *
- * Embedded-friendly event collection with no dynamic allocation.
- * Modes return events into this buffer, then sequencer schedules them all.
+ * An echo tail or arpeggio as a rule instead of a list of events. The
+ * scheduler keeps it in one slot and only makes the next note when it is
+ * due, so a 16-note tail costs one slot, not 32, and can still be
+ * cancelled or follow the tempo like any other event.
  *
- * Design principles:
- * - Fixed size (stack-allocated)
- * - No dynamic memory
- * - Bounds checking
- * - Simple iterator interface
+ * Note i (0 to count-1):
+ * - Pitch: degree firstDegree + i * degreeStep of the scale on root,
+ *   folded into 'octaves' octaves if non-zero, clamped to 0-127. With the
+ *   chromatic scale, degrees are semitones
+ * - Velocity: the previous one times velocityScale/256 plus velocityStep,
+ *   no lower than minVelocity
+ * - Time: start (the event delta), then intervals of interval,
+ *   interval * growth, interval * growth^2, ...
+ * - Length: length
+ * Times are microseconds, or master ticks if added with recurTicks().
  */
-class MIDIEventBuffer {
-private:
-  static constexpr uint8_t MAX_EVENTS = 32;  // Per step, all modes combined
-  MIDIEvent events[MAX_EVENTS];
-  uint8_t count;
+struct Recurrence {
+  static constexpr uint16_t CHROMATIC = 0x0FFF;  // Bit n: n semitones above root
+
+  uint8_t channel;
+  uint8_t root;
+  uint16_t scale;          // Pitch classes in the scale, bit 0 = root
+  int8_t firstDegree;
+  int8_t degreeStep;
+  uint8_t octaves;         // Degrees wrap after this many octaves (0 = never)
+  uint8_t count;           // Notes in the run
+  uint8_t velocity;        // Of the first note
+  int8_t velocityStep;
+  uint8_t minVelocity;
+  uint16_t velocityScale;  // 256 = unchanged
+  uint8_t growth;          // Interval multiplier per note (1 = even spacing)
+  uint32_t interval;
+  uint32_t length;
+
+  Recurrence()
+    : channel(1), root(60), scale(CHROMATIC), firstDegree(0), degreeStep(0), octaves(0),
+      count(1), velocity(100), velocityStep(0), minVelocity(1), velocityScale(256),
+      growth(1), interval(0), length(0) {}
+
+  /**
+   * Pitch of note 'index'
+   */
+  uint8_t pitchAt(uint8_t index) const {
+    int16_t perOctave = (int16_t)__builtin_popcount(scale & CHROMATIC);
+    if (perOctave == 0) return root;
+
+    int16_t degree = firstDegree + (int16_t)degreeStep * index;
+    if (octaves != 0) {
+      int16_t span = perOctave * octaves;
+      degree %= span;
+      if (degree < 0) degree += span;
+    }
+    int16_t octave = degree >= 0 ? degree / perOctave : -((perOctave - 1 - degree) / perOctave);
+    int16_t position = degree - octave * perOctave;
+
+    // Semitone of the position-th pitch class in the scale
+    uint8_t semitone = 0;
+    for (uint16_t bits = scale & CHROMATIC; ; bits &= bits - 1) {
+      if (position-- == 0) {
+        semitone = (uint8_t)__builtin_ctz(bits);
+        break;
+      }
+    }
+
+    int16_t pitch = root + octave * 12 + semitone;
+    if (pitch < 0) return 0;
+    if (pitch > 127) return 127;
+    return (uint8_t)pitch;
+  }
+
+  /**
+   * Velocity of the note after one of velocity 'previous'
+   */
+  uint8_t nextVelocity(uint8_t previous) const {
+    int16_t v = (int16_t)(((uint32_t)previous * velocityScale) >> 8) + velocityStep;
+    if (v < minVelocity) v = minVelocity;
+    if (v > 127) v = 127;
+    return (uint8_t)v;
+  }
+};
+
+/**
+ * EventSink - What a mode writes its MIDI events into
+ *
+ * A sink is any class deriving from EventSink<Sink> that provides
+ *   bool write(const MIDIEvent& event);
+ *   bool writeRecurrence(const Recurrence& rule, const MIDIEvent& start);
+ * The events arrive with origin and inTicks filled in; 'start' is the
+ * RECUR event placing the run.
+ * Modes are templates over the sink (see ModeBase), so each call below
+ * is one direct write into the sink's own storage: the scheduler's slots
+ * (SchedulerSink), or a list kept for tests (MIDIEventBuffer).
+ *
+ * The sink also carries the current tempo, so modes can place events on
+ * the master tick grid with ticks() instead of assuming 120 BPM, and the
+ * origin (mode, track) of the events being written (setOrigin()).
+ *
+ * Events added with the *Ticks() methods keep their delta in master ticks.
+ * The scheduler turns them into time only when they are about to go out,
+ * so long tails (Mode3 echoes) follow a tempo change made after they were
+ * scheduled. Plain deltas are microseconds and stay fixed.
+ *
+ * recur()/recurTicks() add a Recurrence, a whole run of notes.
+ *
+ * A write the sink cannot take is counted (getOverflowCount()) rather
+ * than lost silently; the calls also return false.
+ */
+template<typename Sink>
+class EventSink {
+protected:
+  uint8_t origin;         // Of the events being written
+  uint32_t beatInterval;  // Q24.8 microseconds per quarter note
+  uint16_t overflows;     // Writes the sink could not take
+
+  EventSink()
+    : origin(MIDIEvent::NO_ORIGIN),
+      beatInterval(GRUVBOK::Timing::calculateBeatInterval(GRUVBOK::Timing::DEFAULT_BPM)),
+      overflows(0) {}
 
 public:
-  MIDIEventBuffer() : count(0) {}
+  /**
+   * Mark the events written from now on as coming from (mode, track)
+   */
+  void setOrigin(uint8_t mode, uint8_t track) {
+    origin = MIDIEvent::makeOrigin(mode, track);
+  }
 
   /**
-   * Add an event to the buffer
-   * @return true if added, false if buffer full
+   * Set the tempo used by ticks()
+   * @param q8Micros Microseconds per quarter note, Q24.8 fixed point
+   */
+  void setBeatInterval(uint32_t q8Micros) {
+    beatInterval = q8Micros;
+  }
+
+  /**
+   * Convert a delay in master ticks to a delta in microseconds
+   * (TICKS_PER_STEP ticks = one step at the current tempo)
+   */
+  unsigned long ticks(uint32_t numTicks) const {
+    return (unsigned long)(((uint64_t)numTicks * beatInterval) /
+                           ((uint32_t)GRUVBOK::Timing::MASTER_PPQN << GRUVBOK::Timing::INTERVAL_FRACTION_BITS));
+  }
+
+  /**
+   * Convert a delta in microseconds to whole master ticks at the current
+   * tempo, rounded up (inverse of ticks())
+   */
+  uint32_t toTicks(unsigned long micros) const {
+    uint64_t units = (uint64_t)micros *
+                     ((uint32_t)GRUVBOK::Timing::MASTER_PPQN << GRUVBOK::Timing::INTERVAL_FRACTION_BITS);
+    return (uint32_t)((units + beatInterval - 1) / beatInterval);
+  }
+
+  /**
+   * Writes the sink could not take since it was created or cleared
+   */
+  uint16_t getOverflowCount() const { return overflows; }
+
+  /**
+   * Add an event
+   * @return true if taken, false if the sink is full
    */
   bool add(const MIDIEvent& event) {
-    if (count >= MAX_EVENTS) return false;
-    events[count++] = event;
-    return true;
+    return put(event, false);
+  }
+
+  /**
+   * Add an event whose delta is in master ticks
+   * @return true if taken, false if the sink is full
+   */
+  bool addTicks(const MIDIEvent& event) {
+    return put(event, true);
   }
 
   /**
@@ -108,6 +324,20 @@ public:
     return add(MIDIEvent::cc(channel, controller, value, delta));
   }
 
+  /**
+   * Add a note on event, delay in master ticks
+   */
+  bool noteOnTicks(uint8_t channel, uint8_t note, uint8_t velocity, uint32_t delayTicks) {
+    return addTicks(MIDIEvent::noteOn(channel, note, velocity, delayTicks));
+  }
+
+  /**
+   * Add a note off event, delay in master ticks
+   */
+  bool noteOffTicks(uint8_t channel, uint8_t note, uint32_t delayTicks) {
+    return addTicks(MIDIEvent::noteOff(channel, note, delayTicks));
+  }
+
   /**
    * Add a stop all event
    */
@@ -116,16 +346,124 @@ public:
   }
 
   /**
-   * Clear all events
+   * Add a tie (see MIDIEvent::tie())
+   */
+  bool tie(uint8_t channel, uint8_t note, uint8_t velocity, unsigned long delta) {
+    return add(MIDIEvent::tie(channel, note, velocity, delta));
+  }
+
+  /**
+   * Add a run of notes starting after 'start' microseconds; every time in
+   * the rule is in microseconds
+   * @return false if the sink has no room for it
+   */
+  bool recur(const Recurrence& rule, unsigned long start = 0) {
+    return putRecurrence(rule, start, false);
+  }
+
+  /**
+   * Add a run of notes with start, interval and length in master ticks
+   */
+  bool recurTicks(const Recurrence& rule, uint32_t startTicks = 0) {
+    return putRecurrence(rule, startTicks, true);
+  }
+
+private:
+  bool put(MIDIEvent event, bool inTicks) {
+    event.inTicks = inTicks;
+    event.origin = origin;
+    return counted(static_cast<Sink*>(this)->write(event));
+  }
+
+  bool putRecurrence(const Recurrence& rule, unsigned long start, bool inTicks) {
+    MIDIEvent event(MIDIEvent::RECUR, rule.channel, 0, rule.velocity, start);
+    event.inTicks = inTicks;
+    event.origin = origin;
+    return counted(static_cast<Sink*>(this)->writeRecurrence(rule, event));
+  }
+
+  bool counted(bool taken) {
+    if (!taken && overflows < UINT16_MAX) overflows++;
+    return taken;
+  }
+};
+
+/**
+ * MIDIEventBuffer - Fixed-size list of MIDI events (recording sink)
+ *
+ * Embedded-friendly event collection with no dynamic allocation. Keeps
+ * what a mode writes, in order, for tests and tools to inspect; the
+ * scheduler can also take a whole buffer at once (scheduleAll()).
+ *
+ * Design principles:
+ * - Fixed size (stack-allocated)
+ * - No dynamic memory
+ * - Bounds checking; events past the end are counted as overflow
+ * - Simple iterator interface
+ *
+ * A Recurrence is kept as one RECUR event in the list with its rule
+ * alongside (up to MAX_RECURRENCES per buffer).
+ *
+ * N events (default GRUVBOK::MIDI::MAX_BUFFERED_EVENTS), counted in the
+ * smallest index type that holds N (SlotIndex).
+ */
+template<uint16_t N = GRUVBOK::MIDI::MAX_BUFFERED_EVENTS>
+class MIDIEventBuffer : public EventSink<MIDIEventBuffer<N> > {
+public:
+  typedef typename SlotIndex<N>::type Index;
+
+private:
+  static constexpr Index MAX_EVENTS = N;
+  static constexpr uint8_t MAX_RECURRENCES = 8;
+  MIDIEvent events[MAX_EVENTS];
+  Index count;
+  Recurrence recurrences[MAX_RECURRENCES];  // Rules of the RECUR events
+  uint8_t recurrenceCount;
+
+public:
+  MIDIEventBuffer() : count(0), recurrenceCount(0) {}
+
+  /**
+   * Origin of an event (MIDIEvent::NO_ORIGIN if none was set)
+   */
+  uint8_t getOrigin(Index index) const {
+    return events[index].origin;
+  }
+
+  /**
+   * True if the event's delta is in master ticks rather than microseconds
+   */
+  bool isTickTimed(Index index) const {
+    return events[index].inTicks;
+  }
+
+  /**
+   * Rule of a RECUR event (index = the event's data1)
+   */
+  const Recurrence& getRecurrence(uint8_t index) const {
+    return recurrences[index];
+  }
+
+  /**
+   * Recurrences that still fit
+   */
+  uint8_t recurrencesRemaining() const {
+    return MAX_RECURRENCES - recurrenceCount;
+  }
+
+  /**
+   * Clear all events (and the overflow count)
    */
   void clear() {
     count = 0;
+    recurrenceCount = 0;
+    this->overflows = 0;
   }
 
   /**
    * Get number of events in buffer
    */
-  uint8_t size() const {
+  Index size() const {
     return count;
   }
 
@@ -146,14 +484,14 @@ public:
   /**
    * Get event by index (const)
    */
-  const MIDIEvent& operator[](uint8_t index) const {
+  const MIDIEvent& operator[](Index index) const {
     return events[index];
   }
 
   /**
    * Get event by index (mutable)
    */
-  MIDIEvent& operator[](uint8_t index) {
+  MIDIEvent& operator[](Index index) {
     return events[index];
   }
 
@@ -162,7 +500,7 @@ public:
    */
   template<typename Func>
   void forEach(Func func) const {
-    for (uint8_t i = 0; i < count; i++) {
+    for (Index i = 0; i < count; i++) {
       func(events[i]);
     }
   }
@@ -170,11 +508,28 @@ public:
   /**
    * Get remaining capacity
    */
-  uint8_t remaining() const {
+  Index remaining() const {
     return MAX_EVENTS - count;
   }
 
-  static constexpr uint8_t getMaxEvents() { return MAX_EVENTS; }
+  static constexpr Index getMaxEvents() { return MAX_EVENTS; }
+
+  static constexpr uint8_t getMaxRecurrences() { return MAX_RECURRENCES; }
+
+  // EventSink
+  bool write(const MIDIEvent& event) {
+    if (count >= MAX_EVENTS) return false;
+    events[count++] = event;
+    return true;
+  }
+
+  bool writeRecurrence(const Recurrence& rule, const MIDIEvent& start) {
+    if (recurrenceCount >= MAX_RECURRENCES || count >= MAX_EVENTS) return false;
+    recurrences[recurrenceCount] = rule;
+    events[count] = start;
+    events[count++].data1 = recurrenceCount++;
+    return true;
+  }
 };
 
 #endif  // MIDIEVENT_H
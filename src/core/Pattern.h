@@ -3,21 +3,123 @@
 
 #include "Track.h"
 
+/**
+ * Pattern storage layouts
+ *
+ * TrackMajor (default): Track tracks[8], each track's 16 events contiguous.
+ *   Reading one step across the 8 tracks touches 8 strides of 68 bytes.
+ *
+ * StepMajor (build with -D GRUVBOK_STEP_MAJOR_PATTERNS): Event
+ *   events[16][8], so the 8 tracks of one step fill one 32-byte span
+ *   (one Cortex-M7 D-cache line), and the 8 switch masks sit together.
+ *   getTrack() returns a StridedTrack view with Track's interface.
+ *
+ * Both have the same accessors; code that holds on to a track uses
+ * Pattern::TrackRef / Pattern::ConstTrackRef so it builds with either.
+ * See test/bench_patternlayout.cpp for the cache line and cycle counts.
+ */
+struct TrackMajor {};
+struct StepMajor {};
+
+// Read-only StridedTrack
+class ConstStridedTrack {
+private:
+  static constexpr uint8_t NUM_EVENTS = 16;
+  static constexpr uint8_t STRIDE = 8;
+
+  const Event* first;
+  const uint16_t* switches;
+
+public:
+  ConstStridedTrack(const Event* firstEvent, const uint16_t& mask)
+    : first(firstEvent), switches(&mask) {}
+
+  inline const Event& getEvent(uint8_t index) const {
+    return first[(index & 0x0F) * STRIDE];
+  }
+
+  inline const Event& operator[](uint8_t index) const {
+    return getEvent(index);
+  }
+
+  inline uint16_t getSwitchMask() const { return *switches; }
+  inline bool hasActiveEvents() const { return *switches != 0; }
+  inline uint8_t countActiveEvents() const { return (uint8_t)__builtin_popcount(*switches); }
+
+  static constexpr uint8_t getNumEvents() { return NUM_EVENTS; }
+};
+
+/**
+ * StridedTrack - One track of a step-major pattern
+ *
+ * Points at the track's event in step 0; step i is NUM_TRACKS events
+ * further on. Writes go through EventRef like Track's, so the track's
+ * switch mask stays current.
+ */
+class StridedTrack {
+private:
+  static constexpr uint8_t NUM_EVENTS = 16;
+  static constexpr uint8_t STRIDE = 8;  // Events between steps (tracks per pattern)
+
+  Event* first;
+  uint16_t* switches;
+
+public:
+  StridedTrack(Event* firstEvent, uint16_t& mask) : first(firstEvent), switches(&mask) {}
+
+  inline operator ConstStridedTrack() const {
+    return ConstStridedTrack(first, *switches);
+  }
+
+  inline EventRef getEvent(uint8_t index) const {
+    index &= 0x0F;  // Mask to 0-15
+    return EventRef(first[index * STRIDE], *switches, index);
+  }
+
+  inline EventRef operator[](uint8_t index) const {
+    return getEvent(index);
+  }
+
+  void clear() const {
+    for (uint8_t i = 0; i < NUM_EVENTS; i++) {
+      first[i * STRIDE].clear();
+    }
+    *switches = 0;
+  }
+
+  inline uint16_t getSwitchMask() const { return *switches; }
+  inline bool hasActiveEvents() const { return *switches != 0; }
+  inline uint8_t countActiveEvents() const { return (uint8_t)__builtin_popcount(*switches); }
+
+  static constexpr uint8_t getNumEvents() { return NUM_EVENTS; }
+};
+
+template<typename Layout>
+class BasicPattern;
+
 /**
  * Pattern - A collection of 8 parallel Tracks
  *
  * Each pattern contains 8 tracks that play simultaneously.
  * All tracks in a pattern share the same tempo and loop length.
  *
- * Memory: 8 tracks × 64 bytes = 512 bytes per pattern
+ * The tracks' switch masks form the pattern's 128-bit switch plane
+ * (track-major, 16 bits per track): occupancy and step-column queries
+ * read those 8 words instead of 128 events.
+ *
+ * Memory: 8 tracks × 68 bytes = 544 bytes per pattern
  */
-class Pattern {
+template<>
+class BasicPattern<TrackMajor> {
 private:
   static constexpr uint8_t NUM_TRACKS = 8;
   Track tracks[NUM_TRACKS];
 
 public:
-  Pattern() {}
+  typedef Track& TrackRef;
+  typedef const Track& ConstTrackRef;
+
+  BasicPattern() {}
 
   // Track access
   inline Track& getTrack(uint8_t index) {
@@ -46,15 +148,113 @@ public:
 
   // Check if pattern has any active events
   bool hasActiveEvents() const {
+    uint16_t any = 0;
+    for (uint8_t i = 0; i < NUM_TRACKS; i++) {
+      any |= tracks[i].getSwitchMask();
+    }
+    return any != 0;
+  }
+
+  // Tracks whose switch is on at a step (bit t = track t): gathers one
+  // bit from each track's mask
+  inline uint8_t getStepTracks(uint8_t step) const {
+    uint8_t shift = step & 0x0F;
+    uint8_t bits = 0;
     for (uint8_t i = 0; i < NUM_TRACKS; i++) {
-      if (tracks[i].hasActiveEvents()) {
-        return true;
+      bits |= (uint8_t)(((tracks[i].getSwitchMask() >> shift) & 1) << i);
+    }
+    return bits;
+  }
+
+  static constexpr uint8_t getNumTracks() { return NUM_TRACKS; }
+};
+
+/**
+ * Pattern, step-major: events[step][track]
+ *
+ * Rows are 32-byte aligned, so a step's 8 events are one D-cache line on
+ * the Cortex-M7; the 8 switch masks follow in one 16-byte block.
+ *
+ * Memory: 16 steps × 32 bytes + 16 bytes of masks, padded to 32 = 544 bytes
+ */
+template<>
+class BasicPattern<StepMajor> {
+private:
+  static constexpr uint8_t NUM_TRACKS = 8;
+  static constexpr uint8_t NUM_STEPS = 16;
+
+  alignas(32) Event events[NUM_STEPS][NUM_TRACKS];
+  uint16_t switches[NUM_TRACKS];
+
+public:
+  typedef StridedTrack TrackRef;
+  typedef ConstStridedTrack ConstTrackRef;
+
+  BasicPattern() {
+    clear();
+  }
+
+  // Track access
+  inline StridedTrack getTrack(uint8_t index) {
+    index &= 0x07;  // Mask to 0-7
+    return StridedTrack(&events[0][index], switches[index]);
+  }
+
+  inline ConstStridedTrack getTrack(uint8_t index) const {
+    index &= 0x07;
+    return ConstStridedTrack(&events[0][index], switches[index]);
+  }
+
+  // Direct access operator
+  inline StridedTrack operator[](uint8_t index) {
+    return getTrack(index);
+  }
+
+  inline ConstStridedTrack operator[](uint8_t index) const {
+    return getTrack(index);
+  }
+
+  // Clear all tracks
+  void clear() {
+    for (uint8_t s = 0; s < NUM_STEPS; s++) {
+      for (uint8_t t = 0; t < NUM_TRACKS; t++) {
+        events[s][t].clear();
       }
     }
-    return false;
+    for (uint8_t t = 0; t < NUM_TRACKS; t++) {
+      switches[t] = 0;
+    }
+  }
+
+  // Check if pattern has any active events
+  bool hasActiveEvents() const {
+    uint16_t any = 0;
+    for (uint8_t i = 0; i < NUM_TRACKS; i++) {
+      any |= switches[i];
+    }
+    return any != 0;
+  }
+
+  // Tracks whose switch is on at a step (bit t = track t)
+  inline uint8_t getStepTracks(uint8_t step) const {
+    uint8_t shift = step & 0x0F;
+    uint8_t bits = 0;
+    for (uint8_t i = 0; i < NUM_TRACKS; i++) {
+      bits |= (uint8_t)(((switches[i] >> shift) & 1) << i);
+    }
+    return bits;
   }
 
   static constexpr uint8_t getNumTracks() { return NUM_TRACKS; }
 };
 
+#ifdef GRUVBOK_STEP_MAJOR_PATTERNS
+typedef BasicPattern<StepMajor> Pattern;
+#else
+typedef BasicPattern<TrackMajor> Pattern;
+#endif
+
+static_assert(sizeof(Pattern) == GRUVBOK::Song::PATTERN_SIZE,
+              "Song::PATTERN_SIZE must match Pattern (either layout)");
+
 #endif // PATTERN_H
@@ -0,0 +1,75 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * SPSCQueue - Lock-free single-producer/single-consumer ring buffer
+ *
+ * Hands data from an interrupt (or the host thread standing in for one) to
+ * the main loop, or the other way round, without disabling interrupts.
+ *
+ * Rules:
+ * - Exactly one context calls push(), exactly one other context calls pop()
+ * - N must be a power of two; one slot is never used, so N-1 items fit
+ * - Fixed size, no dynamic allocation
+ *
+ * The producer owns 'head' and the consumer owns 'tail'. Each side reads
+ * the other's index with acquire and publishes its own with release, so
+ * an item's data is visible before the index that covers it.
+ */
+template<typename T, uint16_t N>
+class SPSCQueue {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SPSCQueue size must be a power of two");
+
+private:
+  static constexpr uint16_t MASK = N - 1;
+
+  T items[N];
+  std::atomic<uint16_t> head;  // Next slot to write (producer)
+  std::atomic<uint16_t> tail;  // Next slot to read (consumer)
+
+public:
+  SPSCQueue() : head(0), tail(0) {}
+
+  /**
+   * Add an item (producer only)
+   * @return false if the queue is full (item dropped)
+   */
+  bool push(const T& item) {
+    uint16_t h = head.load(std::memory_order_relaxed);
+    uint16_t next = (h + 1) & MASK;
+    if (next == tail.load(std::memory_order_acquire)) return false;
+
+    items[h] = item;
+    head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Take the oldest item (consumer only)
+   * @return false if the queue is empty
+   */
+  bool pop(T& out) {
+    uint16_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+
+    out = items[t];
+    tail.store((t + 1) & MASK, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Number of queued items (exact from either side, approximate otherwise)
+   */
+  uint16_t size() const {
+    return (head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire)) & MASK;
+  }
+
+  bool isEmpty() const { return size() == 0; }
+
+  static constexpr uint16_t getCapacity() { return N - 1; }
+};
+
+#endif  // SPSCQUEUE_H
@@ -0,0 +1,78 @@
+#ifndef SLOTMASK_H
+#define SLOTMASK_H
+
+#include <stdint.h>
+#include <type_traits>
+
+/**
+ * SlotIndex - Smallest index type for a pool of Capacity slots
+ *
+ * uint8_t up to 254 slots, uint16_t beyond. The largest value of the type
+ * is kept free as NONE, so a count of Capacity and "no slot" both fit.
+ */
+template<uint32_t Capacity>
+struct SlotIndex {
+  static_assert(Capacity > 0, "a pool needs at least one slot");
+  static_assert(Capacity < 0xFFFF, "at most 65534 slots");
+
+  typedef typename std::conditional<(Capacity < 0xFF), uint8_t, uint16_t>::type type;
+
+  static constexpr type NONE = (type)~(type)0;
+  static_assert(Capacity < NONE, "NONE must not be a valid slot or count");
+};
+
+/**
+ * SlotMask - One bit per slot of a fixed pool
+ *
+ * 32-bit words, so a scan of a 64-slot pool touches two words and one of
+ * thousands of slots skips empty stretches 32 at a time.
+ */
+template<uint32_t Capacity>
+class SlotMask {
+public:
+  typedef typename SlotIndex<Capacity>::type Index;
+
+private:
+  static constexpr uint16_t WORDS = (Capacity + 31) / 32;
+  uint32_t words[WORDS];
+
+public:
+  SlotMask() { clear(); }
+
+  void clear() {
+    for (uint16_t w = 0; w < WORDS; w++) {
+      words[w] = 0;
+    }
+  }
+
+  void set(Index slot) { words[slot >> 5] |= (uint32_t)1 << (slot & 31); }
+  void reset(Index slot) { words[slot >> 5] &= ~((uint32_t)1 << (slot & 31)); }
+  bool test(Index slot) const { return (words[slot >> 5] >> (slot & 31)) & 1; }
+
+  Index count() const {
+    Index total = 0;
+    for (uint16_t w = 0; w < WORDS; w++) {
+      total += (Index)__builtin_popcount(words[w]);
+    }
+    return total;
+  }
+
+  /**
+   * Call func(slot) for each set bit, lowest first. Each word is read
+   * once, so func may clear bits (its own or others) as it goes; bits
+   * cleared in a word not yet reached are skipped.
+   */
+  template<typename Func>
+  void forEach(Func func) const {
+    for (uint16_t w = 0; w < WORDS; w++) {
+      uint32_t bits = words[w];
+      while (bits != 0) {
+        Index slot = (Index)((w << 5) + __builtin_ctz(bits));
+        bits &= bits - 1;
+        func(slot);
+      }
+    }
+  }
+};
+
+#endif  // SLOTMASK_H
@@ -11,7 +11,8 @@
  * Each Mode contains 32 Patterns.
  * Mode 0 is special: it controls which pattern plays on all other modes.
  *
- * Memory: 15 modes × 32 patterns × 512 bytes = 245,760 bytes (~240 KB)
+ * Memory: 15 modes × 32 patterns × 544 bytes = 261,120 bytes (~255 KB)
+ *         (512 bytes of events, 32 of track switch masks and padding)
  *
  * Structure:
  * Song
@@ -19,6 +20,10 @@
  *       └─ Pattern[32]
  *           └─ Track[8]
  *               └─ Event[16]
+ *
+ * Occupancy: every Track keeps a switch mask current on each edit (see
+ * EventRef), so getLiveTracks() answers "which tracks fire on this step"
+ * from 8 mask words without reading any events.
  */
 class Song {
 private:
@@ -39,6 +44,11 @@ public:
     return patterns[mode & 0x0F][pattern & 0x1F];
   }
 
+  // Tracks whose switch is on at this step (bit t = track t)
+  inline uint8_t getLiveTracks(uint8_t mode, uint8_t pattern, uint8_t step) const {
+    return getPattern(mode, pattern).getStepTracks(step);
+  }
+
   // Clear entire song
   void clear() {
     for (uint8_t m = 0; m < NUM_MODES; m++) {
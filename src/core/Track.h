@@ -2,6 +2,74 @@
 #define TRACK_H
 
 #include "Event.h"
+#include "Constants.h"
+
+/**
+ * EventRef - Writable view of one of a Track's Events
+ *
+ * Non-const Track access returns this instead of Event&, so switch writes
+ * also update the track's switch mask. It has Event's interface and
+ * converts to const Event& for code that only reads.
+ */
+class EventRef {
+private:
+  Event& event;
+  uint16_t& switches;
+  uint16_t bit;
+
+  inline void syncSwitch() {
+    if (event.getSwitch()) {
+      switches |= bit;
+    } else {
+      switches &= ~bit;
+    }
+  }
+
+public:
+  EventRef(Event& target, uint16_t& mask, uint8_t index)
+    : event(target), switches(mask), bit((uint16_t)(1u << index)) {}
+
+  inline operator const Event&() const { return event; }
+
+  inline EventRef& operator=(const EventRef& other) {
+    return *this = (const Event&)other;
+  }
+
+  inline EventRef& operator=(const Event& value) {
+    event = value;
+    syncSwitch();
+    return *this;
+  }
+
+  inline bool getSwitch() const { return event.getSwitch(); }
+
+  inline void setSwitch(bool value) {
+    event.setSwitch(value);
+    syncSwitch();
+  }
+
+  inline void toggleSwitch() {
+    event.toggleSwitch();
+    switches ^= bit;
+  }
+
+  inline uint8_t getPot(uint8_t index) const { return event.getPot(index); }
+  inline void setPot(uint8_t index, uint8_t value) { event.setPot(index, value); }
+
+  inline uint32_t getRaw() const { return event.getRaw(); }
+
+  inline void setRaw(uint32_t raw) {
+    event.setRaw(raw);
+    syncSwitch();
+  }
+
+  inline bool isEmpty() const { return event.isEmpty(); }
+
+  inline void clear() {
+    event.clear();
+    switches &= ~bit;
+  }
+};
 
 /**
  * Track - A sequence of 16 Events
@@ -9,12 +77,17 @@
  * Each track contains 16 events, matching the 16 hardware buttons.
  * Tracks loop continuously during playback.
  *
- * Memory: 16 events × 4 bytes = 64 bytes per track
+ * Alongside the events the track keeps a 16-bit switch mask (bit i =
+ * step i's switch), updated by every write through EventRef, so
+ * occupancy queries are single-word tests instead of 16 event reads.
+ *
+ * Memory: 16 events × 4 bytes + 2-byte mask (+2 padding) = 68 bytes per track
  */
 class Track {
 private:
   static constexpr uint8_t NUM_EVENTS = 16;
   Event events[NUM_EVENTS];
+  uint16_t switches;
 
 public:
   Track() {
@@ -22,8 +95,8 @@ public:
   }
 
   // Event access
-  inline Event& getEvent(uint8_t index) {
-    return events[index & 0x0F];  // Mask to 0-15
+  inline EventRef getEvent(uint8_t index) {
+    return EventRef(events[index & 0x0F], switches, index & 0x0F);  // Mask to 0-15
   }
 
   inline const Event& getEvent(uint8_t index) const {
@@ -31,7 +104,7 @@ public:
   }
 
   // Direct access operator
-  inline Event& operator[](uint8_t index) {
+  inline EventRef operator[](uint8_t index) {
     return getEvent(index);
   }
 
@@ -44,30 +117,25 @@ public:
     for (uint8_t i = 0; i < NUM_EVENTS; i++) {
       events[i].clear();
     }
+    switches = 0;
   }
 
+  // Switch mask: bit i set when step i's switch is on
+  inline uint16_t getSwitchMask() const { return switches; }
+
   // Check if track has any active events
-  bool hasActiveEvents() const {
-    for (uint8_t i = 0; i < NUM_EVENTS; i++) {
-      if (events[i].getSwitch()) {
-        return true;
-      }
-    }
-    return false;
+  inline bool hasActiveEvents() const {
+    return switches != 0;
   }
 
   // Count active events
-  uint8_t countActiveEvents() const {
-    uint8_t count = 0;
-    for (uint8_t i = 0; i < NUM_EVENTS; i++) {
-      if (events[i].getSwitch()) {
-        count++;
-      }
-    }
-    return count;
+  inline uint8_t countActiveEvents() const {
+    return (uint8_t)__builtin_popcount(switches);
   }
 
   static constexpr uint8_t getNumEvents() { return NUM_EVENTS; }
 };
 
+static_assert(sizeof(Track) == GRUVBOK::Song::TRACK_SIZE, "Song::TRACK_SIZE must match Track");
+
 #endif // TRACK_H
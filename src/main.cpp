@@ -8,6 +8,8 @@
  * - Sequencer: Playback engine (always looping through data)
  * - Hardware: I/O abstraction (16 buttons, 4 pots, LED)
  * - MIDIScheduler: Delta-time MIDI event scheduling
+ * - MIDIDispatcher: Lock-free ring, sends MIDI from the timer interrupt
+ * - MIDIPorts: USB and DIN outputs, each with its own queue and routing
  * - Modes: Musical interpreters (drum machine, acid sequencer, etc.)
  *
  * Memory usage: ~240KB for song data + overhead
@@ -19,17 +21,32 @@
 #include "hardware/Hardware.h"
 #include "sequencer/Sequencer.h"
 #include "sequencer/MIDIScheduler.h"
+#include "sequencer/MIDIDispatcher.h"
+#include "sequencer/MIDIPort.h"
 
 // Global instances
 Song song;
 Hardware hardware;
-MIDIScheduler scheduler;
-Sequencer sequencer(&song, &hardware, &scheduler);
+UsbMIDIPort usbPort;
+StreamMIDIPort<HardwareSerial> dinPort(&Serial1);     // DIN MIDI out, running status
+MIDIDispatcher dispatcher;                            // Sends from the timer interrupt
+Sequencer::Scheduler scheduler(&dispatcher);
+Sequencer sequencer(&song, &hardware, &scheduler, &dispatcher);
+
+static uint8_t dinTxBuffer[256];  // Extends Serial1's transmit buffer
 
 void setup() {
   // Initialize hardware
   hardware.init();
 
+  // MIDI outputs (before the dispatch interrupt starts). DIN gets the
+  // instruments only: the debug channel stays on USB
+  Serial1.begin(31250);
+  Serial1.addMemoryForWrite(dinTxBuffer, sizeof(dinTxBuffer));
+  dinPort.routeChannel(GRUVBOK::Debug::DEBUG_CHANNEL, false);
+  dispatcher.addPort(&usbPort);
+  dispatcher.addPort(&dinPort);
+
   // Load default demo song (plays immediately on power-up!)
   DefaultSongs::loadDemoSong(song);
 
@@ -3,6 +3,7 @@
 
 #include "../core/Event.h"
 #include "../core/MIDIEvent.h"
+#include "../sequencer/SchedulerSink.h"
 #include "../hardware/InputState.h"
 #include <stdint.h>
 
@@ -14,9 +15,11 @@
  * They have NO SIDE EFFECTS - no scheduling, no state mutation, no I/O.
  *
  * Input:  Event (switch + 4 pots)
- * Output: MIDIEventBuffer (list of MIDI messages)
+ * Output: an EventSink (MIDI messages)
  *
- * The sequencer collects events from all modes, then schedules them in bulk.
+ * The sequencer hands every mode a SchedulerSink, which puts each event
+ * straight into the scheduler; tests pass a MIDIEventBuffer to record
+ * them. Modes derive from ModeBase and write one template for any sink.
  * This enables:
  * - True functional purity (no side effects)
  * - Easy testing (no mocking needed)
@@ -47,11 +50,13 @@ public:
    *
    * @param trackIndex Track number (0-7)
    * @param event The event to process (raw pot values)
-   * @param stepTime Current step time in milliseconds (for delta calculations)
-   * @param output Buffer to write MIDI events into
+   * @param stepTime Ideal (logical) step start in microseconds; deltas are relative to it
+   * @param output Sink to write MIDI events into
    */
   virtual void processEvent(uint8_t trackIndex, const Event& event,
-                           unsigned long stepTime, MIDIEventBuffer& output) const = 0;
+                           unsigned long stepTime, SchedulerSink& output) const = 0;
+  virtual void processEvent(uint8_t trackIndex, const Event& event,
+                           unsigned long stepTime, MIDIEventBuffer<>& output) const = 0;
 
   /**
    * Called when mode is activated (optional lifecycle hook)
@@ -74,4 +79,37 @@ public:
   uint8_t getChannel() const { return midiChannel; }
 };
 
+/**
+ * ModeBase - Implements Mode's processEvent() for every sink type
+ *
+ * A mode derives from ModeBase<itself> and provides
+ *   template<typename Sink>
+ *   void render(uint8_t trackIndex, const Event& event,
+ *               unsigned long stepTime, Sink& output) const;
+ * with the same contract as Mode::processEvent(). It is compiled once
+ * per sink, so writes go directly to the sink with no virtual call or
+ * copy per event.
+ *
+ * The sequencer only calls render() for tracks whose switch is on at the
+ * step. A mode that must also see the steps where it is off (to reset
+ * per-track state) redeclares RENDERS_IDLE_STEPS as true.
+ */
+template<typename Derived>
+class ModeBase : public Mode {
+public:
+  static constexpr bool RENDERS_IDLE_STEPS = false;
+
+  explicit ModeBase(uint8_t channel) : Mode(channel) {}
+
+  void processEvent(uint8_t trackIndex, const Event& event,
+                   unsigned long stepTime, SchedulerSink& output) const override {
+    static_cast<const Derived*>(this)->render(trackIndex, event, stepTime, output);
+  }
+
+  void processEvent(uint8_t trackIndex, const Event& event,
+                   unsigned long stepTime, MIDIEventBuffer<>& output) const override {
+    static_cast<const Derived*>(this)->render(trackIndex, event, stepTime, output);
+  }
+};
+
 #endif // MODE_H
@@ -22,12 +22,17 @@
  * Example: Switch=1, Pot0=5, Pot1=0, Pot2=127, Pot3=1
  * Result: Immediately switch to pattern 5 on modes 0-7 and mode 8
  */
-class Mode0_PatternSequencer : public Mode {
+class Mode0_PatternSequencer : public ModeBase<Mode0_PatternSequencer> {
 public:
-  Mode0_PatternSequencer(uint8_t channel) : Mode(channel) {}
+  // Worst case per render() (see ModeList): no MIDI at all
+  static constexpr uint8_t MAX_EVENTS = 0;
+  static constexpr uint8_t MAX_RECURRENCES = 0;
 
-  void processEvent(uint8_t trackIndex, const Event& event,
-                   unsigned long stepTime, MIDIEventBuffer& output) const override {
+  Mode0_PatternSequencer(uint8_t channel) : ModeBase(channel) {}
+
+  template<typename Sink>
+  void render(uint8_t trackIndex, const Event& event,
+              unsigned long stepTime, Sink& output) const {
     // Mode 0 doesn't generate MIDI directly
     // The Sequencer engine reads events from Mode 0 to control pattern playback
     // No MIDI events needed here
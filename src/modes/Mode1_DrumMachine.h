@@ -27,7 +27,7 @@
  *
  * Note length: 50ms fixed
  */
-class Mode1_DrumMachine : public Mode {
+class Mode1_DrumMachine : public ModeBase<Mode1_DrumMachine> {
 private:
   static constexpr uint8_t drumNotes[8] = {
     36,  // Kick
@@ -40,13 +40,19 @@ private:
     51   // Ride
   };
 
-  static constexpr unsigned long NOTE_LENGTH_MS = 50;
+  static constexpr unsigned long NOTE_LENGTH_US = 50000;
 
 public:
-  Mode1_DrumMachine(uint8_t channel) : Mode(channel) {}
+  // Worst case per render() (see ModeList): flam and main note (on and
+  // off each) plus the pan CC
+  static constexpr uint8_t MAX_EVENTS = 5;
+  static constexpr uint8_t MAX_RECURRENCES = 0;
 
-  void processEvent(uint8_t trackIndex, const Event& event,
-                   unsigned long stepTime, MIDIEventBuffer& output) const override {
+  Mode1_DrumMachine(uint8_t channel) : ModeBase(channel) {}
+
+  template<typename Sink>
+  void render(uint8_t trackIndex, const Event& event,
+              unsigned long stepTime, Sink& output) const {
     if (trackIndex >= 8) return;
 
     // Only process if switch is active
@@ -63,14 +69,14 @@ public:
     // Default velocity if zero
     if (velocity == 0) velocity = 100;
 
-    // Map length value (0-127) to note duration (10ms - 2000ms)
+    // Map length value (0-127) to note duration (10ms - 2000ms, in us)
     // Cast to unsigned long to prevent overflow before division
-    unsigned long noteLength = 10 + ((unsigned long)lengthValue * 1990) / 127;
+    unsigned long noteLength = 10000 + ((unsigned long)lengthValue * 1990000) / 127;
 
     // Flam: Send a quieter note slightly before main note (if flam > 0)
     if (flamAmount > 0) {
-      // Flam time: 5-50ms delay based on flamAmount
-      unsigned long flamDelay = 5 + ((unsigned long)flamAmount * 45) / 127;
+      // Flam time: 5-50ms delay based on flamAmount (in us)
+      unsigned long flamDelay = 5000 + ((unsigned long)flamAmount * 45000) / 127;
       // Flam is quieter (60% of velocity)
       uint8_t flamVelocity = (velocity * 60) / 100;
 
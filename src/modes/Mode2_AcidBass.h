@@ -30,9 +30,11 @@
  * - Base velocity: 80
  * - Accent adds up to +47 velocity (max 127)
  * - Slide creates glide between notes
+ * - Slide into the same pitch is a tie: the note is held (its pending
+ *   note off moves) instead of being retriggered
  * - Short gates for plucky sound, long for sustained
  */
-class Mode2_AcidBass : public Mode {
+class Mode2_AcidBass : public ModeBase<Mode2_AcidBass> {
 private:
   // Bass note range: C1 (36) to C4 (72)
   static constexpr uint8_t MIN_NOTE = 36;  // C1
@@ -47,15 +49,24 @@ private:
   mutable uint8_t lastNote[8];
 
 public:
-  Mode2_AcidBass(uint8_t channel) : Mode(channel) {
+  // Worst case per render() (see ModeList): two portamento CCs and the
+  // note (a tie that finds nothing to extend still takes on and off)
+  static constexpr uint8_t MAX_EVENTS = 4;
+  static constexpr uint8_t MAX_RECURRENCES = 0;
+
+  // A step with the switch off breaks the slide chain (lastNote reset)
+  static constexpr bool RENDERS_IDLE_STEPS = true;
+
+  Mode2_AcidBass(uint8_t channel) : ModeBase(channel) {
     // Initialize last notes
     for (uint8_t i = 0; i < 8; i++) {
       lastNote[i] = 0;
     }
   }
 
-  void processEvent(uint8_t trackIndex, const Event& event,
-                   unsigned long stepTime, MIDIEventBuffer& output) const override {
+  template<typename Sink>
+  void render(uint8_t trackIndex, const Event& event,
+              unsigned long stepTime, Sink& output) const {
     if (trackIndex >= 8) return;
 
     // Only process if switch is active
@@ -79,8 +90,8 @@ public:
     uint8_t velocity = BASE_VELOCITY + accent;
     if (velocity > 127) velocity = 127;
 
-    // Map length value (0-127) to note duration (10ms - 2000ms)
-    unsigned long noteLength = 10 + ((unsigned long)lengthValue * 1990) / 127;
+    // Map length value (0-127) to note duration (10ms - 2000ms, in us)
+    unsigned long noteLength = 10000 + ((unsigned long)lengthValue * 1990000) / 127;
 
     // Slide/portamento: if slide > 0 and we have a previous note
     bool hasSlide = (slideValue > 0 && lastNote[trackIndex] > 0);
@@ -98,9 +109,13 @@ public:
       output.cc(midiChannel, 65, 0, 0);  // CC65: Portamento Off
     }
 
-    // Send note on/off
-    output.noteOn(midiChannel, note, velocity, 0);
-    output.noteOff(midiChannel, note, noteLength);
+    // Send note on/off; a slide to the same pitch ties over
+    if (hasSlide && note == lastNote[trackIndex]) {
+      output.tie(midiChannel, note, velocity, noteLength);
+    } else {
+      output.noteOn(midiChannel, note, velocity, 0);
+      output.noteOff(midiChannel, note, noteLength);
+    }
 
     // Remember this note for next slide detection
     lastNote[trackIndex] = note;
@@ -23,6 +23,10 @@
  * - Each echo's pitch shifts by the modulation amount
  * - Echoes fade in velocity (each echo is 80% of previous)
  * - All notes layer and accumulate for rich textures
+ * - Echoes are timed in master ticks, so a tempo change also moves the
+ *   echoes still pending
+ * - The whole tail is one Recurrence; the scheduler makes each echo when
+ *   it is due, so a trigger holds one scheduler slot, not sixteen
  *
  * Example (at 120 BPM):
  * - Pitch: 60 (C4)
@@ -32,7 +36,7 @@
  * Result: C4 now, E4 at +4 steps, G#4 at +8 steps, C5 at +16 steps
  *        (creates a major chord progression over time)
  */
-class Mode3_EuclideanFade : public Mode {
+class Mode3_EuclideanFade : public ModeBase<Mode3_EuclideanFade> {
 private:
   // Note range: C1 (24) to C7 (96)
   static constexpr uint8_t MIN_NOTE = 24;
@@ -44,19 +48,26 @@ private:
   static constexpr uint8_t MIN_DELAY_STEPS = 1;
   static constexpr uint8_t MAX_DELAY_STEPS = 16;
 
-  // Step timing (at 120 BPM default, one 16th note step = 125ms)
-  // This provides a reference for converting steps to milliseconds
-  static constexpr unsigned long MS_PER_STEP = 125;
+  // Echo spacing is in master ticks, so echoes stay on the step grid
+  static constexpr uint8_t TICKS_PER_STEP = GRUVBOK::Timing::TICKS_PER_STEP;
+  static constexpr unsigned long MIN_NOTE_LENGTH = 50000;  // us (50ms)
 
   // Velocity fade per echo
-  static constexpr float VELOCITY_FADE = 0.80f;  // Each echo is 80% of previous
+  static constexpr uint16_t VELOCITY_FADE = 205;  // Each echo is 80% of previous (x/256)
+  static constexpr uint8_t MIN_VELOCITY = 10;     // Minimum audible velocity
   static constexpr uint8_t BASE_VELOCITY = 100;
 
 public:
-  Mode3_EuclideanFade(uint8_t channel) : Mode(channel) {}
+  // Worst case per render() (see ModeList): the echo run is one
+  // recurrence, expanded note by note by the scheduler
+  static constexpr uint8_t MAX_EVENTS = 1;
+  static constexpr uint8_t MAX_RECURRENCES = 1;
 
-  void processEvent(uint8_t trackIndex, const Event& event,
-                   unsigned long stepTime, MIDIEventBuffer& output) const override {
+  Mode3_EuclideanFade(uint8_t channel) : ModeBase(channel) {}
+
+  template<typename Sink>
+  void render(uint8_t trackIndex, const Event& event,
+              unsigned long stepTime, Sink& output) const {
     if (trackIndex >= 8) return;
 
     // Only process if switch is active
@@ -77,8 +88,8 @@ public:
                         (delayValue * (MAX_DELAY_STEPS - MIN_DELAY_STEPS)) / 127;
     if (delaySteps < 1) delaySteps = 1;
 
-    // Convert steps to milliseconds
-    unsigned long baseDelayMs = delaySteps * MS_PER_STEP;
+    // Convert steps to master ticks
+    uint32_t baseDelayTicks = (uint32_t)delaySteps * TICKS_PER_STEP;
 
     // Map rate to number of echoes (1-8)
     uint8_t numEchoes = 1 + (rateValue * (MAX_ECHOES - 1)) / 127;
@@ -86,38 +97,25 @@ public:
     // Map pitch modulation to semitones (-12 to +12, centered at 64)
     int8_t pitchModSemitones = ((int16_t)pitchModValue - 64) * 12 / 64;
 
-    // Generate base note and echoes with geometric spacing
-    uint8_t velocity = BASE_VELOCITY;
-    unsigned long echoDelay = 0;
-    unsigned long geometricMultiplier = 1;
-
-    for (uint8_t i = 0; i < numEchoes; i++) {
-      // Calculate pitch for this echo
-      int16_t echoNote = baseNote + (pitchModSemitones * i);
-
-      // Clamp to valid MIDI range
-      if (echoNote < 0) echoNote = 0;
-      if (echoNote > 127) echoNote = 127;
-
-      // Calculate velocity with fade
-      uint8_t echoVelocity = velocity;
-      if (echoVelocity < 10) echoVelocity = 10;  // Minimum audible velocity
-
-      // Schedule note with geometric delay spacing (in steps)
-      // Note length is half the delay spacing, but at least 50ms
-      unsigned long noteLength = baseDelayMs / 2;
-      if (noteLength < 50) noteLength = 50;
-
-      output.noteOn(midiChannel, (uint8_t)echoNote, echoVelocity, echoDelay);
-      output.noteOff(midiChannel, (uint8_t)echoNote, echoDelay + noteLength);
-
-      // Geometric progression in steps: delay, delay*2, delay*4, delay*8, etc.
-      echoDelay += baseDelayMs * geometricMultiplier;
-      geometricMultiplier *= 2;
-
-      // Fade velocity for next echo
-      velocity = (uint8_t)(velocity * VELOCITY_FADE);
-    }
+    // Base note and echoes as one recurrence: the scheduler makes each
+    // echo when it is due, timed in ticks so pending echoes follow tempo
+    // changes. Note length is half the delay spacing, but at least 50ms
+    uint32_t noteTicks = baseDelayTicks / 2;
+    uint32_t minNoteTicks = output.toTicks(MIN_NOTE_LENGTH);
+    if (noteTicks < minNoteTicks) noteTicks = minNoteTicks;
+
+    Recurrence echoes;
+    echoes.channel = midiChannel;
+    echoes.root = baseNote;
+    echoes.degreeStep = pitchModSemitones;     // Chromatic: semitones per echo
+    echoes.count = numEchoes;
+    echoes.velocity = BASE_VELOCITY;
+    echoes.velocityScale = VELOCITY_FADE;
+    echoes.minVelocity = MIN_VELOCITY;
+    echoes.growth = 2;                         // delay, delay*2, delay*4, ...
+    echoes.interval = baseDelayTicks;
+    echoes.length = noteTicks;
+    output.recurTicks(echoes);
 
     // Unused parameter
     (void)stepTime;
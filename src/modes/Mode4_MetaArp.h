@@ -36,8 +36,10 @@
  * - Second active step: Arpeggio descends
  * - Pattern continues alternating
  * - Notes evenly spaced within the step duration
+ * - The arpeggio is one Recurrence; the scheduler makes each note when it
+ *   is due
  */
-class Mode4_MetaArp : public Mode {
+class Mode4_MetaArp : public ModeBase<Mode4_MetaArp> {
 private:
   // Note range
   static constexpr uint8_t MIN_NOTE = 24;  // C1
@@ -47,9 +49,11 @@ private:
   // Arpeggio parameters
   static constexpr uint8_t MIN_NOTES = 2;
   static constexpr uint8_t MAX_NOTES = 16;
-  static constexpr unsigned long MIN_NOTE_DURATION = 20;   // ms
-  static constexpr unsigned long MAX_NOTE_DURATION = 400;  // ms
+  static constexpr unsigned long MIN_NOTE_DURATION = 20000;   // us (20ms)
+  static constexpr unsigned long MAX_NOTE_DURATION = 400000;  // us (400ms)
   static constexpr uint8_t BASE_VELOCITY = 100;
+  static constexpr uint8_t VELOCITY_STEP = 5;    // Less per note
+  static constexpr uint8_t MIN_VELOCITY = 60;
 
   // Direction tracking per track (true = up, false = down)
   mutable bool direction[8];
@@ -65,15 +69,21 @@ private:
   static constexpr uint8_t SCALE_CHROMATIC[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
 
 public:
-  Mode4_MetaArp(uint8_t channel) : Mode(channel) {
+  // Worst case per render() (see ModeList): the arpeggio is one
+  // recurrence, expanded note by note by the scheduler
+  static constexpr uint8_t MAX_EVENTS = 1;
+  static constexpr uint8_t MAX_RECURRENCES = 1;
+
+  Mode4_MetaArp(uint8_t channel) : ModeBase(channel) {
     // Initialize all tracks to upward direction
     for (uint8_t i = 0; i < 8; i++) {
       direction[i] = true;  // Start going up
     }
   }
 
-  void processEvent(uint8_t trackIndex, const Event& event,
-                   unsigned long stepTime, MIDIEventBuffer& output) const override {
+  template<typename Sink>
+  void render(uint8_t trackIndex, const Event& event,
+              unsigned long stepTime, Sink& output) const {
     if (trackIndex >= 8) return;
 
     // Only process if switch is active
@@ -128,42 +138,30 @@ public:
       scaleLength = 12;
     }
 
-    // Generate arpeggio in current direction
-    bool goingUp = direction[trackIndex];
-    unsigned long delay = 0;
-
-    for (uint8_t i = 0; i < numNotes; i++) {
-      // Calculate scale degree based on direction
-      uint8_t scaleDegree;
-      if (goingUp) {
-        scaleDegree = i % (scaleLength * 3);  // Allow up to 3 octaves
-      } else {
-        scaleDegree = (numNotes - 1 - i) % (scaleLength * 3);
-      }
-
-      // Get octave and scale position
-      uint8_t octave = scaleDegree / scaleLength;
-      uint8_t position = scaleDegree % scaleLength;
-
-      // Calculate MIDI note
-      int16_t note = rootNote + (octave * 12) + scale[position];
-
-      // Clamp to valid MIDI range
-      if (note < 0) note = 0;
-      if (note > 127) note = 127;
-
-      // Calculate velocity (slightly fade over the arpeggio)
-      uint8_t velocity = BASE_VELOCITY - (i * 5);
-      if (velocity < 60) velocity = 60;
-
-      // Schedule note on/off
-      output.noteOn(midiChannel, (uint8_t)note, velocity, delay);
-      output.noteOff(midiChannel, (uint8_t)note, delay + noteDuration);
-
-      // Advance delay for next note
-      delay += noteDuration;
+    // Scale as a pitch-class mask
+    uint16_t scaleMask = 0;
+    for (uint8_t i = 0; i < scaleLength; i++) {
+      scaleMask |= (uint16_t)1 << scale[i];
     }
 
+    // The arpeggio as one recurrence, up or down the scale over up to
+    // 3 octaves; the scheduler makes each note when it is due
+    bool goingUp = direction[trackIndex];
+    Recurrence arp;
+    arp.channel = midiChannel;
+    arp.root = rootNote;
+    arp.scale = scaleMask;
+    arp.firstDegree = goingUp ? 0 : (int8_t)(numNotes - 1);
+    arp.degreeStep = goingUp ? 1 : -1;
+    arp.octaves = 3;
+    arp.count = numNotes;
+    arp.velocity = BASE_VELOCITY;
+    arp.velocityStep = -VELOCITY_STEP;       // Slightly fade over the arpeggio
+    arp.minVelocity = MIN_VELOCITY;
+    arp.interval = noteDuration;
+    arp.length = noteDuration;
+    output.recur(arp);
+
     // Toggle direction for next time this track has an active step
     direction[trackIndex] = !direction[trackIndex];
 
@@ -37,7 +37,7 @@
  * - 96-111: Locrian
  * - 112-127: Chromatic
  */
-class Mode5_BasslineProgression : public Mode {
+class Mode5_BasslineProgression : public ModeBase<Mode5_BasslineProgression> {
 private:
   // Bass note range: C1 (36) to C4 (72)
   static constexpr uint8_t MIN_NOTE = 36;  // C1
@@ -58,8 +58,8 @@ private:
   static constexpr uint8_t SCALE_LOCRIAN[7] = {0, 1, 3, 5, 6, 8, 10};
   static constexpr uint8_t SCALE_CHROMATIC[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
 
-  // Pattern timing (subdivisions within a step at 120 BPM)
-  static constexpr unsigned long STEP_MS = 125;  // 16th note at 120 BPM
+  // Pattern timing (subdivisions within a step, in master ticks)
+  static constexpr uint8_t STEP_TICKS = GRUVBOK::Timing::TICKS_PER_STEP;
 
   /**
    * Get scale degree note
@@ -85,10 +85,16 @@ private:
   }
 
 public:
-  Mode5_BasslineProgression(uint8_t channel) : Mode(channel) {}
+  // Worst case per render() (see ModeList): the jazz walk, four notes
+  // with on and off each
+  static constexpr uint8_t MAX_EVENTS = 8;
+  static constexpr uint8_t MAX_RECURRENCES = 0;
 
-  void processEvent(uint8_t trackIndex, const Event& event,
-                   unsigned long stepTime, MIDIEventBuffer& output) const override {
+  Mode5_BasslineProgression(uint8_t channel) : ModeBase(channel) {}
+
+  template<typename Sink>
+  void render(uint8_t trackIndex, const Event& event,
+              unsigned long stepTime, Sink& output) const {
     if (trackIndex >= 8) return;
 
     // Only process if switch is active
@@ -134,8 +140,8 @@ public:
       scaleLength = 12;
     }
 
-    // Map duration (50ms-1000ms)
-    unsigned long noteDuration = 50 + ((unsigned long)durationValue * 950) / 127;
+    // Map duration (50ms-1000ms, in us)
+    unsigned long noteDuration = 50000 + ((unsigned long)durationValue * 950000) / 127;
 
     // Generate bass pattern based on patternValue
     unsigned long delay = 0;
@@ -153,8 +159,8 @@ public:
 
       output.noteOn(midiChannel, root, ACCENT_VELOCITY, 0);
       output.noteOff(midiChannel, root, noteDuration);
-      output.noteOn(midiChannel, fifth, BASE_VELOCITY, STEP_MS / 2);
-      output.noteOff(midiChannel, fifth, STEP_MS / 2 + noteDuration);
+      output.noteOn(midiChannel, fifth, BASE_VELOCITY, output.ticks(STEP_TICKS / 2));
+      output.noteOff(midiChannel, fifth, output.ticks(STEP_TICKS / 2) + noteDuration);
 
     } else if (patternValue < 48) {
       // Root + Fifth + Octave (walking up)
@@ -164,10 +170,10 @@ public:
 
       output.noteOn(midiChannel, root, ACCENT_VELOCITY, 0);
       output.noteOff(midiChannel, root, noteDuration);
-      output.noteOn(midiChannel, fifth, BASE_VELOCITY, STEP_MS / 3);
-      output.noteOff(midiChannel, fifth, STEP_MS / 3 + noteDuration);
-      output.noteOn(midiChannel, octave, BASE_VELOCITY, STEP_MS * 2 / 3);
-      output.noteOff(midiChannel, octave, STEP_MS * 2 / 3 + noteDuration);
+      output.noteOn(midiChannel, fifth, BASE_VELOCITY, output.ticks(STEP_TICKS / 3));
+      output.noteOff(midiChannel, fifth, output.ticks(STEP_TICKS / 3) + noteDuration);
+      output.noteOn(midiChannel, octave, BASE_VELOCITY, output.ticks(STEP_TICKS * 2 / 3));
+      output.noteOff(midiChannel, octave, output.ticks(STEP_TICKS * 2 / 3) + noteDuration);
 
     } else if (patternValue < 64) {
       // Root + Third + Fifth (triad walk)
@@ -177,10 +183,10 @@ public:
 
       output.noteOn(midiChannel, root, ACCENT_VELOCITY, 0);
       output.noteOff(midiChannel, root, noteDuration);
-      output.noteOn(midiChannel, third, BASE_VELOCITY, STEP_MS / 3);
-      output.noteOff(midiChannel, third, STEP_MS / 3 + noteDuration);
-      output.noteOn(midiChannel, fifth, BASE_VELOCITY, STEP_MS * 2 / 3);
-      output.noteOff(midiChannel, fifth, STEP_MS * 2 / 3 + noteDuration);
+      output.noteOn(midiChannel, third, BASE_VELOCITY, output.ticks(STEP_TICKS / 3));
+      output.noteOff(midiChannel, third, output.ticks(STEP_TICKS / 3) + noteDuration);
+      output.noteOn(midiChannel, fifth, BASE_VELOCITY, output.ticks(STEP_TICKS * 2 / 3));
+      output.noteOff(midiChannel, fifth, output.ticks(STEP_TICKS * 2 / 3) + noteDuration);
 
     } else if (patternValue < 80) {
       // Root + Third + Fifth + Seventh (jazz walk)
@@ -191,12 +197,12 @@ public:
 
       output.noteOn(midiChannel, root, ACCENT_VELOCITY, 0);
       output.noteOff(midiChannel, root, noteDuration);
-      output.noteOn(midiChannel, third, BASE_VELOCITY, STEP_MS / 4);
-      output.noteOff(midiChannel, third, STEP_MS / 4 + noteDuration);
-      output.noteOn(midiChannel, fifth, BASE_VELOCITY, STEP_MS / 2);
-      output.noteOff(midiChannel, fifth, STEP_MS / 2 + noteDuration);
-      output.noteOn(midiChannel, seventh, BASE_VELOCITY, STEP_MS * 3 / 4);
-      output.noteOff(midiChannel, seventh, STEP_MS * 3 / 4 + noteDuration);
+      output.noteOn(midiChannel, third, BASE_VELOCITY, output.ticks(STEP_TICKS / 4));
+      output.noteOff(midiChannel, third, output.ticks(STEP_TICKS / 4) + noteDuration);
+      output.noteOn(midiChannel, fifth, BASE_VELOCITY, output.ticks(STEP_TICKS / 2));
+      output.noteOff(midiChannel, fifth, output.ticks(STEP_TICKS / 2) + noteDuration);
+      output.noteOn(midiChannel, seventh, BASE_VELOCITY, output.ticks(STEP_TICKS * 3 / 4));
+      output.noteOff(midiChannel, seventh, output.ticks(STEP_TICKS * 3 / 4) + noteDuration);
 
     } else if (patternValue < 96) {
       // Octave bounce (root low, root high)
@@ -205,8 +211,8 @@ public:
 
       output.noteOn(midiChannel, rootLow, ACCENT_VELOCITY, 0);
       output.noteOff(midiChannel, rootLow, noteDuration);
-      output.noteOn(midiChannel, rootHigh, BASE_VELOCITY, STEP_MS / 2);
-      output.noteOff(midiChannel, rootHigh, STEP_MS / 2 + noteDuration);
+      output.noteOn(midiChannel, rootHigh, BASE_VELOCITY, output.ticks(STEP_TICKS / 2));
+      output.noteOff(midiChannel, rootHigh, output.ticks(STEP_TICKS / 2) + noteDuration);
 
     } else if (patternValue < 112) {
       // Chromatic approach (half-step below to root)
@@ -215,8 +221,8 @@ public:
 
       output.noteOn(midiChannel, approach, BASE_VELOCITY - 20, 0);
       output.noteOff(midiChannel, approach, noteDuration / 2);
-      output.noteOn(midiChannel, root, ACCENT_VELOCITY, STEP_MS / 4);
-      output.noteOff(midiChannel, root, STEP_MS / 4 + noteDuration);
+      output.noteOn(midiChannel, root, ACCENT_VELOCITY, output.ticks(STEP_TICKS / 4));
+      output.noteOff(midiChannel, root, output.ticks(STEP_TICKS / 4) + noteDuration);
 
     } else {
       // Fifth pedal (fifth on beats, root on offbeats)
@@ -225,8 +231,8 @@ public:
 
       output.noteOn(midiChannel, fifth, BASE_VELOCITY, 0);
       output.noteOff(midiChannel, fifth, noteDuration);
-      output.noteOn(midiChannel, root, ACCENT_VELOCITY, STEP_MS / 2);
-      output.noteOff(midiChannel, root, STEP_MS / 2 + noteDuration);
+      output.noteOn(midiChannel, root, ACCENT_VELOCITY, output.ticks(STEP_TICKS / 2));
+      output.noteOff(midiChannel, root, output.ticks(STEP_TICKS / 2) + noteDuration);
     }
 
     // Unused parameter
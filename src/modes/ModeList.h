@@ -0,0 +1,98 @@
+#ifndef MODELIST_H
+#define MODELIST_H
+
+#include "Mode.h"
+#include "../core/Constants.h"
+#include <stdint.h>
+
+/**
+ * ModeList - Compile-time list of mode classes and their event bounds
+ *
+ * Every mode declares, next to its render():
+ *   static constexpr uint8_t MAX_EVENTS;       // scheduler slots one call can take
+ *   static constexpr uint8_t MAX_RECURRENCES;  // generators one call can start
+ * (a TIE counts as two events: with no note to extend it becomes a note
+ * on plus its off). ModeList<Mode0, Mode1, ...> adds them up for a step
+ * in which every track of every listed mode is on, so buffer and
+ * scheduler sizes can be derived, and checked with static_assert, before
+ * the firmware ever runs:
+ *
+ *   ModeList<...>::MAX_EVENTS_PER_CALL      largest single render()
+ *   ModeList<...>::MAX_EVENTS_PER_STEP      sum over modes x NUM_TRACKS
+ *   ModeList<...>::MAX_RECURRENCES_PER_STEP generators started per step
+ *   ModeList<...>::MAX_LIVE_RECURRENCES     generators alive at once
+ *
+ * A tail outlives its step, so the live bound is not a step's worth: the
+ * scheduler keeps at most GRUVBOK::MIDI::MAX_TAILS_PER_TRACK per track
+ * (evicting the oldest), which makes it that many per track of every
+ * mode that recurs at all.
+ *
+ * It also tells the sequencer which slots to visit on a step:
+ *
+ *   ModeList<...>::SILENT_MODES      bit i: mode i never emits (skip it)
+ *   ModeList<...>::IDLE_STEP_MODES   bit i: mode i renders idle steps too
+ *
+ * create() instantiates the listed modes into consecutive slots (mode i
+ * on MIDI channel i + 1), so the list that is sized is the list that runs.
+ */
+template<typename... Modes>
+struct ModeList;
+
+template<>
+struct ModeList<> {
+  static constexpr uint8_t COUNT = 0;
+  static constexpr uint8_t MAX_EVENTS_PER_CALL = 0;
+  static constexpr uint8_t MAX_RECURRENCES_PER_CALL = 0;
+  static constexpr uint16_t MAX_EVENTS_PER_STEP = 0;
+  static constexpr uint16_t MAX_RECURRENCES_PER_STEP = 0;
+  static constexpr uint16_t MAX_LIVE_RECURRENCES = 0;
+  static constexpr uint16_t SILENT_MODES = 0;
+  static constexpr uint16_t IDLE_STEP_MODES = 0;
+
+  static void create(Mode** slots, uint8_t index = 0) {
+    (void)slots;
+    (void)index;
+  }
+};
+
+template<typename First, typename... Rest>
+struct ModeList<First, Rest...> {
+private:
+  typedef ModeList<Rest...> Tail;
+  static constexpr uint8_t TRACKS = GRUVBOK::Song::NUM_TRACKS;
+
+public:
+  static constexpr uint8_t COUNT = 1 + Tail::COUNT;
+
+  static constexpr uint8_t MAX_EVENTS_PER_CALL =
+      First::MAX_EVENTS > Tail::MAX_EVENTS_PER_CALL ? First::MAX_EVENTS
+                                                    : Tail::MAX_EVENTS_PER_CALL;
+  static constexpr uint8_t MAX_RECURRENCES_PER_CALL =
+      First::MAX_RECURRENCES > Tail::MAX_RECURRENCES_PER_CALL ? First::MAX_RECURRENCES
+                                                              : Tail::MAX_RECURRENCES_PER_CALL;
+
+  static constexpr uint16_t MAX_EVENTS_PER_STEP =
+      (uint16_t)First::MAX_EVENTS * TRACKS + Tail::MAX_EVENTS_PER_STEP;
+  static constexpr uint16_t MAX_RECURRENCES_PER_STEP =
+      (uint16_t)First::MAX_RECURRENCES * TRACKS + Tail::MAX_RECURRENCES_PER_STEP;
+  static constexpr uint16_t MAX_LIVE_RECURRENCES =
+      (First::MAX_RECURRENCES != 0 ? (uint16_t)GRUVBOK::MIDI::MAX_TAILS_PER_TRACK * TRACKS : 0) +
+      Tail::MAX_LIVE_RECURRENCES;
+
+  static constexpr uint16_t SILENT_MODES =
+      (First::MAX_EVENTS == 0 && First::MAX_RECURRENCES == 0 ? 1 : 0) |
+      (uint16_t)(Tail::SILENT_MODES << 1);
+  static constexpr uint16_t IDLE_STEP_MODES =
+      (First::RENDERS_IDLE_STEPS ? 1 : 0) | (uint16_t)(Tail::IDLE_STEP_MODES << 1);
+
+  static_assert(COUNT <= GRUVBOK::Song::NUM_MODES, "more modes than the song has");
+  static_assert(First::MAX_RECURRENCES <= GRUVBOK::MIDI::MAX_TAILS_PER_TRACK,
+                "one render() may not start more tails than its track can keep");
+
+  static void create(Mode** slots, uint8_t index = 0) {
+    slots[index] = new First(index + 1);
+    Tail::create(slots, index + 1);
+  }
+};
+
+#endif  // MODELIST_H
@@ -0,0 +1,78 @@
+#ifndef HOSTMIDIPORT_H
+#define HOSTMIDIPORT_H
+
+/**
+ * HostMIDIPort - MIDI output to a pipe or file on the host build
+ *
+ * Writes the same running-status byte stream as the DIN port to a file
+ * descriptor, so the whole output path can be run and checked on Linux
+ * (e.g. piped into a MIDI monitor, or written to a file and compared).
+ *
+ * The descriptor is switched to non-blocking: a pipe nobody reads fills
+ * up and the port backs up in its own queue instead of stalling the main
+ * loop. Flushed from the main loop (MIDIDispatcher::servicePorts()), so
+ * no system call runs in the dispatch interrupt.
+ */
+
+#ifndef ARDUINO
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "../sequencer/MIDIPort.h"
+
+/**
+ * FdStream - Non-blocking file descriptor with the Stream calls
+ * StreamMIDIPort uses
+ */
+class FdStream {
+private:
+  int fd;
+
+public:
+  static constexpr int CHUNK = 512;  // Bytes offered per write
+
+  explicit FdStream(int descriptor) : fd(descriptor) {
+    if (fd >= 0) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+  }
+
+  int availableForWrite() const { return fd >= 0 ? CHUNK : 0; }
+
+  size_t write(const uint8_t* data, size_t length) {
+    ssize_t n = ::write(fd, data, length);
+    return n > 0 ? (size_t)n : 0;  // Full pipe (EAGAIN): nothing taken
+  }
+
+  int getFd() const { return fd; }
+};
+
+class HostMIDIPort : public StreamMIDIPort<FdStream> {
+private:
+  FdStream out;
+  bool owned;
+
+public:
+  /**
+   * Write to an open descriptor (e.g. one end of a pipe); not closed
+   */
+  explicit HostMIDIPort(int fd)
+    : StreamMIDIPort<FdStream>(&out, false), out(fd), owned(false) {}
+
+  /**
+   * Create or truncate a file (or open a FIFO that has a reader)
+   */
+  explicit HostMIDIPort(const char* path)
+    : StreamMIDIPort<FdStream>(&out, false),
+      out(::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_NONBLOCK, 0644)), owned(true) {}
+
+  ~HostMIDIPort() override {
+    if (owned && out.getFd() >= 0) ::close(out.getFd());
+  }
+
+  bool isOpen() const { return out.getFd() >= 0; }
+};
+
+#endif  // ARDUINO
+
+#endif  // HOSTMIDIPORT_H
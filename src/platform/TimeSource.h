@@ -0,0 +1,116 @@
+#ifndef TIMESOURCE_H
+#define TIMESOURCE_H
+
+#include <stdint.h>
+
+/**
+ * TimeSource - Monotonic 64-bit microsecond time
+ *
+ * The main loop (Sequencer, MIDIScheduler) reads time through this instead
+ * of calling micros() directly, so tests can swap in a ManualTimeSource and
+ * fast-forward through hours or days of uptime in no time.
+ *
+ * 64 bits of microseconds never wrap (about 584,000 years). Code that keeps
+ * 32-bit times (the timing wheel, dispatcher, TickEngine) uses the low
+ * word and compares with signed differences, which holds across the 32-bit
+ * wrap as long as two times are less than 35 minutes apart.
+ */
+class TimeSource {
+public:
+  virtual ~TimeSource() {}
+
+  /**
+   * Microseconds since start; never decreases
+   */
+  virtual uint64_t now() = 0;
+};
+
+/**
+ * WrapExtender - Extends a wrapping 32-bit counter to 64 bits
+ *
+ * Counts wraps by noticing the counter going backwards, so it must see the
+ * counter at least once per wrap period (71.6 minutes for micros()).
+ */
+class WrapExtender {
+private:
+  uint32_t last;
+  uint32_t wraps;
+
+public:
+  WrapExtender() : last(0), wraps(0) {}
+
+  uint64_t extend(uint32_t raw) {
+    if (raw < last) wraps++;
+    last = raw;
+    return ((uint64_t)wraps << 32) | raw;
+  }
+};
+
+/**
+ * ManualTimeSource - Time that only moves when told to (tests, simulation)
+ */
+class ManualTimeSource : public TimeSource {
+private:
+  uint64_t time;
+
+public:
+  explicit ManualTimeSource(uint64_t start = 0) : time(start) {}
+
+  uint64_t now() override { return time; }
+
+  void set(uint64_t t) { time = t; }
+  void advance(uint64_t micros) { time += micros; }
+};
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+/**
+ * SystemTimeSource - micros() extended to 64 bits
+ *
+ * The low word is micros() itself, so 32-bit times taken in the interrupt
+ * line up with it. Main loop only (the wrap count is not interrupt-safe);
+ * the loop reads it far more often than once per 71 minutes.
+ */
+class SystemTimeSource : public TimeSource {
+private:
+  WrapExtender extender;
+
+public:
+  uint64_t now() override { return extender.extend(micros()); }
+
+  static SystemTimeSource& instance() {
+    static SystemTimeSource source;
+    return source;
+  }
+};
+
+#else  // Host build
+
+#include <chrono>
+
+/**
+ * SystemTimeSource - Steady clock since the first read
+ */
+class SystemTimeSource : public TimeSource {
+private:
+  std::chrono::steady_clock::time_point start;
+
+public:
+  SystemTimeSource() : start(std::chrono::steady_clock::now()) {}
+
+  uint64_t now() override {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+  }
+
+  static SystemTimeSource& instance() {
+    static SystemTimeSource source;
+    return source;
+  }
+};
+
+#endif  // ARDUINO
+
+#endif  // TIMESOURCE_H
@@ -0,0 +1,80 @@
+#ifndef TIMERINTERRUPT_H
+#define TIMERINTERRUPT_H
+
+#include <stdint.h>
+
+/**
+ * TimerInterrupt - Periodic interrupt for the step clock
+ *
+ * On Teensy this is a hardware IntervalTimer (PIT). On the host build a
+ * thread stands in for the interrupt, calling the handler at the same
+ * period, so the ISR/main-loop split can be tested on Linux.
+ *
+ * The handler runs concurrently with the main loop: it may only touch
+ * state designed for that (see SPSCQueue and TickEngine).
+ */
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+class TimerInterrupt {
+private:
+  IntervalTimer timer;
+
+public:
+  typedef void (*Handler)();
+
+  /**
+   * Start calling handler every periodMicros
+   * @return false if no hardware timer is free
+   */
+  bool begin(Handler handler, uint32_t periodMicros) {
+    return timer.begin(handler, periodMicros);
+  }
+
+  void end() {
+    timer.end();
+  }
+};
+
+#else  // Host build
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+class TimerInterrupt {
+private:
+  std::thread thread;
+  std::atomic<bool> running;
+
+public:
+  typedef void (*Handler)();
+
+  TimerInterrupt() : running(false) {}
+  ~TimerInterrupt() { end(); }
+
+  bool begin(Handler handler, uint32_t periodMicros) {
+    end();
+    running.store(true);
+    thread = std::thread([this, handler, periodMicros]() {
+      auto next = std::chrono::steady_clock::now();
+      while (running.load(std::memory_order_relaxed)) {
+        next += std::chrono::microseconds(periodMicros);
+        std::this_thread::sleep_until(next);
+        handler();
+      }
+    });
+    return true;
+  }
+
+  void end() {
+    running.store(false);
+    if (thread.joinable()) thread.join();
+  }
+};
+
+#endif  // ARDUINO
+
+#endif  // TIMERINTERRUPT_H
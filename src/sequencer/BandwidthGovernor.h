@@ -0,0 +1,114 @@
+#ifndef BANDWIDTHGOVERNOR_H
+#define BANDWIDTHGOVERNOR_H
+
+#include <stdint.h>
+
+/**
+ * BandwidthGovernor - Output budget in messages per millisecond
+ *
+ * A token bucket refilled at the budget rate and capped at a burst size.
+ * Clock and notes always go out and take their token regardless (the
+ * bucket may go into debt); CCs only go out while a token is available,
+ * so they get whatever bandwidth timing-critical traffic leaves over.
+ *
+ * Also measures the rate actually sent: messages in the current 1 ms
+ * window.
+ *
+ * Tokens are kept in thousandths of a message so fractional budgets
+ * (e.g. 1 per ms on DIN) refill exactly from microsecond timestamps.
+ * Timestamps are wrap-safe (32-bit micros()) and may arrive slightly out
+ * of order; an older one counts as no time passed.
+ */
+class BandwidthGovernor {
+public:
+  static constexpr int32_t UNIT = 1000;  // One message in bucket units
+
+private:
+  uint16_t perMs;       // Budget: messages per millisecond (0 = unlimited)
+  uint16_t burst;       // Bucket capacity in messages
+  int32_t tokens;       // Available, in 1/1000 message (negative: debt)
+  uint32_t lastRefill;
+  bool started;
+
+  uint32_t windowStart; // Start of the current 1 ms measurement window
+  uint16_t windowCount;
+
+  void refill(uint32_t now) {
+    if (!started) {
+      started = true;
+      lastRefill = now;
+      windowStart = now;
+      tokens = (int32_t)burst * UNIT;
+      return;
+    }
+
+    // A timestamp read before the last one (interrupt and main loop stamp
+    // independently) adds nothing and does not move the refill point back
+    int32_t elapsed = (int32_t)(now - lastRefill);
+    if (elapsed <= 0) return;
+    lastRefill = now;
+    int64_t refilled = tokens + (int64_t)elapsed * perMs;  // perMs tokens/ms = perMs units/us
+    int32_t cap = (int32_t)burst * UNIT;
+    tokens = refilled > cap ? cap : (int32_t)refilled;
+
+    if ((int32_t)(now - windowStart) >= 1000) {
+      windowStart = now;
+      windowCount = 0;
+    }
+  }
+
+  void count() {
+    windowCount++;
+  }
+
+public:
+  BandwidthGovernor(uint16_t messagesPerMs, uint16_t burstSize)
+    : perMs(messagesPerMs), burst(burstSize > 0 ? burstSize : 1), tokens(0),
+      lastRefill(0), started(false), windowStart(0), windowCount(0) {}
+
+  /**
+   * Change the budget (0 messages per ms: unlimited). Refills the bucket
+   */
+  void setBudget(uint16_t messagesPerMs, uint16_t burstSize) {
+    perMs = messagesPerMs;
+    burst = burstSize > 0 ? burstSize : 1;
+    started = false;
+  }
+
+  uint16_t getBudget() const { return perMs; }
+  uint16_t getBurst() const { return burst; }
+
+  /**
+   * Account for a message that goes out regardless (clock, notes)
+   */
+  void take(uint32_t now) {
+    refill(now);
+    count();
+    if (perMs == 0) return;
+    tokens -= UNIT;
+    // Bounded debt: a note storm delays CCs by at most one burst
+    int32_t floor = -(int32_t)burst * UNIT;
+    if (tokens < floor) tokens = floor;
+  }
+
+  /**
+   * Take a token for a deferrable message (CCs)
+   * @return false if over budget (the message should wait or be dropped)
+   */
+  bool tryTake(uint32_t now) {
+    refill(now);
+    if (perMs != 0) {
+      if (tokens < UNIT) return false;
+      tokens -= UNIT;
+    }
+    count();
+    return true;
+  }
+
+  /**
+   * Messages sent in the current 1 ms window
+   */
+  uint16_t getWindowCount() const { return windowCount; }
+};
+
+#endif  // BANDWIDTHGOVERNOR_H
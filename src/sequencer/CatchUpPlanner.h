@@ -0,0 +1,176 @@
+#ifndef CATCHUPPLANNER_H
+#define CATCHUPPLANNER_H
+
+#include <stdint.h>
+#include "../core/Constants.h"
+
+/**
+ * CatchUpPlanner - What to do with steps the main loop picked up late
+ *
+ * The timer interrupt keeps ticking while the main loop is starved (long
+ * USB stall, slow input scan). When the loop comes back, several steps may
+ * be waiting at once. A step more than STALL_THRESHOLD_US late is "missed";
+ * the policy decides what happens to missed steps:
+ *
+ * - REPLAY_ALL:  Process every missed step at its logical time. Everything
+ *                already due fires at once (the old burst behaviour).
+ * - SKIP_TO_NOW: Drop missed steps. The position still advances, so the
+ *                song stays on the beat; only the current step plays.
+ * - COMPRESS:    Play missed steps, spread evenly over CATCHUP_WINDOW_US
+ *                from now, so a stall becomes a short roll, not a burst.
+ *                The current step follows at the end of the roll, and the
+ *                roll is shortened to end before the next step is due, so
+ *                steps still come out in order.
+ *
+ * Otherwise steps that are not missed keep their logical time.
+ *
+ * Usage, once per main loop pass with the pending step times (oldest
+ * first):
+ *   planner.beginBatch(times, count, now);
+ *   for (i = 0; i < count; i++) {
+ *     advance position;
+ *     if (planner.planStep(i, base)) processStep(base);
+ *   }
+ *
+ * Stall statistics are kept for runtime inspection.
+ */
+class CatchUpPlanner {
+public:
+  enum Policy : uint8_t {
+    REPLAY_ALL = 0,
+    SKIP_TO_NOW = 1,
+    COMPRESS = 2
+  };
+
+  struct Stats {
+    uint32_t stalls;           // Batches that contained missed steps
+    uint32_t longestStall;     // Worst lateness of a missed step (microseconds)
+    uint32_t stepsSkipped;     // Missed steps dropped (SKIP_TO_NOW)
+    uint32_t stepsCompressed;  // Missed steps squeezed into the window (COMPRESS)
+    uint32_t stepsReplayed;    // Missed steps replayed late (REPLAY_ALL)
+  };
+
+  static constexpr uint8_t MAX_BATCH = 64;
+
+private:
+  Policy policy;
+  uint32_t window;           // COMPRESS window (microseconds)
+
+  // Current batch
+  uint32_t batchTimes[MAX_BATCH];
+  uint8_t batchCount;
+  uint8_t missedCount;       // Missed steps are a prefix of the batch
+  uint32_t batchNow;
+  uint32_t rollSpan;         // COMPRESS: the roll's length, <= window
+
+  Stats stats;
+
+public:
+  CatchUpPlanner()
+    : policy(SKIP_TO_NOW), window(GRUVBOK::Timing::CATCHUP_WINDOW_US),
+      batchCount(0), missedCount(0), batchNow(0), rollSpan(0) {
+    resetStats();
+  }
+
+  void setPolicy(Policy p) { policy = p; }
+  Policy getPolicy() const { return policy; }
+
+  /**
+   * Set the COMPRESS window (microseconds)
+   */
+  void setWindow(uint32_t micros) { window = micros; }
+
+  /**
+   * Start a batch of pending steps
+   * @param stepTimes Ideal step times, oldest first
+   * @param count Number of steps (at most MAX_BATCH)
+   * @param now Current time (microseconds)
+   */
+  void beginBatch(const uint32_t* stepTimes, uint8_t count, uint32_t now) {
+    if (count > MAX_BATCH) count = MAX_BATCH;
+    batchCount = count;
+    batchNow = now;
+    missedCount = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+      batchTimes[i] = stepTimes[i];
+    }
+
+    // The newest step is the current position and is never "missed"
+    while (missedCount + 1 < count &&
+           (int32_t)(now - stepTimes[missedCount]) > (int32_t)GRUVBOK::Timing::STALL_THRESHOLD_US) {
+      missedCount++;
+    }
+
+    if (missedCount > 0) {
+      // The roll ends where the current step goes, which must stay before
+      // the step after it (one interval on from the current one): at most
+      // the window, and short enough that the current step is no closer
+      // to the next one than the rolled steps are to each other
+      uint32_t interval = stepTimes[1] - stepTimes[0];
+      int32_t room = (int32_t)(stepTimes[missedCount] + interval - now);
+      uint32_t fit = room <= 0 ? 0
+          : (uint32_t)(((uint64_t)room * missedCount) / (missedCount + 1));
+      rollSpan = fit < window ? fit : window;
+
+      stats.stalls++;
+      uint32_t stall = now - stepTimes[0];
+      if (stall > stats.longestStall) stats.longestStall = stall;
+
+      switch (policy) {
+        case REPLAY_ALL:  stats.stepsReplayed += missedCount; break;
+        case SKIP_TO_NOW: stats.stepsSkipped += missedCount; break;
+        case COMPRESS:    stats.stepsCompressed += missedCount; break;
+      }
+    }
+  }
+
+  /**
+   * Decide what to do with step 'index' of the current batch
+   * @param baseTime Receives the time to process the step at
+   * @return false if the step should be skipped (position still advances)
+   */
+  bool planStep(uint8_t index, uint32_t& baseTime) const {
+    if (index >= batchCount) return false;
+
+    if (index >= missedCount) {
+      baseTime = batchTimes[index];
+      if (policy == COMPRESS && missedCount > 0) {
+        // After the roll, keeping the spacing of the steps that follow
+        baseTime += batchNow + rollSpan - batchTimes[missedCount];
+      }
+      return true;
+    }
+
+    switch (policy) {
+      case SKIP_TO_NOW:
+        return false;
+
+      case COMPRESS:
+        baseTime = batchNow + (uint32_t)(((uint64_t)rollSpan * index) / missedCount);
+        return true;
+
+      case REPLAY_ALL:
+      default:
+        baseTime = batchTimes[index];
+        return true;
+    }
+  }
+
+  /**
+   * Missed steps in the current batch
+   */
+  uint8_t getMissedCount() const { return missedCount; }
+
+  const Stats& getStats() const { return stats; }
+
+  void resetStats() {
+    stats.stalls = 0;
+    stats.longestStall = 0;
+    stats.stepsSkipped = 0;
+    stats.stepsCompressed = 0;
+    stats.stepsReplayed = 0;
+  }
+};
+
+#endif  // CATCHUPPLANNER_H
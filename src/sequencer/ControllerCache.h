@@ -0,0 +1,77 @@
+#ifndef CONTROLLERCACHE_H
+#define CONTROLLERCACHE_H
+
+#include <stdint.h>
+
+/**
+ * ControllerCache - Last value sent per (channel, controller)
+ *
+ * Lets the output stage drop CCs that would only repeat what the receiver
+ * already has (Mode2's CC65/CC5 on every step, Mode1's pan on every hit,
+ * the slider debug CCs every 50 ms).
+ *
+ * Channel mode messages (CC120-127) are never cached: an all-notes-off
+ * must always go out. CC121 (reset all controllers) forgets the channel,
+ * since the receiver's values are back to defaults.
+ */
+class ControllerCache {
+public:
+  static constexpr uint8_t FIRST_MODE_CC = 120;  // CC120-127: channel mode messages
+  static constexpr uint8_t RESET_ALL_CONTROLLERS = 121;
+  static constexpr uint8_t UNKNOWN = 0xFF;
+
+private:
+  uint8_t values[16][FIRST_MODE_CC];  // UNKNOWN until first sent
+
+public:
+  ControllerCache() {
+    reset();
+  }
+
+  /**
+   * Forget every value (e.g. the receiver may have been reset)
+   */
+  void reset() {
+    for (uint8_t c = 1; c <= 16; c++) {
+      resetChannel(c);
+    }
+  }
+
+  void resetChannel(uint8_t channel) {
+    uint8_t* row = values[(channel - 1) & 0x0F];
+    for (uint8_t i = 0; i < FIRST_MODE_CC; i++) {
+      row[i] = UNKNOWN;
+    }
+  }
+
+  /**
+   * Record a CC that is being sent
+   * @param channel MIDI channel (1-16)
+   * @return false if it repeats the last value sent (redundant)
+   */
+  bool update(uint8_t channel, uint8_t controller, uint8_t value) {
+    if (controller >= FIRST_MODE_CC) {
+      if (controller == RESET_ALL_CONTROLLERS) resetChannel(channel);
+      return true;
+    }
+    uint8_t& last = values[(channel - 1) & 0x0F][controller];
+    if (last == value) return false;
+    last = value;
+    return true;
+  }
+
+  /**
+   * Last value sent, or UNKNOWN
+   */
+  uint8_t get(uint8_t channel, uint8_t controller) const {
+    if (controller >= FIRST_MODE_CC) return UNKNOWN;
+    return values[(channel - 1) & 0x0F][controller];
+  }
+
+  /**
+   * True for controllers the cache tracks (not channel mode messages)
+   */
+  static bool isCached(uint8_t controller) { return controller < FIRST_MODE_CC; }
+};
+
+#endif  // CONTROLLERCACHE_H
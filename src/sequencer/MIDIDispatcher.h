@@ -0,0 +1,475 @@
+#ifndef MIDIDISPATCHER_H
+#define MIDIDISPATCHER_H
+
+#include <stdint.h>
+#include <atomic>
+#include "../core/SPSCQueue.h"
+#include "../core/Constants.h"
+#include "MIDIMessage.h"
+#include "ControllerCache.h"
+#include "BandwidthGovernor.h"
+#include "MIDIPort.h"
+
+/**
+ * MIDIDispatcher - Lock-free hand-off of outgoing MIDI to a timer interrupt
+ *
+ * The main loop produces fully formed messages with post(); the timer
+ * interrupt consumes them with onInterrupt() and sends each one at its
+ * due time. Output latency is then bounded by the interrupt period, not
+ * by the slowest main loop pass.
+ *
+ * Contexts:
+ * - Main loop: post(), statistics
+ * - Interrupt: onInterrupt(), sendNow()
+ *
+ * Messages may be posted ahead of time (see MIDIScheduler's lookahead) and
+ * out of time order. The interrupt moves everything from the SPSC ring
+ * into a small time-sorted list it owns, so a message posted early for
+ * later never holds back one that is due now. Same-time messages keep
+ * their posting order. getSpace() counts the messages in that list too, so
+ * a producer that respects it never fills the list. If one posts past it
+ * anyway, the furthest-future messages are evicted (dropped, counted) to
+ * let earlier ones in; only a list full of due messages leaves the rest of
+ * the ring for the next tick.
+ *
+ * Only the interrupt talks to the output, so USB MIDI is never entered
+ * from two contexts at once.
+ *
+ * Output goes to up to MAX_PORTS MIDIPorts (USB, DIN, recorders, host
+ * pipes), each with its own queue and channel routing, and/or to a plain
+ * Output function. A port that falls behind only backs up its own queue.
+ *
+ * Redundant CCs are filtered on the way out (see setCCFilter()): a CC
+ * repeating the last value sent on its (channel, controller) is dropped,
+ * and optionally several CCs to one controller falling due in the same
+ * interrupt are coalesced to the last value.
+ *
+ * Output is held to a bandwidth budget (see setBandwidth()). Clock, notes
+ * and channel mode messages always go out on time; a CC over budget waits
+ * in a small deferred list and goes out with a later tick's spare budget.
+ * A deferred CC superseded by a newer value for its controller, or pushed
+ * out of a full list, is thinned (dropped). Debug CCs are pushed out first.
+ */
+class MIDIDispatcher {
+public:
+  /**
+   * Output for a batch of due messages (called from the interrupt, at most
+   * once per tick with everything due in it; flush once per call)
+   */
+  typedef void (*Output)(const MIDIMessage* messages, uint8_t count);
+
+  static constexpr uint8_t MAX_PORTS = 4;
+  static constexpr uint16_t RING_SIZE = 128;   // SPSC ring (127 usable)
+  static constexpr uint8_t PENDING_SIZE = 64;  // Interrupt-side sorted list
+  static constexpr uint8_t DEFERRED_SIZE = 16; // CCs waiting for budget
+
+  /**
+   * CC filter flags
+   */
+  enum CCFilter : uint8_t {
+    CC_PASS_ALL = 0,
+    CC_DROP_DUPLICATES = 0x01,   // Drop a CC equal to the last value sent
+    CC_COALESCE = 0x02           // Same controller due in one tick: last value only
+  };
+
+private:
+  Output output;                 // Optional
+  MIDIPort* ports[MAX_PORTS];
+  uint8_t portCount;
+  SPSCQueue<MIDIMessage, RING_SIZE> ring;
+
+  // Main loop owned statistics
+  uint32_t overflowCount;       // Messages dropped because the ring was full
+  uint16_t maxFill;             // Highest ring fill seen at post time
+
+  // Interrupt owned
+  MIDIMessage pending[PENDING_SIZE];  // Sorted by time, FIFO within a time
+  uint8_t pendingCount;
+  ControllerCache controllers;        // Last CC values sent
+  uint32_t coalesceSeen[16][4];       // Scratch: controllers seen in this tick
+  MIDIMessage batch[PENDING_SIZE];    // Messages going out this tick
+  MIDIMessage deferred[DEFERRED_SIZE];// Over-budget CCs, oldest first, one per controller
+  uint8_t deferredCount;
+  BandwidthGovernor governor;
+
+  // Shared
+  std::atomic<uint8_t> ccFilter;
+  std::atomic<bool> cacheResetRequested;
+  std::atomic<uint32_t> budgetRequest;  // Pending setBandwidth() (perMs << 16 | burst)
+  std::atomic<uint16_t> outstanding;    // Posted and not yet sent or evicted
+  std::atomic<uint32_t> suppressedCCs;  // Duplicates dropped
+  std::atomic<uint32_t> coalescedCCs;   // Superseded within a tick
+  std::atomic<uint32_t> deferredCCs;    // Held back for budget
+  std::atomic<uint32_t> thinnedCCs;     // Deferred and then dropped
+  std::atomic<uint32_t> evictedMessages;// Dropped from a full pending list
+  std::atomic<uint16_t> peakRate;       // Most messages sent within 1 ms
+
+  static constexpr uint32_t NO_REQUEST = 0xFFFFFFFF;
+
+  static bool isCachedCC(const MIDIMessage& msg) {
+    return msg.getType() == 0xB0 && ControllerCache::isCached(msg.data1);
+  }
+
+  // Mark CCs overwritten by a later CC to the same controller in due[0..count)
+  void markCoalesced(uint8_t count, bool* skip) {
+    for (uint8_t i = count; i-- > 0;) {
+      const MIDIMessage& msg = pending[i];
+      if (!isCachedCC(msg)) continue;
+      uint32_t& word = coalesceSeen[msg.status & 0x0F][msg.data1 >> 5];
+      uint32_t bit = (uint32_t)1 << (msg.data1 & 31);
+      if (word & bit) {
+        skip[i] = true;
+      }
+      word |= bit;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+      const MIDIMessage& msg = pending[i];
+      if (isCachedCC(msg)) {
+        coalesceSeen[msg.status & 0x0F][msg.data1 >> 5] = 0;
+      }
+    }
+  }
+
+  bool isRedundant(const MIDIMessage& msg, uint8_t filter) const {
+    return (filter & CC_DROP_DUPLICATES) &&
+           controllers.get(msg.getChannel(), msg.data1) == msg.data2;
+  }
+
+  void removeDeferred(uint8_t index) {
+    for (uint8_t i = index + 1; i < deferredCount; i++) {
+      deferred[i - 1] = deferred[i];
+    }
+    deferredCount--;
+  }
+
+  // A newer value for the controller makes a deferred one obsolete
+  void supersedeDeferred(const MIDIMessage& msg) {
+    for (uint8_t i = 0; i < deferredCount; i++) {
+      if (deferred[i].status == msg.status && deferred[i].data1 == msg.data1) {
+        removeDeferred(i);
+        thinnedCCs.fetch_add(1, std::memory_order_relaxed);
+        return;  // At most one per controller
+      }
+    }
+  }
+
+  // Hold a CC back for a later tick; a full list drops its oldest,
+  // lowest-priority entry
+  void defer(const MIDIMessage& msg) {
+    if (deferredCount == DEFERRED_SIZE) {
+      uint8_t victim = 0;
+      for (uint8_t i = 1; i < deferredCount; i++) {
+        if (deferred[i].priority < deferred[victim].priority) victim = i;
+      }
+      removeDeferred(victim);
+      thinnedCCs.fetch_add(1, std::memory_order_relaxed);
+    }
+    deferred[deferredCount++] = msg;
+    deferredCCs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Hand a batch to the output and to every port it is routed to
+  void deliver(const MIDIMessage* messages, uint8_t count) {
+    if (output != nullptr) {
+      output(messages, count);
+    }
+    for (uint8_t p = 0; p < portCount; p++) {
+      MIDIPort* port = ports[p];
+      for (uint8_t i = 0; i < count; i++) {
+        if (port->routes(messages[i])) port->enqueue(messages[i]);
+      }
+      if (port->flushInInterrupt()) port->flush();
+    }
+  }
+
+  void publishRate() {
+    uint16_t rate = governor.getWindowCount();
+    if (rate > peakRate.load(std::memory_order_relaxed)) {
+      peakRate.store(rate, std::memory_order_relaxed);
+    }
+  }
+
+  // Filter the first 'count' pending messages, then send them with any
+  // deferred CCs the budget allows as one batch (one output call, one
+  // flush per tick)
+  void sendDue(uint8_t count, uint32_t now) {
+    if (cacheResetRequested.exchange(false, std::memory_order_acquire)) {
+      controllers.reset();
+    }
+    uint32_t budget = budgetRequest.exchange(NO_REQUEST, std::memory_order_acquire);
+    if (budget != NO_REQUEST) {
+      governor.setBudget(budget >> 16, budget & 0xFFFF);
+    }
+
+    uint8_t filter = ccFilter.load(std::memory_order_relaxed);
+    bool skip[PENDING_SIZE] = {};
+    if (filter & CC_COALESCE) {
+      markCoalesced(count, skip);
+    }
+
+    uint8_t batched = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      const MIDIMessage& msg = pending[i];
+      if (isCachedCC(msg)) {
+        if (skip[i]) {
+          coalescedCCs.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        supersedeDeferred(msg);
+        if (isRedundant(msg, filter)) {
+          suppressedCCs.fetch_add(1, std::memory_order_relaxed);
+          continue;
+        }
+        if (msg.priority <= MIDIEvent::PRIORITY_CC && !governor.tryTake(now)) {
+          defer(msg);
+          continue;
+        }
+        controllers.update(msg.getChannel(), msg.data1, msg.data2);
+      } else {
+        if (msg.getType() == 0xB0) {
+          controllers.update(msg.getChannel(), msg.data1, msg.data2);  // CC121 resets
+        }
+        governor.take(now);
+      }
+      batch[batched++] = msg;
+    }
+
+    // Spare budget goes to deferred CCs, oldest first
+    while (deferredCount > 0 && batched < PENDING_SIZE) {
+      MIDIMessage msg = deferred[0];
+      if (isRedundant(msg, filter)) {
+        removeDeferred(0);
+        suppressedCCs.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      if (!governor.tryTake(now)) break;
+      removeDeferred(0);
+      controllers.update(msg.getChannel(), msg.data1, msg.data2);
+      batch[batched++] = msg;
+    }
+
+    if (batched > 0) {
+      deliver(batch, batched);
+      publishRate();
+    }
+  }
+
+  // Insert into the sorted pending list after all messages due no later
+  void insertPending(const MIDIMessage& msg) {
+    uint8_t i = pendingCount;
+    while (i > 0 && (int32_t)(pending[i - 1].time - msg.time) > 0) {
+      pending[i] = pending[i - 1];
+      i--;
+    }
+    pending[i] = msg;
+    pendingCount++;
+  }
+
+  // Room for one more message: a full list can still give up its last
+  // entry if that one is not due yet
+  bool canTake(uint32_t now) const {
+    return pendingCount < PENDING_SIZE ||
+           (int32_t)(pending[PENDING_SIZE - 1].time - now) > 0;
+  }
+
+  // Full list: keep the earliest PENDING_SIZE messages and drop the
+  // furthest-future one (the newcomer when it is not earlier)
+  void evictLatest(const MIDIMessage& msg) {
+    if ((int32_t)(pending[PENDING_SIZE - 1].time - msg.time) > 0) {
+      pendingCount--;
+      insertPending(msg);
+    }
+    outstanding.fetch_sub(1, std::memory_order_relaxed);
+    evictedMessages.fetch_add(1, std::memory_order_relaxed);
+  }
+
+public:
+  explicit MIDIDispatcher(Output out = nullptr)
+    : output(out), ports(), portCount(0), overflowCount(0), maxFill(0), pendingCount(0), coalesceSeen(),
+      deferredCount(0),
+      governor(GRUVBOK::MIDI::OUTPUT_BUDGET_PER_MS, GRUVBOK::MIDI::OUTPUT_BURST),
+      ccFilter(CC_DROP_DUPLICATES), cacheResetRequested(false), budgetRequest(NO_REQUEST),
+      outstanding(0), suppressedCCs(0), coalescedCCs(0), deferredCCs(0), thinnedCCs(0), evictedMessages(0),
+      peakRate(0) {}
+
+  // ========================================
+  // Main loop side
+  // ========================================
+
+  /**
+   * Queue a message for sending at msg.time
+   * @return false if the ring was full (message dropped, counted)
+   */
+  bool post(const MIDIMessage& msg) {
+    outstanding.fetch_add(1, std::memory_order_relaxed);  // Before the interrupt can see it
+    if (!ring.push(msg)) {
+      outstanding.fetch_sub(1, std::memory_order_relaxed);
+      overflowCount++;
+      return false;
+    }
+    uint16_t fill = ring.size();
+    if (fill > maxFill) maxFill = fill;
+    return true;
+  }
+
+  /**
+   * True if post() would succeed without evicting a message for later
+   */
+  bool hasSpace() const { return getSpace() > 0; }
+
+  /**
+   * Messages post() can take before the ring or the pending list is full
+   */
+  uint16_t getSpace() const {
+    uint16_t ringSpace = ring.getCapacity() - ring.size();
+    uint16_t queued = outstanding.load(std::memory_order_relaxed);
+    uint16_t listSpace = queued < PENDING_SIZE ? PENDING_SIZE - queued : 0;
+    return ringSpace < listSpace ? ringSpace : listSpace;
+  }
+
+  uint32_t getOverflowCount() const { return overflowCount; }
+  uint16_t getMaxFill() const { return maxFill; }
+  static constexpr uint16_t getCapacity() { return RING_SIZE - 1; }
+
+  void resetStats() {
+    overflowCount = 0;
+    maxFill = 0;
+    suppressedCCs.store(0, std::memory_order_relaxed);
+    coalescedCCs.store(0, std::memory_order_relaxed);
+    deferredCCs.store(0, std::memory_order_relaxed);
+    thinnedCCs.store(0, std::memory_order_relaxed);
+    evictedMessages.store(0, std::memory_order_relaxed);
+    peakRate.store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * Choose CC filtering (CCFilter flags; default CC_DROP_DUPLICATES)
+   */
+  void setCCFilter(uint8_t flags) { ccFilter.store(flags, std::memory_order_relaxed); }
+  uint8_t getCCFilter() const { return ccFilter.load(std::memory_order_relaxed); }
+
+  /**
+   * Forget the CC values sent so far, so the next CC of every controller
+   * goes out (applied by the next interrupt)
+   */
+  void invalidateControllerCache() { cacheResetRequested.store(true, std::memory_order_release); }
+
+  /**
+   * CCs dropped as repeats of the last value sent
+   */
+  uint32_t getSuppressedCCCount() const { return suppressedCCs.load(std::memory_order_relaxed); }
+
+  /**
+   * CCs superseded by a later value for the same controller in one tick
+   */
+  uint32_t getCoalescedCCCount() const { return coalescedCCs.load(std::memory_order_relaxed); }
+
+  /**
+   * Set the output budget (applied by the next interrupt)
+   * @param messagesPerMs Sustained rate; 0 disables the budget
+   * @param burst Messages that may go out back to back after idle time
+   */
+  void setBandwidth(uint16_t messagesPerMs, uint16_t burst) {
+    budgetRequest.store(((uint32_t)messagesPerMs << 16) | burst, std::memory_order_release);
+  }
+
+  /**
+   * CCs held back because the budget was exhausted
+   */
+  uint32_t getDeferredCCCount() const { return deferredCCs.load(std::memory_order_relaxed); }
+
+  /**
+   * Deferred CCs dropped: superseded by a newer value, or pushed out
+   */
+  uint32_t getThinnedCCCount() const { return thinnedCCs.load(std::memory_order_relaxed); }
+
+  /**
+   * Messages for later dropped to make room in a full pending list
+   */
+  uint32_t getEvictedCount() const { return evictedMessages.load(std::memory_order_relaxed); }
+
+  /**
+   * Most messages sent within one millisecond
+   */
+  uint16_t getPeakRate() const { return peakRate.load(std::memory_order_relaxed); }
+
+  /**
+   * Add an output port (setup only, before the dispatch interrupt runs)
+   * @return false if MAX_PORTS are already attached
+   */
+  bool addPort(MIDIPort* port) {
+    if (port == nullptr || portCount >= MAX_PORTS) return false;
+    ports[portCount++] = port;
+    return true;
+  }
+
+  uint8_t getPortCount() const { return portCount; }
+  MIDIPort* getPort(uint8_t index) const { return index < portCount ? ports[index] : nullptr; }
+
+  /**
+   * Flush the ports that are not flushed by the interrupt (main loop)
+   */
+  void servicePorts() {
+    for (uint8_t p = 0; p < portCount; p++) {
+      if (!ports[p]->flushInInterrupt()) ports[p]->flush();
+    }
+  }
+
+  // ========================================
+  // Interrupt side
+  // ========================================
+
+  /**
+   * Send one message immediately (interrupt context only, e.g. MIDI clock).
+   * Never held back by the budget, but counted against it
+   */
+  void sendNow(const MIDIMessage& msg) {
+    governor.take(msg.time);
+    deliver(&msg, 1);
+    publishRate();
+  }
+
+  /**
+   * Timer interrupt handler body: send everything due at or before now
+   * @param now Current time (microseconds)
+   */
+  void onInterrupt(uint32_t now) {
+    // Take over new messages; a full sorted list evicts its furthest-future
+    // entries, since one of the messages still in the ring may be due now
+    MIDIMessage msg;
+    while (canTake(now) && ring.pop(msg)) {
+      if (pendingCount < PENDING_SIZE) {
+        insertPending(msg);
+      } else {
+        evictLatest(msg);
+      }
+    }
+
+    // Send the due prefix in batches
+    uint8_t due = 0;
+    while (due < pendingCount && (int32_t)(pending[due].time - now) <= 0) {
+      due++;
+    }
+
+    if (due > 0 || deferredCount > 0) {
+      sendDue(due, now);
+      for (uint8_t i = due; i < pendingCount; i++) {
+        pending[i - due] = pending[i];
+      }
+      pendingCount -= due;
+      outstanding.fetch_sub(due, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Messages taken off the ring but not yet due (interrupt context)
+   */
+  uint8_t getPendingCount() const { return pendingCount; }
+
+  /**
+   * CCs waiting for budget (interrupt context)
+   */
+  uint8_t getDeferredCount() const { return deferredCount; }
+};
+
+#endif  // MIDIDISPATCHER_H
@@ -0,0 +1,117 @@
+#ifndef MIDIENCODING_H
+#define MIDIENCODING_H
+
+#include <stdint.h>
+#include "MIDIMessage.h"
+
+/**
+ * MIDIEncoding - Wire formats for outgoing MIDIMessages
+ *
+ * USB: every message becomes one 4-byte USB-MIDI event packet. A dispatch
+ * tick's messages are written as packets back to back and flushed once,
+ * so a busy step leaves as one USB transfer instead of one per message.
+ *
+ * DIN/serial: 3125 bytes per second, so every byte counts. Running status
+ * omits a status byte equal to the previous one, and note offs are sent
+ * as zero-velocity note ons so that notes on a channel share one status.
+ */
+namespace MIDIEncoding {
+
+  /**
+   * USB-MIDI 1.0 event packet, little endian: header (cable, code index),
+   * status, data1, data2
+   */
+  inline uint32_t usbPacket(const MIDIMessage& msg, uint8_t cable = 0) {
+    uint8_t codeIndex = msg.isRealTime() ? 0x0F : (msg.status >> 4);
+    uint8_t data2 = msg.getDataLength() == 2 ? msg.data2 : 0;
+    uint8_t data1 = msg.getDataLength() >= 1 ? msg.data1 : 0;
+    return (uint32_t)(((cable & 0x0F) << 4) | codeIndex) |
+           ((uint32_t)msg.status << 8) |
+           ((uint32_t)data1 << 16) |
+           ((uint32_t)data2 << 24);
+  }
+
+  /**
+   * Pack a batch of messages into USB-MIDI event packets
+   * @return Number of packets written (one per message)
+   */
+  inline uint8_t packUsb(const MIDIMessage* messages, uint8_t count, uint32_t* packets,
+                         uint8_t cable = 0) {
+    for (uint8_t i = 0; i < count; i++) {
+      packets[i] = usbPacket(messages[i], cable);
+    }
+    return count;
+  }
+
+  /**
+   * RunningStatusEncoder - Byte stream for a serial (DIN) MIDI port
+   *
+   * Keeps the running status across calls, so one instance belongs to one
+   * port. Real-time messages may be interleaved without breaking it.
+   */
+  class RunningStatusEncoder {
+  private:
+    uint8_t runningStatus;   // 0 = none (next message sends its status)
+    bool noteOffAsNoteOn;
+
+  public:
+    static constexpr uint8_t MAX_BYTES = 3;   // Per message
+
+    RunningStatusEncoder() : runningStatus(0), noteOffAsNoteOn(true) {}
+
+    /**
+     * Send the next status byte in full (e.g. after the cable was replugged)
+     */
+    void reset() { runningStatus = 0; }
+
+    /**
+     * Send note offs as zero-velocity note ons (default on)
+     */
+    void setNoteOffAsNoteOn(bool enabled) { noteOffAsNoteOn = enabled; }
+
+    /**
+     * Encode one message
+     * @param out At least MAX_BYTES bytes
+     * @return Bytes written
+     */
+    uint8_t encode(const MIDIMessage& msg, uint8_t* out) {
+      if (msg.isRealTime()) {
+        out[0] = msg.status;
+        return 1;
+      }
+
+      uint8_t status = msg.status;
+      uint8_t data2 = msg.data2;
+      if (noteOffAsNoteOn && msg.getType() == 0x80) {
+        status = 0x90 | (status & 0x0F);
+        data2 = 0;
+      }
+
+      uint8_t n = 0;
+      if (status != runningStatus) {
+        out[n++] = status;
+        runningStatus = status;
+      }
+      out[n++] = msg.data1;
+      if (msg.getDataLength() == 2) {
+        out[n++] = data2;
+      }
+      return n;
+    }
+
+    /**
+     * Encode a batch
+     * @param out At least count * MAX_BYTES bytes
+     * @return Bytes written
+     */
+    uint16_t encode(const MIDIMessage* messages, uint8_t count, uint8_t* out) {
+      uint16_t length = 0;
+      for (uint8_t i = 0; i < count; i++) {
+        length += encode(messages[i], out + length);
+      }
+      return length;
+    }
+  };
+}
+
+#endif  // MIDIENCODING_H
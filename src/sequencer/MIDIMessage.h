@@ -0,0 +1,59 @@
+#ifndef MIDIMESSAGE_H
+#define MIDIMESSAGE_H
+
+#include <stdint.h>
+#include "../core/MIDIEvent.h"
+
+/**
+ * MIDIMessage - A fully formed outgoing MIDI message with its send time
+ */
+struct MIDIMessage {
+  // System real-time status bytes
+  static constexpr uint8_t CLOCK = 0xF8;
+  static constexpr uint8_t START = 0xFA;
+  static constexpr uint8_t STOP = 0xFC;
+
+  uint32_t time;    // When to send (microseconds)
+  uint8_t status;   // Status byte, channel included (0x90 | (channel - 1)), or 0xF8-0xFF
+  uint8_t data1;
+  uint8_t data2;
+  uint8_t priority; // MIDIEvent::Priority (what the output may defer or thin)
+
+  static MIDIMessage channelMessage(uint32_t time, uint8_t type, uint8_t channel,
+                                    uint8_t data1, uint8_t data2) {
+    uint8_t priority = type == 0xB0 ? MIDIEvent::PRIORITY_CC
+                     : type == 0x80 ? MIDIEvent::PRIORITY_NOTE_OFF
+                     : MIDIEvent::PRIORITY_NOTE_ON;
+    MIDIMessage msg = {time, (uint8_t)(type | ((channel - 1) & 0x0F)), data1, data2, priority};
+    return msg;
+  }
+
+  static MIDIMessage realTime(uint32_t time, uint8_t status) {
+    MIDIMessage msg = {time, status, 0, 0, MIDIEvent::PRIORITY_NOTE_OFF};
+    return msg;
+  }
+
+  /**
+   * Same message with another priority class (e.g. PRIORITY_DEBUG)
+   */
+  MIDIMessage withPriority(uint8_t p) const {
+    MIDIMessage msg = *this;
+    msg.priority = p;
+    return msg;
+  }
+
+  bool isRealTime() const { return status >= 0xF8; }
+  uint8_t getType() const { return status & 0xF0; }
+  uint8_t getChannel() const { return (status & 0x0F) + 1; }
+
+  /**
+   * Data bytes after the status byte (0-2)
+   */
+  uint8_t getDataLength() const {
+    if (isRealTime()) return 0;
+    uint8_t type = getType();
+    return (type == 0xC0 || type == 0xD0) ? 1 : 2;
+  }
+};
+
+#endif  // MIDIMESSAGE_H
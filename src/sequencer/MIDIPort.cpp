@@ -0,0 +1,19 @@
+#include "MIDIPort.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+void UsbMIDIPort::flush() {
+  // Write everything queued as USB-MIDI event packets into the transmit
+  // buffer back to back, then flush once: one transfer per tick
+  MIDIMessage msg;
+  bool sent = false;
+  while (next(msg)) {
+    usb_midi_write_packed(MIDIEncoding::usbPacket(msg));
+    sent = true;
+  }
+  if (sent) {
+    usbMIDI.send_now();
+  }
+}
+#endif
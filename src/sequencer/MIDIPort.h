@@ -0,0 +1,218 @@
+#ifndef MIDIPORT_H
+#define MIDIPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "../core/SPSCQueue.h"
+#include "MIDIMessage.h"
+#include "MIDIEncoding.h"
+
+/**
+ * MIDIPort - One MIDI output (USB, DIN, a recorder, a host pipe or file)
+ *
+ * The dispatch interrupt hands each port the messages routed to it through
+ * the port's own lock-free queue, and the port drains that queue to its
+ * device in flush() without ever blocking. A port that cannot keep up (DIN
+ * at 31250 baud, a pipe nobody reads) backs up in its own queue and drops
+ * from it when full, so it never delays any other port.
+ *
+ * Routing: a channel mask (bit 0 = channel 1) and whether system real-time
+ * messages (clock, start, stop) go to the port.
+ *
+ * Contexts:
+ * - Dispatch interrupt: enqueue()
+ * - flush(): the dispatch interrupt, right after enqueuing, for ports
+ *   created with flushInInterrupt (USB, DIN); otherwise the main loop
+ *   (MIDIDispatcher::servicePorts())
+ * - Any: routing, statistics
+ */
+class MIDIPort {
+public:
+  static constexpr uint16_t QUEUE_SIZE = 128;   // Messages (127 usable)
+  static constexpr uint16_t ALL_CHANNELS = 0xFFFF;
+
+private:
+  SPSCQueue<MIDIMessage, QUEUE_SIZE> queue;
+  const bool interruptFlush;
+  std::atomic<uint16_t> channelMask;
+  std::atomic<bool> realTime;
+  std::atomic<uint32_t> overflowCount;  // Messages dropped, queue full
+
+protected:
+  /**
+   * Take the next queued message (flush() context only)
+   */
+  bool next(MIDIMessage& msg) { return queue.pop(msg); }
+
+public:
+  explicit MIDIPort(bool flushInInterrupt)
+    : interruptFlush(flushInInterrupt), channelMask(ALL_CHANNELS), realTime(true),
+      overflowCount(0) {}
+
+  virtual ~MIDIPort() {}
+
+  /**
+   * Send queued messages to the device, as far as it takes them now.
+   * Must never block
+   */
+  virtual void flush() = 0;
+
+  bool flushInInterrupt() const { return interruptFlush; }
+
+  /**
+   * True if msg goes to this port
+   */
+  bool routes(const MIDIMessage& msg) const {
+    if (msg.isRealTime()) return realTime.load(std::memory_order_relaxed);
+    return (channelMask.load(std::memory_order_relaxed) >> (msg.status & 0x0F)) & 1;
+  }
+
+  /**
+   * Queue a message (dispatch interrupt only)
+   * @return false if the queue was full (message dropped, counted)
+   */
+  bool enqueue(const MIDIMessage& msg) {
+    if (!queue.push(msg)) {
+      overflowCount.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  // ========================================
+  // Routing
+  // ========================================
+
+  /**
+   * Channels sent to this port (bit 0 = channel 1; default all)
+   */
+  void setChannels(uint16_t mask) { channelMask.store(mask, std::memory_order_relaxed); }
+  uint16_t getChannels() const { return channelMask.load(std::memory_order_relaxed); }
+
+  /**
+   * Route one channel (1-16) to this port or not
+   */
+  void routeChannel(uint8_t channel, bool enabled) {
+    uint16_t bit = (uint16_t)1 << ((channel - 1) & 0x0F);
+    uint16_t mask = getChannels();
+    setChannels(enabled ? (mask | bit) : (mask & ~bit));
+  }
+
+  /**
+   * Send clock, start and stop to this port (default on)
+   */
+  void setRealTime(bool enabled) { realTime.store(enabled, std::memory_order_relaxed); }
+  bool getRealTime() const { return realTime.load(std::memory_order_relaxed); }
+
+  // ========================================
+  // Statistics
+  // ========================================
+
+  uint16_t getQueued() const { return queue.size(); }
+  bool hasSpace() const { return queue.size() < queue.getCapacity(); }
+  uint16_t getSpace() const { return queue.getCapacity() - queue.size(); }
+  uint32_t getOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+  void resetStats() { overflowCount.store(0, std::memory_order_relaxed); }
+};
+
+/**
+ * StreamMIDIPort - Byte stream output with running status (DIN MIDI)
+ *
+ * Stream needs availableForWrite() and write(const uint8_t*, size_t)
+ * returning the bytes taken: Teensy's HardwareSerial for DIN, FdStream on
+ * the host (see platform/HostMIDIPort.h). flush() only writes what the
+ * stream has room for; the rest waits in the port queue, which is the
+ * port's TX ring. A message cut short keeps its remaining bytes for the
+ * next flush, so the byte stream stays intact.
+ */
+template<typename Stream>
+class StreamMIDIPort : public MIDIPort {
+private:
+  Stream* stream;
+  MIDIEncoding::RunningStatusEncoder encoder;
+  uint8_t bytes[MIDIEncoding::RunningStatusEncoder::MAX_BYTES];  // Message being written
+  uint8_t written;
+  uint8_t length;
+
+public:
+  explicit StreamMIDIPort(Stream* out, bool flushInInterrupt = true)
+    : MIDIPort(flushInInterrupt), stream(out), written(0), length(0) {}
+
+  void flush() override {
+    for (;;) {
+      int room = stream->availableForWrite();
+      if (room <= 0) return;
+
+      if (written == length) {
+        MIDIMessage msg;
+        if (!next(msg)) return;
+        length = encoder.encode(msg, bytes);
+        written = 0;
+      }
+
+      size_t want = length - written;
+      if ((size_t)room < want) want = room;
+      written += stream->write(bytes + written, want);
+      if (written < length) return;  // Stream is full for now
+    }
+  }
+
+  /**
+   * Send the next status byte in full (e.g. after a cable was replugged)
+   */
+  void resetRunningStatus() { encoder.reset(); }
+
+  MIDIEncoding::RunningStatusEncoder& getEncoder() { return encoder; }
+};
+
+/**
+ * RecordingMIDIPort - Keeps the first N messages it is sent
+ *
+ * For tests and diagnostics: the whole output path (scheduler, dispatcher,
+ * routing) can be checked on the host. Messages past N are counted only.
+ */
+template<uint16_t N>
+class RecordingMIDIPort : public MIDIPort {
+private:
+  MIDIMessage log[N];
+  uint16_t count;
+  uint32_t total;
+
+public:
+  explicit RecordingMIDIPort(bool flushInInterrupt = true)
+    : MIDIPort(flushInInterrupt), count(0), total(0) {}
+
+  void flush() override {
+    MIDIMessage msg;
+    while (next(msg)) {
+      if (count < N) log[count++] = msg;
+      total++;
+    }
+  }
+
+  uint16_t size() const { return count; }
+  uint32_t getTotal() const { return total; }
+  const MIDIMessage& operator[](uint16_t index) const { return log[index]; }
+
+  void clear() {
+    count = 0;
+    total = 0;
+  }
+};
+
+#ifdef ARDUINO
+/**
+ * UsbMIDIPort - Teensy USB MIDI
+ *
+ * Writes a flush's messages as USB-MIDI event packets back to back and
+ * sends them once, so a dispatch tick leaves as one USB transfer.
+ */
+class UsbMIDIPort : public MIDIPort {
+public:
+  UsbMIDIPort() : MIDIPort(true) {}
+  void flush() override;
+};
+#endif
+
+#endif  // MIDIPORT_H
@@ -3,11 +3,58 @@
 
 #include <stdint.h>
 #include "../core/MIDIEvent.h"
+#include "../core/SlotMask.h"
+#include "TimingWheel.h"
+#include "TempoMap.h"
+#include "MIDIDispatcher.h"
+#include "VoiceTracker.h"
+#include "SchedulerSink.h"
+#include "../platform/TimeSource.h"
 
 /**
- * MIDIScheduler - Manages scheduled MIDI events with delta timing
+ * EventHandle - Refers to one pending scheduled event
  *
- * NEW: Supports bulk scheduling from MIDIEventBuffer for pure functional modes.
+ * The event's slot plus the slot's generation when it was scheduled. When
+ * the event fires, is cancelled or is evicted, the slot's generation moves
+ * on and the handle goes stale; cancel() and retime() then do nothing.
+ * Two bytes for pools of up to 254 slots, copied freely. (The 8-bit
+ * generation repeats after 256 reuses of one slot; hold handles for a few
+ * steps, not forever.)
+ */
+template<typename Index>
+struct BasicEventHandle {
+  static constexpr Index NONE = (Index)~(Index)0;
+
+  Index slot;
+  uint8_t generation;
+
+  BasicEventHandle() : slot(NONE), generation(0) {}
+  BasicEventHandle(Index s, uint8_t g) : slot(s), generation(g) {}
+
+  bool isNone() const { return slot == NONE; }
+};
+
+typedef BasicEventHandle<uint8_t> EventHandle;
+
+/**
+ * Overflow policies for MIDIScheduler: what a full pool does with one
+ * more event
+ */
+struct EvictLowerPriority {
+  // Evict the lowest-class, furthest-future event if its class is below
+  // the new one's, so a NOTE_OFF is never lost to notes or CCs. The victim
+  // search scans the whole pool
+  static constexpr bool EVICTS = true;
+};
+
+struct RejectWhenFull {
+  // Drop the new event, whatever it is. For pools sized so they never
+  // fill (large host builds), where a whole-pool scan is wasted work
+  static constexpr bool EVICTS = false;
+};
+
+/**
+ * MIDIScheduler - Manages scheduled MIDI events with delta timing
  *
  * Individual methods (for compatibility):
  * - note(pitch, velocity, delta)
@@ -15,68 +62,227 @@
  * - cc(controller, value, delta)
  * - stopall(delta)
  *
- * Bulk method (preferred):
- * - scheduleAll(MIDIEventBuffer)
+ * From modes (preferred):
+ * - SchedulerSink(scheduler, stepTime): modes write each event straight
+ *   into a slot, no copy in between
+ * - scheduleAll(MIDIEventBuffer): a recorded list in bulk
+ *
+ * Events are scheduled relative to a base time + delta offset: the current
+ * time for the individual methods, or the step's ideal (logical) start for
+ * a SchedulerSink or scheduleAll(buffer, stepTime). With logical time,
+ * processing a step late does not shift its events; beginStep() records
+ * how late each step was.
  *
- * Events are scheduled relative to the current time + delta offset.
+ * Storage is a fixed pool of slots ordered by a hierarchical TimingWheel
+ * (no dynamic allocation):
+ * - Insert and expiry are O(1), free slots come from an O(1) free list
+ * - update() only touches events that are due; far-future events (long
+ *   echo tails) wait in outer wheel buckets at no per-update cost
+ * - Events with the same execute time fire in insertion order (FIFO), so a
+ *   NOTE_OFF followed by a NOTE_ON for the same pitch can never swap
+ *
+ * With a MIDIDispatcher, update() only hands events due within the next
+ * DISPATCH_LOOKAHEAD_US to the dispatcher's ring, and the dispatch
+ * interrupt sends them at their exact time. Without one, update() sends
+ * due events directly (polled) to a MIDIPort, if one is given.
+ *
+ * Every note leaving the scheduler passes through a VoiceTracker, which
+ * suppresses redundant offs, keeps overlapping hits of one pitch sounding
+ * until the last off, and steals the oldest voice above the polyphony
+ * limit. panic() sends an exact NOTE_OFF for each sounding note.
+ *
+ * Every event has a priority class (note off > note on > CC > debug CC).
+ * When the pool is full, the lowest-class, furthest-future event is
+ * evicted if its class is below the new event's; otherwise the new event
+ * is dropped (with Policy = RejectWhenFull, the new event is always
+ * dropped). A NOTE_OFF can only be lost to a pool full of NOTE_OFFs.
+ * Losses are counted per class, and hasBackpressure() tells the sequencer
+ * to shed optional traffic.
+ *
+ * Pending events can be changed after scheduling: note()/off()/cc()/
+ * stopall() return an EventHandle for O(1) cancel() and retime(), and
+ * cancelChannel()/cancelOrigin() drop everything pending for a channel or
+ * for the (mode, track) that produced it (a pattern change cutting Mode3
+ * echo tails). A bulk cancel keeps the NOTE_OFF of every note that has
+ * already started, so nothing is left hanging. TIE events from a mode
+ * extend a pending NOTE_OFF instead of starting a new note.
+ *
+ * Tick-timed events (EventSink::noteOnTicks() etc.) wait in a second
+ * TimingWheel ordered by musical position (TempoMap) and are converted to
+ * time only when they come due, so setTempo() re-times every one of them
+ * at once with no rescheduling work. Only events already within the
+ * dispatch lookahead keep the old tempo.
+ *
+ * RECUR events (EventSink::recur()) become generators: one slot and
+ * one of GRUVBOK::MIDI::MAX_GENERATORS records holding the Recurrence and
+ * its progress. When the slot comes due it produces that note's NOTE_ON,
+ * schedules its NOTE_OFF and goes back into the wheel for the next note,
+ * so a long echo tail holds one slot plus the off of the note sounding.
+ * Generators are cancelled, evicted and tempo-aware like any other event;
+ * a note is only started if its off could be scheduled.
+ *
+ * A generator lives as long as its tail, so tails from earlier steps are
+ * still holding records when new ones start. Each (mode, track) keeps at
+ * most MAX_TAILS_PER_TRACK; a new tail past that, or one that finds every
+ * record busy, evicts the tail furthest along (fewest notes left, then
+ * the quietest). The note it is sounding still gets its off.
+ *
+ * Time comes from a TimeSource (the system clock unless setTimeSource() is
+ * given another). Times are kept as its low 32 bits and only ever compared
+ * by signed difference, so the scheduler runs through the wrap of the
+ * 32-bit microsecond counter every 71.6 minutes without losing an event or
+ * firing one early.
+ *
+ * The pool is Capacity slots (default GRUVBOK::MIDI::MAX_SCHEDULED_EVENTS),
+ * indexed by the smallest type that holds them (SlotIndex: one byte up to
+ * 254 slots). MIDIScheduler<> is the firmware's scheduler and is compiled
+ * once, in MIDIScheduler.cpp.
  */
+template<uint16_t Capacity = GRUVBOK::MIDI::MAX_SCHEDULED_EVENTS,
+         typename Policy = EvictLowerPriority>
 class MIDIScheduler {
+  friend class SchedulerSink;
+
+public:
+  typedef typename SlotIndex<Capacity>::type Index;
+  typedef BasicEventHandle<Index> Handle;
+
 private:
+  typedef TimingWheel<Capacity> Wheel;
+
+  // One 32-bit word per slot; the time is kept by the wheel holding the
+  // slot (microseconds, or musical position for tickWheel) and occupancy
+  // by liveSlots
   struct ScheduledEvent {
-    enum Type { NOTE_ON, NOTE_OFF, CC, STOP_ALL };
+    uint32_t type : 4;          // NOTE_ON, NOTE_OFF, CC, STOP_ALL, or RECUR (a generator)
+    uint32_t channelIndex : 4;  // MIDI channel - 1 (validated before scheduling)
+    uint32_t data1 : 7;         // pitch/controller; generator index for RECUR
+    uint32_t data2 : 7;         // velocity/value
+    uint32_t priority : 2;      // MIDIEvent::Priority (overflow eviction order)
+    uint32_t origin : 8;        // MIDIEvent::makeOrigin(), or NO_ORIGIN
+
+    uint8_t channel() const { return (uint8_t)(channelIndex + 1); }
+  };
+  static_assert(sizeof(ScheduledEvent) == 4, "ScheduledEvent is one 32-bit word");
+  static_assert(MIDIEvent::NUM_PRIORITIES <= 4, "priority has two bits");
+
+  ScheduledEvent events[Capacity];
+  Wheel wheel;                              // Orders slots by execute time
+  Wheel tickWheel;                          // Tick-timed slots, by musical position
+  TempoMap tempo;                           // Position <-> time for tickWheel
 
-    Type type;
-    uint8_t channel;
-    uint8_t data1;  // pitch/controller
-    uint8_t data2;  // velocity/value
-    unsigned long executeTime;
-    bool active;
+  Index freeSlots[Capacity];                // Stack of unused slot indices
+  Index freeCount;
+  uint8_t generations[Capacity];            // Bumped whenever a slot is freed
+  SlotMask<Capacity> liveSlots;             // One bit per slot holding an event
+  SlotMask<Capacity> tickSlots;             // One bit per slot in tickWheel
 
-    ScheduledEvent() : active(false) {}
+  // A Recurrence being played out, one note at a time
+  struct Generator {
+    Recurrence rule;
+    uint32_t at;        // Time (or musical position) of the next note
+    uint32_t interval;  // From the next note to the one after it
+    uint32_t length;    // Note length (position units if inTicks)
+    Index slot;         // Its RECUR slot (in a wheel while the generator is busy)
+    uint8_t index;      // Next note
+    uint8_t velocity;   // Of the next note
+    bool inTicks;
   };
 
-  static constexpr uint8_t MAX_SCHEDULED_EVENTS = 64;
-  ScheduledEvent events[MAX_SCHEDULED_EVENTS];
+  // Backpressure threshold, scaled from the one tuned for the default pool
+  static constexpr Index BACKPRESSURE_SLOTS = (Index)(
+      ((uint32_t)GRUVBOK::MIDI::BACKPRESSURE_FREE_SLOTS * Capacity +
+       GRUVBOK::MIDI::MAX_SCHEDULED_EVENTS - 1) / GRUVBOK::MIDI::MAX_SCHEDULED_EVENTS);
+
+  static constexpr uint8_t MAX_GENERATORS = GRUVBOK::MIDI::MAX_GENERATORS;
+  static constexpr uint32_t ALL_GENERATORS =
+      MAX_GENERATORS >= 32 ? 0xFFFFFFFFUL : (1UL << MAX_GENERATORS) - 1;
+  static_assert(MAX_GENERATORS <= 32, "generatorsInUse has one bit per generator");
+  Generator generators[MAX_GENERATORS];
+  uint32_t generatorsInUse;                 // One bit per busy generator
+
+  MIDIDispatcher* dispatcher;               // Interrupt-driven output (optional)
+  MIDIPort* port;                           // Polled output without a dispatcher
+  TimeSource* timeSource;                   // Where "now" comes from
+  uint32_t lastPostedTime;                  // Latest time handed to the dispatcher
+
+  VoiceTracker voices;                      // Notes sounding at the output
+  bool panicPending;                        // panic() offs still to be sent
+
+  uint32_t drops[MIDIEvent::NUM_PRIORITIES];  // Events lost to overflow, per class
+  uint32_t evictedCount;                    // Of which were evicted for a newer event
+  bool lastScheduleDropped;                 // Last step or scheduleAll() lost an event
+
+  // Step lateness (processing time - ideal step time, microseconds)
+  uint32_t lastStepLateness;
+  uint32_t maxStepLateness;
 
 public:
-  MIDIScheduler() {
-    for (uint8_t i = 0; i < MAX_SCHEDULED_EVENTS; i++) {
-      events[i].active = false;
+  explicit MIDIScheduler(MIDIDispatcher* out = nullptr)
+    : generations(), generatorsInUse(0), dispatcher(out), port(nullptr),
+      timeSource(&SystemTimeSource::instance()), lastPostedTime(0),
+      panicPending(false), evictedCount(0), lastScheduleDropped(false),
+      lastStepLateness(0), maxStepLateness(0) {
+    for (uint8_t i = 0; i < MIDIEvent::NUM_PRIORITIES; i++) {
+      drops[i] = 0;
     }
+    clear();
+  }
+
+  /**
+   * Polled output: update() sends due events straight to a port
+   * (the port is flushed from the main loop)
+   */
+  explicit MIDIScheduler(MIDIPort* out)
+    : MIDIScheduler((MIDIDispatcher*)nullptr) {
+    port = out;
   }
 
+  /**
+   * Read time from another source (e.g. a ManualTimeSource in tests)
+   */
+  void setTimeSource(TimeSource* source) { timeSource = source; }
+
+  TimeSource* getTimeSource() const { return timeSource; }
+
   /**
    * Schedule a note on event
    * @param channel MIDI channel (1-16)
    * @param pitch MIDI note (0-127)
    * @param velocity Note velocity (0-127)
-   * @param delta Delay in milliseconds from current time
+   * @param delta Delay in microseconds from current time
+   * @return Handle to the event (isNone() if it was dropped)
    */
-  void note(uint8_t channel, uint8_t pitch, uint8_t velocity, unsigned long delta = 0);
+  Handle note(uint8_t channel, uint8_t pitch, uint8_t velocity, unsigned long delta = 0);
 
   /**
    * Schedule a note off event
    * @param channel MIDI channel (1-16)
    * @param pitch MIDI note (0-127)
-   * @param delta Delay in milliseconds from current time
+   * @param delta Delay in microseconds from current time
+   * @return Handle to the event (isNone() if it was dropped)
    */
-  void off(uint8_t channel, uint8_t pitch, unsigned long delta = 0);
+  Handle off(uint8_t channel, uint8_t pitch, unsigned long delta = 0);
 
   /**
    * Schedule a CC (control change) event
    * @param channel MIDI channel (1-16)
    * @param controller CC number (0-127)
    * @param value CC value (0-127)
-   * @param delta Delay in milliseconds from current time
+   * @param delta Delay in microseconds from current time
+   * @param priority PRIORITY_CC, or PRIORITY_DEBUG for UI/debug CCs
+   * @return Handle to the event (isNone() if it was dropped)
    */
-  void cc(uint8_t channel, uint8_t controller, uint8_t value, unsigned long delta = 0);
+  Handle cc(uint8_t channel, uint8_t controller, uint8_t value, unsigned long delta = 0,
+            MIDIEvent::Priority priority = MIDIEvent::PRIORITY_CC);
 
   /**
    * Schedule all notes off
    * @param channel MIDI channel (1-16)
-   * @param delta Delay in milliseconds from current time
+   * @param delta Delay in microseconds from current time
+   * @return Handle to the event (isNone() if it was dropped)
    */
-  void stopall(uint8_t channel, unsigned long delta = 0);
+  Handle stopall(uint8_t channel, unsigned long delta = 0);
 
   /**
    * Schedule all events from a buffer (PREFERRED METHOD)
@@ -84,25 +290,930 @@ public:
    * @param buffer MIDIEventBuffer containing events to schedule
    * @return Number of events successfully scheduled
    */
-  uint8_t scheduleAll(const MIDIEventBuffer& buffer);
+  template<uint16_t N>
+  uint16_t scheduleAll(const MIDIEventBuffer<N>& buffer) {
+    return scheduleAll(buffer, now32());
+  }
+
+  /**
+   * Schedule all events from a buffer relative to an explicit time
+   * @param buffer MIDIEventBuffer containing events to schedule
+   * @param now Base time in microseconds that event deltas are added to
+   * @return Number of events successfully scheduled; check hasBackpressure()
+   *         when it is short of buffer.size()
+   */
+  template<uint16_t N>
+  uint16_t scheduleAll(const MIDIEventBuffer<N>& buffer, unsigned long now);
+
+  /**
+   * Change the tempo tick-timed events follow, from now on
+   * Pending tick-timed events move to the new tempo; events timed in
+   * microseconds keep their time.
+   * @param q8Micros Microseconds per quarter note, Q24.8 fixed point
+   * @param now Time of the change (microseconds)
+   */
+  void setTempo(uint32_t q8Micros, unsigned long now) { tempo.setBeatInterval(q8Micros, now); }
+
+  uint32_t getBeatInterval() const { return tempo.getBeatInterval(); }
+
+  /**
+   * True while the handle's event is waiting in the scheduler
+   */
+  bool isPending(Handle handle) const {
+    return handle.slot < Capacity &&
+           generations[handle.slot] == handle.generation &&
+           liveSlots.test(handle.slot);
+  }
+
+  /**
+   * Execute time of a pending event (at the current tempo, if tick-timed)
+   * @return false if the handle is stale
+   */
+  bool getTime(Handle handle, unsigned long& time) const;
+
+  /**
+   * Drop a pending event, freeing its slot (O(1))
+   * Cancelling the NOTE_OFF of a note that has started leaves it sounding
+   * until panic() or a later off.
+   * @return false if the handle is stale (already sent, cancelled, evicted)
+   */
+  bool cancel(Handle handle);
+
+  /**
+   * Move a pending event to a new execute time (O(1))
+   * A tick-timed event becomes timed in microseconds.
+   * @param time Absolute time in microseconds; a time already passed
+   *             makes the event due at once
+   * @return false if the handle is stale
+   */
+  bool retime(Handle handle, unsigned long time);
+
+  /**
+   * Cancel every pending event on a channel
+   * NOTE_ONs and CCs are dropped together with the NOTE_OFFs that would end
+   * them; NOTE_OFFs of notes already sounding and STOP_ALLs stay.
+   * @return Number of events cancelled
+   */
+  Index cancelChannel(uint8_t channel);
+
+  /**
+   * Cancel every pending event scheduleAll() took from (mode, track), or
+   * from all of a mode's tracks with MIDIEvent::ALL_TRACKS (same rules as
+   * cancelChannel())
+   * @return Number of events cancelled
+   */
+  Index cancelOrigin(uint8_t mode, uint8_t track = MIDIEvent::ALL_TRACKS);
+
+  /**
+   * True if the pool is nearly full (fewer free slots than
+   * BACKPRESSURE_FREE_SLOTS per MAX_SCHEDULED_EVENTS of Capacity) or the
+   * last step (or scheduleAll()) lost events
+   * Callers should shed optional traffic (debug CCs) until it clears.
+   */
+  bool hasBackpressure() const {
+    return lastScheduleDropped || freeCount < BACKPRESSURE_SLOTS;
+  }
+
+  /**
+   * Unused slots in the pool
+   */
+  Index getFreeSlots() const { return freeCount; }
+
+  /**
+   * Record the start of a step's processing
+   * Call once per step, before scheduling its events at stepTime
+   * (clears the "last step lost events" backpressure flag).
+   * @param stepTime Ideal (logical) start of the step in microseconds
+   */
+  void beginStep(unsigned long stepTime);
+
+  /**
+   * How late the most recent step was processed (microseconds)
+   */
+  uint32_t getLastStepLateness() const { return lastStepLateness; }
+
+  /**
+   * Worst step lateness since the last resetLatencyStats() (microseconds)
+   */
+  uint32_t getMaxStepLateness() const { return maxStepLateness; }
+
+  void resetLatencyStats() {
+    lastStepLateness = 0;
+    maxStepLateness = 0;
+  }
 
   /**
    * Process scheduled events - call this frequently in main loop
+   * Hands soon-due events to the dispatcher, or sends due events directly
    */
   void update();
 
+  /**
+   * Remove the earliest event if it is due
+   * update() is built on this; exposed so tests can drain without USB MIDI.
+   * @param now Current time in microseconds
+   * @param out Receives the event (delta is set to its execute time)
+   * @return true if an event was due and removed
+   */
+  bool popDue(unsigned long now, MIDIEvent& out);
+
   /**
    * Clear all scheduled events
+   * Notes already sounding keep sounding; follow with panic() to release them.
    */
   void clear();
 
+  /**
+   * Release every note that is actually sounding with an exact NOTE_OFF
+   * Offs that do not fit the dispatcher ring go out on the next update().
+   * @return Number of NOTE_OFFs sent or posted now
+   */
+  uint16_t panic();
+
+  /**
+   * Limit voices per channel; the oldest voice is stolen beyond it
+   */
+  void setPolyphony(uint8_t perChannel) { voices.setPolyphony(perChannel); }
+
+  /**
+   * Sounding notes and voice statistics
+   */
+  const VoiceTracker& getVoices() const { return voices; }
+
+  /**
+   * Events of one priority class lost to overflow (rejected or evicted)
+   */
+  uint32_t getDropCount(MIDIEvent::Priority priority) const { return drops[priority]; }
+
+  /**
+   * Events lost to overflow, all classes
+   */
+  uint32_t getDroppedCount() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < MIDIEvent::NUM_PRIORITIES; i++) {
+      total += drops[i];
+    }
+    return total;
+  }
+
+  /**
+   * Pending events evicted to make room for a more important one
+   */
+  uint32_t getEvictedCount() const { return evictedCount; }
+
+  void resetDropStats() {
+    for (uint8_t i = 0; i < MIDIEvent::NUM_PRIORITIES; i++) {
+      drops[i] = 0;
+    }
+    evictedCount = 0;
+  }
+
+  /**
+   * Recurrences being played out
+   */
+  uint8_t getActiveGenerators() const { return (uint8_t)__builtin_popcount(generatorsInUse); }
+
+  static constexpr uint8_t getMaxGenerators() { return MAX_GENERATORS; }
+
+  /**
+   * Number of events waiting to execute (a generator counts once)
+   */
+  Index pending() const { return wheel.size() + tickWheel.size(); }
+
+  static constexpr Index getCapacity() { return Capacity; }
+
 private:
-  // Find free slot in event buffer
-  int8_t findFreeSlot();
+  // Current time, low 32 bits (compare by signed difference only)
+  uint32_t now32() { return (uint32_t)timeSource->now(); }
+
+  // Build the outgoing message for a popped event
+  static MIDIMessage toMessage(const MIDIEvent& event, uint8_t priority);
+
+  // Remove the earliest due event; returns its slot (still holding the
+  // payload until the next schedule) or Wheel::NONE
+  Index popDueSlot(unsigned long now, MIDIEvent& out);
+
+  // True if output() can take another message now
+  bool hasOutputSpace() const;
+
+  // Pass a popped event through the voice tracker and send it
+  void emit(const MIDIEvent& event, uint8_t priority);
+
+  // Hand one message to the dispatcher, or send it right away
+  void output(const MIDIMessage& msg);
+
+  // Send panic offs while there is room; false once some are left over
+  bool flushPanic();
 
-  // Schedule generic event
-  void scheduleEvent(ScheduledEvent::Type type, uint8_t channel,
-                    uint8_t data1, uint8_t data2, unsigned long delta);
+  // Free the slot of the lowest-priority, furthest-future event if its
+  // class is below 'priority'
+  bool makeRoom(uint8_t priority);
+
+  // Return a slot to the free list and invalidate its handles
+  void freeSlot(Index slot);
+
+  // Put a slot in the wheel for its time base: 'due' is a time, or a
+  // musical position if inTicks. An idle wheel is re-anchored to 'now'
+  void link(Index slot, uint32_t due, bool inTicks, unsigned long now);
+
+  // Take a slot out of whichever wheel holds it
+  void unlink(Index slot);
+
+  // Execute time of a slot in either wheel
+  uint32_t timeOf(Index slot) const;
+
+  // Due time (or musical position, if inTicks) of now + delta
+  uint32_t dueAt(unsigned long now, unsigned long delta, bool inTicks) const {
+    return inTicks ? tempo.positionAt(now) + TempoMap::ticks(delta) : (uint32_t)(now + delta);
+  }
+
+  // Move tick-timed events due by 'now' into the time wheel
+  void promoteDue(unsigned long now);
+
+  // Start a generator for a Recurrence, evicting a tail if its track has
+  // MAX_TAILS_PER_TRACK or every generator is busy; false if the pool has
+  // no slot for it
+  bool startGenerator(const Recurrence& rule, unsigned long now, unsigned long start,
+                      bool inTicks, uint8_t origin);
+
+  // Of the generators in 'candidates' (one bit each), the one furthest
+  // along its tail: fewest notes left, then the quietest
+  uint8_t furthestAlong(uint32_t candidates) const;
+
+  // End a busy generator's tail early (counted as an evicted NOTE_ON)
+  void evictGenerator(uint8_t index);
+
+  // Produce a due generator's next note into 'out' and queue its off;
+  // false if the note had to be skipped
+  bool expandGenerator(Index slot, uint32_t time, MIDIEvent& out);
+
+  // Cancel pending events selected by 'matches', keeping the NOTE_OFFs of
+  // notes that are already sounding
+  template<typename Match>
+  Index cancelWhere(Match matches);
+
+  // Move the latest pending NOTE_OFF of (channel, pitch, origin) to
+  // now + delta; false if there is none
+  bool extendNote(uint8_t channel, uint8_t pitch, uint8_t origin,
+                  unsigned long now, unsigned long delta, bool inTicks);
+
+  // Schedule one event from a mode at now + delta (TIE is resolved here;
+  // RECUR needs its rule, see startGenerator()). Sets lastScheduleDropped
+  // if it is lost
+  bool accept(const MIDIEvent& event, unsigned long now);
+
+  // SchedulerSink entry points (self is the scheduler)
+  static bool sinkWrite(void* self, const MIDIEvent& event, unsigned long now) {
+    return static_cast<MIDIScheduler*>(self)->accept(event, now);
+  }
+  static bool sinkRecurrence(void* self, const Recurrence& rule, const MIDIEvent& start,
+                             unsigned long now);
+
+  // Schedule generic event at now + delta (delta in master ticks if inTicks)
+  Handle scheduleEvent(MIDIEvent::Type type, uint8_t priority, uint8_t channel,
+                       uint8_t data1, uint8_t data2, unsigned long now, unsigned long delta,
+                       uint8_t origin = MIDIEvent::NO_ORIGIN, bool inTicks = false) {
+    return scheduleAt(type, priority, channel, data1, data2, dueAt(now, delta, inTicks),
+                      inTicks, origin, now);
+  }
+
+  // Schedule generic event at a time (or musical position, if inTicks)
+  Handle scheduleAt(MIDIEvent::Type type, uint8_t priority, uint8_t channel,
+                    uint8_t data1, uint8_t data2, uint32_t due, bool inTicks,
+                    uint8_t origin, unsigned long now);
 };
 
+template<uint16_t Capacity, typename Policy>
+typename MIDIScheduler<Capacity, Policy>::Handle
+MIDIScheduler<Capacity, Policy>::note(uint8_t channel, uint8_t pitch, uint8_t velocity,
+                                      unsigned long delta) {
+  // Validate MIDI channel (1-16)
+  if (channel == 0 || channel > 16) return Handle();
+  // pitch and velocity are clamped to 0-127 when stored (scheduleAt)
+  return scheduleEvent(MIDIEvent::NOTE_ON, MIDIEvent::PRIORITY_NOTE_ON, channel, pitch, velocity,
+                       now32(), delta);
+}
+
+template<uint16_t Capacity, typename Policy>
+typename MIDIScheduler<Capacity, Policy>::Handle
+MIDIScheduler<Capacity, Policy>::off(uint8_t channel, uint8_t pitch, unsigned long delta) {
+  // Validate MIDI channel (1-16)
+  if (channel == 0 || channel > 16) return Handle();
+  return scheduleEvent(MIDIEvent::NOTE_OFF, MIDIEvent::PRIORITY_NOTE_OFF, channel, pitch, 0,
+                       now32(), delta);
+}
+
+template<uint16_t Capacity, typename Policy>
+typename MIDIScheduler<Capacity, Policy>::Handle
+MIDIScheduler<Capacity, Policy>::cc(uint8_t channel, uint8_t controller, uint8_t value,
+                                    unsigned long delta, MIDIEvent::Priority priority) {
+  // Validate MIDI channel (1-16)
+  if (channel == 0 || channel > 16) return Handle();
+  return scheduleEvent(MIDIEvent::CC, priority, channel, controller, value, now32(), delta);
+}
+
+template<uint16_t Capacity, typename Policy>
+typename MIDIScheduler<Capacity, Policy>::Handle
+MIDIScheduler<Capacity, Policy>::stopall(uint8_t channel, unsigned long delta) {
+  // Validate MIDI channel (1-16)
+  if (channel == 0 || channel > 16) return Handle();
+  return scheduleEvent(MIDIEvent::STOP_ALL, MIDIEvent::PRIORITY_NOTE_OFF, channel, 0, 0,
+                       now32(), delta);
+}
+
+template<uint16_t Capacity, typename Policy>
+template<uint16_t N>
+uint16_t MIDIScheduler<Capacity, Policy>::scheduleAll(const MIDIEventBuffer<N>& buffer,
+                                                      unsigned long now) {
+  uint16_t scheduled = 0;
+  lastScheduleDropped = false;
+
+  // A full pool rejects one event, but later NOTE_OFFs in the buffer must
+  // still get their chance
+  for (typename MIDIEventBuffer<N>::Index i = 0; i < buffer.size(); i++) {
+    const MIDIEvent& event = buffer[i];
+    bool taken;
+    if (event.type == MIDIEvent::RECUR) {
+      taken = startGenerator(buffer.getRecurrence(event.data1), now, event.delta,
+                             event.inTicks, event.origin);
+      if (!taken) lastScheduleDropped = true;
+    } else {
+      taken = accept(event, now);
+    }
+    if (taken) scheduled++;
+  }
+
+  return scheduled;
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::accept(const MIDIEvent& event, unsigned long now) {
+  // Validate channel
+  if (event.channel == 0 || event.channel > 16) {
+    return false;
+  }
+
+  uint8_t origin = event.origin;
+  bool inTicks = event.inTicks;
+  MIDIEvent::Type type = event.getType();
+  switch (type) {
+    case MIDIEvent::NOTE_ON:
+    case MIDIEvent::NOTE_OFF:
+    case MIDIEvent::CC:
+    case MIDIEvent::STOP_ALL:
+      break;
+    case MIDIEvent::TIE:
+      // Legato: the note keeps sounding, only its end moves
+      if (extendNote(event.channel, event.data1, origin, now, event.delta, inTicks)) {
+        return true;
+      }
+      // Nothing to extend: start the note now, ending at delta
+      if (scheduleEvent(MIDIEvent::NOTE_ON, MIDIEvent::PRIORITY_NOTE_ON, event.channel,
+                        event.data1, event.data2, now, 0, origin).isNone()) {
+        lastScheduleDropped = true;
+        return false;
+      }
+      type = MIDIEvent::NOTE_OFF;
+      break;
+    default:
+      return false;  // RECUR carries its rule separately (startGenerator())
+  }
+
+  uint8_t priority = MIDIEvent::priorityOf(type);
+  uint8_t data2 = type == MIDIEvent::NOTE_OFF ? 0 : event.data2;
+  if (scheduleEvent(type, priority, event.channel, event.data1, data2,
+                    now, event.delta, origin, inTicks).isNone()) {
+    lastScheduleDropped = true;
+    return false;
+  }
+  return true;
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::sinkRecurrence(void* self, const Recurrence& rule,
+                                                     const MIDIEvent& start, unsigned long now) {
+  if (rule.channel == 0 || rule.channel > 16) return false;
+  MIDIScheduler* scheduler = static_cast<MIDIScheduler*>(self);
+  if (scheduler->startGenerator(rule, now, start.delta, start.inTicks, start.origin)) return true;
+  scheduler->lastScheduleDropped = true;
+  return false;
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::beginStep(unsigned long stepTime) {
+  lastScheduleDropped = false;
+  tempo.follow((uint32_t)stepTime);
+  int32_t late = (int32_t)(now32() - (uint32_t)stepTime);
+  lastStepLateness = late > 0 ? (uint32_t)late : 0;
+  if (lastStepLateness > maxStepLateness) {
+    maxStepLateness = lastStepLateness;
+  }
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::update() {
+  uint32_t currentTime = now32();
+  MIDIEvent event;
+
+  // Finish a panic before anything new goes out
+  if (panicPending && !flushPanic()) {
+    return;
+  }
+
+  if (dispatcher != nullptr) {
+    // Hand over everything due within the lookahead; the dispatch interrupt
+    // sends each message at its exact time. A full ring just leaves events
+    // in the wheel until the next pass. Keep room for a stolen voice's off.
+    uint32_t horizon = currentTime + GRUVBOK::MIDI::DISPATCH_LOOKAHEAD_US;
+    Index slot;
+    while (dispatcher->getSpace() >= 2 &&
+           (slot = popDueSlot(horizon, event)) != Wheel::NONE) {
+      emit(event, events[slot].priority);
+    }
+    return;
+  }
+
+  // Only due events are visited; the wheel hands them out in time order.
+  // Everything due in this pass goes out in one port flush. A port that
+  // is backed up leaves events in the wheel until the next pass
+  bool sent = false;
+  Index slot;
+  while ((port == nullptr || port->getSpace() >= 2) &&
+         (slot = popDueSlot(currentTime, event)) != Wheel::NONE) {
+    emit(event, events[slot].priority);
+    sent = true;
+  }
+  if (sent && port != nullptr) {
+    port->flush();
+  }
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::emit(const MIDIEvent& event, uint8_t priority) {
+  switch (event.type) {
+    case MIDIEvent::NOTE_ON: {
+      uint8_t stolen = voices.noteOn(event.channel, event.data1);
+      if (stolen != VoiceTracker::NONE) {
+        output(MIDIMessage::channelMessage(event.delta, 0x80, event.channel, stolen, 0));
+      }
+      break;
+    }
+
+    case MIDIEvent::NOTE_OFF:
+      // Not sounding, or still held by an overlapping hit of the same pitch
+      if (!voices.noteOff(event.channel, event.data1)) return;
+      break;
+
+    case MIDIEvent::STOP_ALL:
+      voices.resetChannel(event.channel);
+      break;
+
+    default:
+      break;
+  }
+  output(toMessage(event, priority));
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::output(const MIDIMessage& msg) {
+  if (dispatcher != nullptr) {
+    dispatcher->post(msg);
+    if ((int32_t)(msg.time - lastPostedTime) > 0) {
+      lastPostedTime = msg.time;
+    }
+    return;
+  }
+
+  if (port != nullptr && port->routes(msg)) {
+    port->enqueue(msg);
+  }
+}
+
+template<uint16_t Capacity, typename Policy>
+uint16_t MIDIScheduler<Capacity, Policy>::panic() {
+  panicPending = true;
+  uint16_t before = voices.getTotalVoices();
+  flushPanic();
+  return before - voices.getTotalVoices();
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::flushPanic() {
+  // Notes posted ahead of time may not have started yet; release them no
+  // earlier than the latest message already handed to the dispatcher
+  uint32_t time = now32();
+  if (dispatcher != nullptr && (int32_t)(lastPostedTime - time) > 0) {
+    time = lastPostedTime;
+  }
+
+  uint8_t channel;
+  uint8_t pitch;
+  bool done = false;
+  while (hasOutputSpace()) {
+    if (!voices.releaseNext(channel, pitch)) {
+      done = true;
+      break;
+    }
+    output(MIDIMessage::channelMessage(time, 0x80, channel, pitch, 0));
+  }
+  if (port != nullptr) {
+    port->flush();
+  }
+  if (done) {
+    panicPending = false;
+  }
+  return done;
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::hasOutputSpace() const {
+  if (dispatcher != nullptr) return dispatcher->hasSpace();
+  if (port != nullptr) return port->hasSpace();
+  return true;
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::popDue(unsigned long now, MIDIEvent& out) {
+  return popDueSlot(now, out) != Wheel::NONE;
+}
+
+template<uint16_t Capacity, typename Policy>
+typename MIDIScheduler<Capacity, Policy>::Index
+MIDIScheduler<Capacity, Policy>::popDueSlot(unsigned long now, MIDIEvent& out) {
+  promoteDue(now);
+  wheel.advance(now);
+  Index slot;
+  for (;;) {
+    slot = wheel.popReady();
+    if (slot == Wheel::NONE) return Wheel::NONE;
+    if (events[slot].type != MIDIEvent::RECUR) break;
+    if (expandGenerator(slot, wheel.getTime(slot), out)) return slot;
+  }
+
+  const ScheduledEvent& scheduled = events[slot];
+  out = MIDIEvent((MIDIEvent::Type)scheduled.type, scheduled.channel(), scheduled.data1,
+                  scheduled.data2, wheel.getTime(slot));
+  out.origin = scheduled.origin;
+
+  // Mark slot as free
+  freeSlot(slot);
+  return slot;
+}
+
+template<uint16_t Capacity, typename Policy>
+MIDIMessage MIDIScheduler<Capacity, Policy>::toMessage(const MIDIEvent& event, uint8_t priority) {
+  uint32_t time = event.delta;  // popDue() stores the execute time here
+
+  switch (event.type) {
+    case MIDIEvent::NOTE_ON:
+      return MIDIMessage::channelMessage(time, 0x90, event.channel, event.data1, event.data2);
+    case MIDIEvent::NOTE_OFF:
+      return MIDIMessage::channelMessage(time, 0x80, event.channel, event.data1, 0);
+    case MIDIEvent::CC:
+      return MIDIMessage::channelMessage(time, 0xB0, event.channel, event.data1, event.data2)
+          .withPriority(priority);
+    case MIDIEvent::STOP_ALL:
+    default:
+      // All notes off CC (123), as important as a note off
+      return MIDIMessage::channelMessage(time, 0xB0, event.channel, 123, 0)
+          .withPriority(MIDIEvent::PRIORITY_NOTE_OFF);
+  }
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::clear() {
+  wheel.reset(0);
+  tickWheel.reset(0);
+  freeCount = Capacity;
+  for (Index i = 0; i < Capacity; i++) {
+    // Hand out low slots first
+    freeSlots[i] = Capacity - 1 - i;
+    if (liveSlots.test(i)) generations[i]++;  // Outstanding handles go stale
+  }
+  liveSlots.clear();
+  tickSlots.clear();
+  generatorsInUse = 0;
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::freeSlot(Index slot) {
+  if (events[slot].type == MIDIEvent::RECUR) {
+    generatorsInUse &= ~(1UL << events[slot].data1);
+  }
+  generations[slot]++;
+  liveSlots.reset(slot);
+  tickSlots.reset(slot);
+  freeSlots[freeCount++] = slot;
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::link(Index slot, uint32_t due, bool inTicks,
+                                           unsigned long now) {
+  // An idle wheel may have a stale cursor; re-anchor it to the caller's time
+  if (inTicks) {
+    if (tickWheel.size() == 0) {
+      tickWheel.reset(tempo.positionAt(now));
+    }
+    tickWheel.insert(slot, due);
+    tickSlots.set(slot);
+    return;
+  }
+  if (wheel.size() == 0) {
+    wheel.reset(now);
+  }
+  wheel.insert(slot, due);
+  tickSlots.reset(slot);
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::unlink(Index slot) {
+  if (tickSlots.test(slot)) {
+    tickWheel.remove(slot);
+  } else {
+    wheel.remove(slot);
+  }
+}
+
+template<uint16_t Capacity, typename Policy>
+uint32_t MIDIScheduler<Capacity, Policy>::timeOf(Index slot) const {
+  if (tickSlots.test(slot)) {
+    return tempo.timeAt(tickWheel.getTime(slot));
+  }
+  return wheel.getTime(slot);
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::promoteDue(unsigned long now) {
+  tempo.follow((uint32_t)now);
+  if (tickWheel.size() == 0) return;
+
+  // Converted at the tempo in force now, in musical order
+  tickWheel.advance(tempo.positionAt(now));
+  Index slot;
+  while ((slot = tickWheel.popReady()) != Wheel::NONE) {
+    uint32_t time = tempo.timeAt(tickWheel.getTime(slot));
+    link(slot, time, false, time);
+  }
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::getTime(Handle handle, unsigned long& time) const {
+  if (!isPending(handle)) return false;
+  time = timeOf(handle.slot);
+  return true;
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::cancel(Handle handle) {
+  if (!isPending(handle)) return false;
+  unlink(handle.slot);
+  freeSlot(handle.slot);
+  return true;
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::retime(Handle handle, unsigned long time) {
+  if (!isPending(handle)) return false;
+  unlink(handle.slot);
+  if (events[handle.slot].type == MIDIEvent::RECUR) {
+    // The run carries on from here in its own time base
+    Generator& generator = generators[events[handle.slot].data1];
+    generator.at = generator.inTicks ? tempo.positionAt(time) : (uint32_t)time;
+    link(handle.slot, generator.at, generator.inTicks, now32());
+    return true;
+  }
+  link(handle.slot, time, false, now32());
+  return true;
+}
+
+template<uint16_t Capacity, typename Policy>
+template<typename Match>
+typename MIDIScheduler<Capacity, Policy>::Index
+MIDIScheduler<Capacity, Policy>::cancelWhere(Match matches) {
+  Index cancelled = 0;
+  liveSlots.forEach([&](Index slot) {
+    // Already taken as the off of an earlier cancelled note
+    if (!liveSlots.test(slot)) return;
+
+    const ScheduledEvent& event = events[slot];
+    if (!matches(event) || event.type == MIDIEvent::STOP_ALL ||
+        event.type == MIDIEvent::NOTE_OFF) {
+      return;
+    }
+    unlink(slot);
+    freeSlot(slot);
+    cancelled++;
+    if (event.type != MIDIEvent::NOTE_ON) return;
+
+    // The note will never start: drop the off that would end it (the
+    // latest one for its pitch, as offs follow their ons)
+    Index off = Wheel::NONE;
+    liveSlots.forEach([&](Index s) {
+      const ScheduledEvent& candidate = events[s];
+      if (candidate.type == MIDIEvent::NOTE_OFF && candidate.channelIndex == event.channelIndex &&
+          candidate.data1 == event.data1 && matches(candidate) &&
+          (off == Wheel::NONE || (int32_t)(timeOf(s) - timeOf(off)) > 0)) {
+        off = s;
+      }
+    });
+    if (off != Wheel::NONE) {
+      unlink(off);
+      freeSlot(off);
+      cancelled++;
+    }
+  });
+  return cancelled;
+}
+
+template<uint16_t Capacity, typename Policy>
+typename MIDIScheduler<Capacity, Policy>::Index
+MIDIScheduler<Capacity, Policy>::cancelChannel(uint8_t channel) {
+  return cancelWhere([channel](const ScheduledEvent& event) {
+    return event.channel() == channel;
+  });
+}
+
+template<uint16_t Capacity, typename Policy>
+typename MIDIScheduler<Capacity, Policy>::Index
+MIDIScheduler<Capacity, Policy>::cancelOrigin(uint8_t mode, uint8_t track) {
+  if (track == MIDIEvent::ALL_TRACKS) {
+    return cancelWhere([mode](const ScheduledEvent& event) {
+      return event.origin != MIDIEvent::NO_ORIGIN && (event.origin >> 3) == mode;
+    });
+  }
+  uint8_t origin = MIDIEvent::makeOrigin(mode, track);
+  return cancelWhere([origin](const ScheduledEvent& event) {
+    return event.origin == origin;
+  });
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::extendNote(uint8_t channel, uint8_t pitch, uint8_t origin,
+                                                 unsigned long now, unsigned long delta,
+                                                 bool inTicks) {
+  Index off = Wheel::NONE;
+  liveSlots.forEach([&](Index slot) {
+    const ScheduledEvent& event = events[slot];
+    if (event.type == MIDIEvent::NOTE_OFF && event.channel() == channel &&
+        event.data1 == pitch && event.origin == origin &&
+        (off == Wheel::NONE || (int32_t)(timeOf(slot) - timeOf(off)) > 0)) {
+      off = slot;
+    }
+  });
+  if (off == Wheel::NONE) return false;
+  unlink(off);
+  link(off, dueAt(now, delta, inTicks), inTicks, now);
+  return true;
+}
+
+template<uint16_t Capacity, typename Policy>
+typename MIDIScheduler<Capacity, Policy>::Handle
+MIDIScheduler<Capacity, Policy>::scheduleAt(MIDIEvent::Type type, uint8_t priority, uint8_t channel,
+                                            uint8_t data1, uint8_t data2, uint32_t due,
+                                            bool inTicks, uint8_t origin, unsigned long now) {
+  // Buffer full: evict something less important (if the policy allows),
+  // or drop this event
+  if (freeCount == 0 && !(Policy::EVICTS && makeRoom(priority))) {
+    drops[priority]++;
+    return Handle();
+  }
+
+  Index slot = freeSlots[--freeCount];
+  events[slot].type = type;
+  events[slot].channelIndex = channel - 1;
+  events[slot].data1 = GRUVBOK::clampMIDIValue(data1);  // 7-bit fields must not wrap
+  events[slot].data2 = GRUVBOK::clampMIDIValue(data2);
+  events[slot].priority = priority;
+  events[slot].origin = origin;
+  liveSlots.set(slot);
+  link(slot, due, inTicks, now);
+  return Handle(slot, generations[slot]);
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::makeRoom(uint8_t priority) {
+  // Only called with the pool full, so every slot is in the wheel.
+  // Victim: lowest class, and within it the furthest-future event
+  Index victim = 0;
+  for (Index slot = 1; slot < Capacity; slot++) {
+    uint8_t p = events[slot].priority;
+    uint8_t best = events[victim].priority;
+    if (p < best ||
+        (p == best && (int32_t)(timeOf(slot) - timeOf(victim)) > 0)) {
+      victim = slot;
+    }
+  }
+
+  // Only a lower class gives way; within a class the new event is dropped
+  uint8_t victimPriority = events[victim].priority;
+  if (victimPriority >= priority) {
+    return false;
+  }
+
+  unlink(victim);
+  freeSlot(victim);
+  drops[victimPriority]++;
+  evictedCount++;
+  return true;
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::startGenerator(const Recurrence& rule, unsigned long now,
+                                                     unsigned long start, bool inTicks,
+                                                     uint8_t origin) {
+  if (rule.count == 0) return true;  // Nothing to play
+
+  // Make room: the track's own oldest tail first, else anyone's
+  uint32_t sameTrack = 0;
+  if (origin != MIDIEvent::NO_ORIGIN) {
+    for (uint32_t busy = generatorsInUse; busy != 0; busy &= busy - 1) {
+      uint8_t g = (uint8_t)__builtin_ctz(busy);
+      if (events[generators[g].slot].origin == origin) sameTrack |= 1UL << g;
+    }
+  }
+  if (__builtin_popcount(sameTrack) >= GRUVBOK::MIDI::MAX_TAILS_PER_TRACK) {
+    evictGenerator(furthestAlong(sameTrack));
+  } else if (generatorsInUse == ALL_GENERATORS) {
+    evictGenerator(furthestAlong(generatorsInUse));
+  }
+  uint8_t index = (uint8_t)__builtin_ctz(~generatorsInUse);
+
+  Generator& generator = generators[index];
+  generator.rule = rule;
+  generator.at = dueAt(now, start, inTicks);
+  generator.interval = inTicks ? TempoMap::ticks(rule.interval) : rule.interval;
+  generator.length = inTicks ? TempoMap::ticks(rule.length) : rule.length;
+  generator.index = 0;
+  generator.velocity = rule.velocity;
+  generator.inTicks = inTicks;
+
+  Handle handle = scheduleAt(MIDIEvent::RECUR, MIDIEvent::PRIORITY_NOTE_ON, rule.channel, index, 0,
+                             generator.at, inTicks, origin, now);
+  if (handle.isNone()) {
+    return false;
+  }
+  generator.slot = handle.slot;
+  generatorsInUse |= 1UL << index;
+  return true;
+}
+
+template<uint16_t Capacity, typename Policy>
+uint8_t MIDIScheduler<Capacity, Policy>::furthestAlong(uint32_t candidates) const {
+  uint8_t victim = (uint8_t)__builtin_ctz(candidates);
+  for (candidates &= candidates - 1; candidates != 0; candidates &= candidates - 1) {
+    uint8_t g = (uint8_t)__builtin_ctz(candidates);
+    uint8_t left = generators[g].rule.count - generators[g].index;
+    uint8_t victimLeft = generators[victim].rule.count - generators[victim].index;
+    if (left < victimLeft ||
+        (left == victimLeft && generators[g].velocity < generators[victim].velocity)) {
+      victim = g;
+    }
+  }
+  return victim;
+}
+
+template<uint16_t Capacity, typename Policy>
+void MIDIScheduler<Capacity, Policy>::evictGenerator(uint8_t index) {
+  Index slot = generators[index].slot;
+  unlink(slot);
+  freeSlot(slot);
+  drops[MIDIEvent::PRIORITY_NOTE_ON]++;
+  evictedCount++;
+}
+
+template<uint16_t Capacity, typename Policy>
+bool MIDIScheduler<Capacity, Policy>::expandGenerator(Index slot, uint32_t time,
+                                                      MIDIEvent& out) {
+  Generator& generator = generators[events[slot].data1];
+  uint8_t channel = events[slot].channel();
+  uint8_t origin = events[slot].origin;
+  uint8_t pitch = generator.rule.pitchAt(generator.index);
+  uint8_t velocity = generator.velocity;
+  uint32_t offAt = generator.at + generator.length;
+  bool inTicks = generator.inTicks;
+
+  // Back into the wheel for the next note, or done. Before the off is
+  // scheduled, so every slot is in the wheel if that has to evict
+  if (++generator.index < generator.rule.count) {
+    generator.at += generator.interval;
+    generator.interval *= generator.rule.growth;
+    generator.velocity = generator.rule.nextVelocity(velocity);
+    link(slot, generator.at, inTicks, time);
+  } else {
+    freeSlot(slot);
+  }
+
+  // A note only starts if its off is certain
+  if (scheduleAt(MIDIEvent::NOTE_OFF, MIDIEvent::PRIORITY_NOTE_OFF, channel, pitch, 0,
+                 offAt, inTicks, origin, time).isNone()) {
+    return false;
+  }
+
+  out = MIDIEvent::noteOn(channel, pitch, velocity, time);
+  out.origin = origin;
+  return true;
+}
+
+extern template class MIDIScheduler<>;
+
 #endif // MIDISCHEDULER_H
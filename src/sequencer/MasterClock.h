@@ -0,0 +1,116 @@
+#ifndef MASTERCLOCK_H
+#define MASTERCLOCK_H
+
+#include <stdint.h>
+#include "../core/Constants.h"
+
+/**
+ * MasterClock - Single high-resolution tick counter for all timing
+ *
+ * A phase accumulator runs at MASTER_PPQN ticks per quarter note.
+ * Everything else is derived from the tick count:
+ * - A step every TICKS_PER_STEP ticks (16th notes)
+ * - A MIDI clock pulse every TICKS_PER_CLOCK ticks (24 PPQN)
+ * - Sub-step event placement in whole ticks (see MIDIEventBuffer::ticks)
+ *
+ * Because steps and clock pulses are the same ticks, outgoing MIDI clock
+ * and note timing are phase-locked by construction and cannot drift apart.
+ *
+ * Each tick adds the beat length (Q24.8 us) to an accumulator counted in
+ * 1/(PPQN * 256) us, so the remainder carries over and a full beat is
+ * exactly one beat length at any BPM.
+ *
+ * Tick 0 is the reset time; the first step and clock pulse fall one step
+ * and one pulse later. Changing tempo applies to the pending tick.
+ * All comparisons are wrap-safe for a 32-bit microsecond clock.
+ */
+class MasterClock {
+private:
+  static constexpr uint32_t UNITS_PER_MICRO =
+      (uint32_t)GRUVBOK::Timing::MASTER_PPQN << GRUVBOK::Timing::INTERVAL_FRACTION_BITS;
+
+  uint32_t beatInterval;  // Q24.8 microseconds per quarter note
+  uint32_t tickTime;      // Ideal time of the current tick (whole microseconds)
+  uint32_t phase;         // Remainder of the tick time, in 1/UNITS_PER_MICRO us
+  uint32_t tick;          // Ticks since reset
+
+public:
+  static constexpr uint16_t PPQN = GRUVBOK::Timing::MASTER_PPQN;
+  static constexpr uint8_t TICKS_PER_STEP = GRUVBOK::Timing::TICKS_PER_STEP;
+  static constexpr uint8_t TICKS_PER_CLOCK = GRUVBOK::Timing::TICKS_PER_CLOCK;
+
+  MasterClock() : tickTime(0), phase(0), tick(0) {
+    setTempo(GRUVBOK::Timing::DEFAULT_BPM);
+  }
+
+  /**
+   * Set tempo (applies to the pending tick)
+   */
+  void setTempo(float bpm) {
+    setBeatInterval(GRUVBOK::Timing::calculateBeatInterval(bpm));
+  }
+
+  /**
+   * Set tempo as a beat length
+   * @param q8Micros Microseconds per quarter note, Q24.8 fixed point
+   */
+  void setBeatInterval(uint32_t q8Micros) {
+    beatInterval = q8Micros > 0 ? q8Micros : 1;
+  }
+
+  /**
+   * Restart at tick 0
+   * @param now Time of tick 0 (microseconds)
+   */
+  void reset(uint32_t now) {
+    tickTime = now;
+    phase = 0;
+    tick = 0;
+  }
+
+  /**
+   * Check whether the next tick is due
+   */
+  bool due(uint32_t now) const {
+    int32_t elapsed = (int32_t)(now - tickTime);
+    if (elapsed < 0) return false;
+    return (uint64_t)elapsed * UNITS_PER_MICRO >= (uint64_t)phase + beatInterval;
+  }
+
+  /**
+   * Consume the pending tick
+   */
+  void advance() {
+    uint32_t total = phase + beatInterval;
+    tickTime += total / UNITS_PER_MICRO;
+    phase = total % UNITS_PER_MICRO;
+    tick++;
+  }
+
+  /**
+   * True if the current tick starts a step
+   */
+  bool isStepTick() const { return tick % TICKS_PER_STEP == 0; }
+
+  /**
+   * True if the current tick carries a MIDI clock pulse
+   */
+  bool isClockTick() const { return tick % TICKS_PER_CLOCK == 0; }
+
+  /**
+   * Ticks since reset
+   */
+  uint32_t getTick() const { return tick; }
+
+  /**
+   * Ideal time of the current tick (microseconds)
+   */
+  uint32_t getTickTime() const { return tickTime; }
+
+  /**
+   * Length of one quarter note, Q24.8 fixed point microseconds
+   */
+  uint32_t getBeatInterval() const { return beatInterval; }
+};
+
+#endif  // MASTERCLOCK_H
@@ -0,0 +1,48 @@
+#ifndef SCHEDULERSINK_H
+#define SCHEDULERSINK_H
+
+#include <stdint.h>
+#include "../core/MIDIEvent.h"
+
+/**
+ * SchedulerSink - Event sink that writes straight into MIDIScheduler
+ *
+ * The sequencer opens one per step. Every event a mode writes goes
+ * directly into a scheduler slot at stepTime + delta, tagged with the
+ * current origin; there is no intermediate buffer and no per-step flush,
+ * so a dense step cannot truncate at a buffer boundary. An event the
+ * scheduler cannot take (see MIDIScheduler's overflow rules) counts as
+ * overflow here.
+ *
+ * Works with any MIDIScheduler<Capacity, Policy>: the constructor keeps
+ * the scheduler's two entry points, so modes see one sink type whatever
+ * size of scheduler they feed.
+ */
+class SchedulerSink : public EventSink<SchedulerSink> {
+private:
+  typedef bool (*WriteFn)(void* scheduler, const MIDIEvent& event, unsigned long now);
+  typedef bool (*RecurrenceFn)(void* scheduler, const Recurrence& rule,
+                               const MIDIEvent& start, unsigned long now);
+
+  void* scheduler;
+  WriteFn writeFn;
+  RecurrenceFn recurrenceFn;
+  unsigned long stepTime;  // Base time event deltas are added to
+
+public:
+  template<typename Scheduler>
+  SchedulerSink(Scheduler& target, unsigned long baseTime)
+    : scheduler(&target), writeFn(&Scheduler::sinkWrite),
+      recurrenceFn(&Scheduler::sinkRecurrence), stepTime(baseTime) {}
+
+  // EventSink
+  bool write(const MIDIEvent& event) {
+    return writeFn(scheduler, event, stepTime);
+  }
+
+  bool writeRecurrence(const Recurrence& rule, const MIDIEvent& start) {
+    return recurrenceFn(scheduler, rule, start, stepTime);
+  }
+};
+
+#endif  // SCHEDULERSINK_H
@@ -1,18 +1,29 @@
 #include "Sequencer.h"
-#include "../modes/Mode0_PatternSequencer.h"
-#include "../modes/Mode1_DrumMachine.h"
-#include "../modes/Mode2_AcidBass.h"
-#include "../modes/Mode3_EuclideanFade.h"
-#include "../modes/Mode4_MetaArp.h"
-#include "../modes/Mode5_BasslineProgression.h"
 #include "../core/MIDIEvent.h"
 #include <Arduino.h>
 
-Sequencer::Sequencer(Song* s, Hardware* hw, MIDIScheduler* sched)
-  : song(s), hardware(hw), scheduler(sched),
+// Bounds of the registered modes, checked at build time: a full step
+// (every track of every mode on) fits the pool, and every tail the
+// scheduler lets live at once has a generator
+static_assert(Sequencer::Scheduler::getCapacity() >= Sequencer::Modes::MAX_EVENTS_PER_STEP,
+              "a full step must fit the scheduler pool");
+static_assert(Sequencer::Scheduler::getMaxGenerators() >= Sequencer::Modes::MAX_LIVE_RECURRENCES,
+              "every live tail must have a generator");
+static_assert(MIDIEventBuffer<>::getMaxEvents() >= Sequencer::Modes::MAX_EVENTS_PER_CALL &&
+              MIDIEventBuffer<>::getMaxRecurrences() >= Sequencer::Modes::MAX_RECURRENCES_PER_CALL,
+              "one mode call must fit a recording buffer");
+
+// The sequencer's scheduler, compiled once here
+template class MIDIScheduler<Sequencer::SCHEDULER_CAPACITY>;
+
+Sequencer* Sequencer::activeInstance = nullptr;
+
+Sequencer::Sequencer(Song* s, Hardware* hw, Scheduler* sched, MIDIDispatcher* out)
+  : song(s), hardware(hw), scheduler(sched), dispatcher(out),
+    timeSource(sched->getTimeSource()),
     currentStep(0), currentTrack(0), currentMode(1),  // Mode 1 for drum machine
     sequencePosition(0),  // Start at beginning of Mode 0 sequence
-    bpm(120.0), sendClock(true), isPlaying(false) {
+    bpm(120.0), lastStepTick(0), sendClock(true), isPlaying(false), congestedSteps(0) {
 
   // Initialize all modes to nullptr
   for (uint8_t i = 0; i < 15; i++) {
@@ -22,6 +33,11 @@ Sequencer::Sequencer(Song* s, Hardware* hw, MIDIScheduler* sched)
 }
 
 Sequencer::~Sequencer() {
+  tickTimer.end();
+  if (activeInstance == this) {
+    activeInstance = nullptr;
+  }
+
   // Clean up mode instances
   for (uint8_t i = 0; i < 15; i++) {
     if (modes[i] != nullptr) {
@@ -31,27 +47,17 @@ Sequencer::~Sequencer() {
 }
 
 void Sequencer::init() {
-  // Create mode instances
+  // Create mode instances (see Modes in Sequencer.h):
   // Mode 0: Pattern Sequencer (channel 1)
-  modes[0] = new Mode0_PatternSequencer(1);
-
   // Mode 1: Drum Machine (channel 2)
-  modes[1] = new Mode1_DrumMachine(2);
-
   // Mode 2: Acid Bass (channel 3)
-  modes[2] = new Mode2_AcidBass(3);
-
   // Mode 3: Euclidean Fade (channel 4)
-  modes[3] = new Mode3_EuclideanFade(4);
-
   // Mode 4: Meta Arp (channel 5)
-  modes[4] = new Mode4_MetaArp(5);
-
   // Mode 5: Bassline Progression (channel 6)
-  modes[5] = new Mode5_BasslineProgression(6);
+  Modes::create(modes);
 
   // Modes 6-14: Not yet implemented, set to nullptr
-  // You can add more modes here as they're implemented
+  // Add new modes to Modes as they're implemented
 
   // Modes no longer need scheduler reference - they're pure functions!
   // They return MIDIEvents which we schedule in bulk
@@ -59,33 +65,32 @@ void Sequencer::init() {
   // Calculate timing intervals
   calculateIntervals();
 
-  // Initialize timing
-  lastStepTime = millis();
-  lastClockTime = millis();
+  // Start the step clock interrupt (ticks only flow once start() is called)
+  activeInstance = this;
+  tickTimer.begin(onTickInterrupt, GRUVBOK::Timing::TICK_ISR_PERIOD_US);
 }
 
 void Sequencer::start() {
   isPlaying = true;
   currentStep = 0;
-  lastStepTime = millis();
-  lastClockTime = millis();
+  lastStepTick = 0;
+  tickEngine.start(now32());
+  dispatcher->invalidateControllerCache();  // Receiver may have been reset meanwhile
 
   // Send MIDI Start message
-  usbMIDI.sendRealTime(usbMIDI.Start);
+  postRealTime(MIDIMessage::START);
 }
 
 void Sequencer::stop() {
   isPlaying = false;
+  tickEngine.stop();
 
   // Send MIDI Stop message
-  usbMIDI.sendRealTime(usbMIDI.Stop);
+  postRealTime(MIDIMessage::STOP);
 
-  // Stop all notes on all channels
-  for (uint8_t i = 0; i < 15; i++) {
-    if (modes[i] != nullptr) {
-      scheduler->stopall(modes[i]->getChannel(), 0);
-    }
-  }
+  // Drop notes that have not started and release exactly the ones sounding
+  scheduler->clear();
+  scheduler->panic();
 }
 
 void Sequencer::setBPM(float newBPM) {
@@ -98,30 +103,48 @@ void Sequencer::setBPM(float newBPM) {
 }
 
 void Sequencer::update() {
-  unsigned long currentTime = millis();
-
   // Handle user input
   handleInput();
 
-  // Send MIDI clock pulses if enabled
-  if (isPlaying && sendClock) {
-    if (currentTime - lastClockTime >= clockInterval) {
-      sendClockPulse();
-    }
+  // Work through the steps queued by the timer interrupt. Clock pulses
+  // fall on the same master ticks and are sent by the interrupt itself,
+  // so outgoing clock and notes are phase-locked
+  uint32_t stepTimes[CatchUpPlanner::MAX_BATCH];
+  uint32_t lostSteps[CatchUpPlanner::MAX_BATCH];
+  uint8_t stepCount = 0;
+  TickEvent tick = {};
+  while (stepCount < CatchUpPlanner::MAX_BATCH && tickEngine.poll(tick)) {
+    // Steps the queue had no room for show as a gap in the tick numbers
+    uint32_t steps = (tick.tick - lastStepTick) / GRUVBOK::Timing::TICKS_PER_STEP;
+    lastStepTick = tick.tick;
+    lostSteps[stepCount] = steps > 1 ? steps - 1 : 0;
+    stepTimes[stepCount++] = tick.time;
   }
 
-  // Advance sequencer steps
-  if (isPlaying) {
-    while (currentTime - lastStepTime >= stepInterval) {
-      lastStepTime += stepInterval;  // Accumulate time to prevent drift
+  // More than one step waiting means the loop stalled; the catch-up
+  // policy decides whether missed steps replay, get skipped or compressed.
+  // The position always advances (lost steps too, silently) so the song
+  // stays on the beat
+  if (stepCount > 0) {
+    catchUp.beginBatch(stepTimes, stepCount, now32());
+    for (uint8_t i = 0; i < stepCount; i++) {
+      for (uint32_t lost = lostSteps[i]; lost > 0; lost--) {
+        advanceStep();
+      }
       advanceStep();
-      processStep();
+      uint32_t baseTime;
+      if (catchUp.planStep(i, baseTime)) {
+        processStep(baseTime);
+      }
     }
   }
 
-  // Update MIDI scheduler (execute scheduled events)
+  // Update MIDI scheduler (hand soon-due events to the dispatch interrupt)
   scheduler->update();
 
+  // Ports too slow or too costly for the interrupt (host pipes, files)
+  dispatcher->servicePorts();
+
   // Keep USB MIDI running
   while (usbMIDI.read()) {
     // Process incoming MIDI if needed
@@ -139,8 +162,8 @@ void Sequencer::advanceStep() {
   }
 
   // Check if current step has an active note
-  Pattern& pattern = song->getPattern(currentMode, currentPatterns[currentMode]);
-  Track& track = pattern.getTrack(currentTrack);
+  const Pattern& pattern = song->getPattern(currentMode, currentPatterns[currentMode]);
+  Pattern::ConstTrackRef track = pattern.getTrack(currentTrack);
   const Event& event = track.getEvent(currentStep);
 
   if (event.getSwitch()) {
@@ -160,58 +183,99 @@ void Sequencer::advanceStep() {
   }
 }
 
-void Sequencer::processStep() {
-  unsigned long stepTime = millis();
+void Sequencer::processStep(unsigned long stepTime) {
+  // Work in logical time: deltas are relative to the step's ideal start,
+  // so processing late does not shift the step's events
+  scheduler->beginStep(stepTime);
 
-  // Create event buffer for collecting MIDI events from all modes
-  MIDIEventBuffer eventBuffer;
+  // Modes write their MIDI events straight into the scheduler
+  SchedulerSink sink(*scheduler, stepTime);
+  sink.setBeatInterval(GRUVBOK::Timing::calculateBeatInterval(bpm));  // Sub-step placement
 
   // PURE FUNCTIONAL DESIGN:
-  // 1. Collect events from all modes (pure functions, no side effects)
-  // 2. Schedule all events in bulk (single point of I/O)
+  // Modes are pure functions of their events; the sink is the single
+  // point of I/O
+
+  // Visit only the live (mode, track) pairs: the tracks' switch masks
+  // give the tracks whose switch is on at this step, so empty tracks and
+  // patterns cost one bit gather per mode. Modes that never emit are
+  // skipped; modes that need idle steps (see ModeBase) still see every
+  // track.
+  const uint8_t allTracks = (uint8_t)((1 << Pattern::getNumTracks()) - 1);
 
-  // Process all active modes
   for (uint8_t modeIndex = 0; modeIndex < 15; modeIndex++) {
     if (modes[modeIndex] == nullptr) continue;
 
+    uint16_t modeBit = (uint16_t)1 << modeIndex;
+    if (Modes::SILENT_MODES & modeBit) continue;
+
     // Get current pattern for this mode
     uint8_t patternIndex = currentPatterns[modeIndex];
-    Pattern& pattern = song->getPattern(modeIndex, patternIndex);
+    uint8_t live = (Modes::IDLE_STEP_MODES & modeBit)
+        ? allTracks
+        : song->getLiveTracks(modeIndex, patternIndex, currentStep);
+    if (live == 0) continue;
+
+    const Pattern& pattern = song->getPattern(modeIndex, patternIndex);
+
+    while (live != 0) {
+      uint8_t trackIndex = (uint8_t)__builtin_ctz(live);
+      live &= live - 1;
+      const Event& event = pattern.getTrack(trackIndex).getEvent(currentStep);
+
+      // Let the mode generate MIDI events (pure function!), tagged with
+      // their origin so a pattern change can cancel them
+      sink.setOrigin(modeIndex, trackIndex);
+      modes[modeIndex]->processEvent(trackIndex, event, stepTime, sink);
+    }
+  }
 
-    // Process all tracks in this pattern
-    for (uint8_t trackIndex = 0; trackIndex < Pattern::getNumTracks(); trackIndex++) {
-      Track& track = pattern.getTrack(trackIndex);
-      const Event& event = track.getEvent(currentStep);
+  // Events the scheduler could not take (it evicts by priority, so what is
+  // lost is the least important traffic)
+  bool lost = sink.getOverflowCount() > 0;
 
-      // Let the mode generate MIDI events (pure function!)
-      modes[modeIndex]->processEvent(trackIndex, event, stepTime, eventBuffer);
+  // Under backpressure the sequencer sheds debug CCs (postControlChange)
+  if (lost || scheduler->hasBackpressure()) {
+    congestedSteps++;
+  }
+}
 
-      // If buffer is getting full, schedule events now and clear
-      if (eventBuffer.remaining() < 8) {
-        scheduler->scheduleAll(eventBuffer);
-        eventBuffer.clear();
-      }
+void Sequencer::onTickInterrupt() {
+  Sequencer* self = activeInstance;
+  if (self == nullptr) return;
+
+  uint32_t now = micros();
+  uint8_t pulses = self->tickEngine.onInterrupt(now);
+  if (self->sendClock) {
+    while (pulses-- > 0) {
+      self->sendClockPulse(now);
     }
   }
+  self->dispatcher->onInterrupt(now);
+}
 
-  // Schedule any remaining events
-  if (!eventBuffer.isEmpty()) {
-    scheduler->scheduleAll(eventBuffer);
-  }
+void Sequencer::sendClockPulse(uint32_t now) {
+  dispatcher->sendNow(MIDIMessage::realTime(now, MIDIMessage::CLOCK));
 }
 
-void Sequencer::sendClockPulse() {
-  lastClockTime = millis();
-  usbMIDI.sendRealTime(usbMIDI.Clock);
+void Sequencer::postControlChange(uint8_t controller, uint8_t value, uint8_t channel) {
+  // Debug CCs are the first traffic to go when the scheduler is congested
+  if (scheduler->hasBackpressure()) return;
+  scheduler->cc(channel, controller, value, 0, MIDIEvent::PRIORITY_DEBUG);
+}
+
+void Sequencer::postRealTime(uint8_t status) {
+  dispatcher->post(MIDIMessage::realTime(now32(), status));
 }
 
 void Sequencer::calculateIntervals() {
-  // Step interval: 16th notes at current BPM
-  // (60 seconds / BPM) * 1000 ms * (1 beat / 4 steps) = ms per step
-  stepInterval = (unsigned long)((60000.0 / bpm) / 4.0);
+  // Master tick: 96 PPQN
+  // (60 seconds / BPM) * 1000000 us * (1 beat / 96 ticks) = us per tick
+  // Steps (every 24 ticks) and MIDI clock (every 4 ticks) follow from it
+  tickEngine.setTempo(bpm);
 
-  // MIDI clock: 24 PPQN (pulses per quarter note)
-  clockInterval = (unsigned long)((60000.0 / bpm) / 24.0);
+  // Pending tick-timed events (echo tails) follow the new tempo
+  scheduler->setTempo(GRUVBOK::Timing::calculateBeatInterval(bpm), now32());
 }
 
 void Sequencer::handleInput() {
@@ -244,7 +308,7 @@ void Sequencer::handleInput() {
     uint8_t newMode = (modePot * 15) / 128;  // Use 128 to prevent overflow to 15
     if (newMode > 14) newMode = 14;
     setCurrentMode(newMode);
-    usbMIDI.sendControlChange(1, newMode, 16);  // Debug CC
+    postControlChange(1, newMode, 16);  // Debug CC
   }
 
   // Pot 2: Pattern selection (0-31)
@@ -254,9 +318,9 @@ void Sequencer::handleInput() {
     if (newPattern > 31) newPattern = 31;
     // Set pattern for ALL modes (global pattern switching)
     for (uint8_t i = 0; i < 15; i++) {
-      currentPatterns[i] = newPattern;
+      setPattern(i, newPattern);
     }
-    usbMIDI.sendControlChange(2, newPattern, 16);  // Debug CC
+    postControlChange(2, newPattern, 16);  // Debug CC
   }
 
   // Pot 3: Track selection (0-7)
@@ -265,19 +329,21 @@ void Sequencer::handleInput() {
     uint8_t newTrack = (trackPot * 8) / 128;  // Use 128 to prevent overflow to 8
     if (newTrack > 7) newTrack = 7;
     setCurrentTrack(newTrack);
-    usbMIDI.sendControlChange(3, newTrack, 16);  // Debug CC
+    postControlChange(3, newTrack, 16);  // Debug CC
   }
 
   // ========================================
   // SLIDERS: Debug CCs (always send, no threshold)
   // ========================================
-  static unsigned long lastSliderDebug = 0;
-  if (millis() - lastSliderDebug > 50) {  // Send every 50ms
-    lastSliderDebug = millis();
+  static uint64_t lastSliderDebug = 0;
+  uint64_t now = timeSource->now();
+  if (now - lastSliderDebug > 50000) {  // Send every 50ms
+    lastSliderDebug = now;
     for (uint8_t i = 0; i < 4; i++) {
       uint8_t sliderValue = hardware->readSlider(i);
-      // CC20-23 on channel 2 (drum machine channel)
-      usbMIDI.sendControlChange(20 + i, sliderValue, 2);
+      // CC20-23 on the debug channel, which stays off DIN
+      postControlChange(GRUVBOK::Debug::CC_SLIDER_BASE + i, sliderValue,
+                        GRUVBOK::Debug::DEBUG_CHANNEL);
     }
   }
 }
@@ -288,8 +354,8 @@ void Sequencer::recordEvent(uint8_t buttonIndex, bool state) {
 
   // Get current pattern and track
   Pattern& pattern = song->getPattern(currentMode, currentPatterns[currentMode]);
-  Track& track = pattern.getTrack(currentTrack);
-  Event& event = track.getEvent(stepIndex);
+  Pattern::TrackRef track = pattern.getTrack(currentTrack);
+  EventRef event = track.getEvent(stepIndex);  // Keeps the track's switch mask current
 
   // Toggle the switch
   event.toggleSwitch();
@@ -303,11 +369,19 @@ void Sequencer::recordEvent(uint8_t buttonIndex, bool state) {
   }
 }
 
+void Sequencer::setPattern(uint8_t mode, uint8_t pattern) {
+  if (currentPatterns[mode] == pattern) return;
+  currentPatterns[mode] = pattern;
+  // Tails of the old pattern would play over the new one; notes already
+  // sounding still get their NOTE_OFF
+  scheduler->cancelOrigin(mode);
+}
+
 void Sequencer::updatePatternFromSequence() {
   // Mode 0 controls pattern sequencing
   // Read Mode 0, Pattern 0, Track 0 to get the sequence
-  Pattern& mode0Pattern = song->getPattern(0, 0);
-  Track& sequenceTrack = mode0Pattern.getTrack(0);
+  const Pattern& mode0Pattern = song->getPattern(0, 0);
+  Pattern::ConstTrackRef sequenceTrack = mode0Pattern.getTrack(0);
 
   // Read current sequence position
   const Event& sequenceEvent = sequenceTrack.getEvent(sequencePosition);
@@ -320,7 +394,7 @@ void Sequencer::updatePatternFromSequence() {
 
     // Update all modes (except Mode 0) to use this pattern
     for (uint8_t i = 1; i < 15; i++) {
-      currentPatterns[i] = patternNumber;
+      setPattern(i, patternNumber);
     }
 
     // Advance to next sequence position
@@ -338,7 +412,7 @@ void Sequencer::updatePatternFromSequence() {
       uint8_t patternNumber = (firstEvent.getPot(0) * 32) / 128;
       if (patternNumber > 31) patternNumber = 31;
       for (uint8_t i = 1; i < 15; i++) {
-        currentPatterns[i] = patternNumber;
+        setPattern(i, patternNumber);
       }
     }
   }
@@ -4,7 +4,17 @@
 #include "../core/Song.h"
 #include "../hardware/Hardware.h"
 #include "MIDIScheduler.h"
-#include "../modes/Mode.h"
+#include "MIDIDispatcher.h"
+#include "TickEngine.h"
+#include "CatchUpPlanner.h"
+#include "../platform/TimerInterrupt.h"
+#include "../modes/ModeList.h"
+#include "../modes/Mode0_PatternSequencer.h"
+#include "../modes/Mode1_DrumMachine.h"
+#include "../modes/Mode2_AcidBass.h"
+#include "../modes/Mode3_EuclideanFade.h"
+#include "../modes/Mode4_MetaArp.h"
+#include "../modes/Mode5_BasslineProgression.h"
 
 /**
  * Sequencer - The heart of GRUVBOK
@@ -19,16 +29,44 @@
  *
  * Dataflow:
  * 1. User presses button → Event is recorded at current step
- * 2. Sequencer advances through steps based on tempo
+ * 2. Timer interrupt runs the master tick and queues steps/clock pulses
+ *    (TickEngine); update() advances through them in the main loop
  * 3. For each step, all active modes process their events
  * 4. Modes schedule MIDI via MIDIScheduler
- * 5. MIDIScheduler executes MIDI at scheduled times
+ * 5. MIDIScheduler hands soon-due MIDI to MIDIDispatcher
+ * 6. The same timer interrupt sends clock pulses and due MIDI on time
+ *
+ * Main loop time comes from the scheduler's TimeSource (see
+ * MIDIScheduler::setTimeSource()); the interrupt reads micros(), which is
+ * the low word of the system time source.
+ *
+ * The scheduler is sized from the registered modes' declared bounds
+ * (ModeList): a step with every track of every mode on, plus the slot and
+ * sounding note's off of every tail alive, fit on top of
+ * MAX_SCHEDULED_EVENTS for notes still pending from earlier steps. How
+ * many of those there are depends on note lengths and tempo, so that part
+ * is headroom, not a bound; past it the scheduler evicts by priority and
+ * signals backpressure.
  */
 class Sequencer {
+public:
+  // Modes init() registers, in mode order (mode i on MIDI channel i + 1)
+  typedef ModeList<Mode0_PatternSequencer, Mode1_DrumMachine, Mode2_AcidBass,
+                   Mode3_EuclideanFade, Mode4_MetaArp, Mode5_BasslineProgression> Modes;
+
+  // One full step of Modes, each live tail's slot and note off, and
+  // MAX_SCHEDULED_EVENTS for the notes earlier steps left pending
+  static constexpr uint16_t SCHEDULER_CAPACITY =
+      Modes::MAX_EVENTS_PER_STEP + 2 * Modes::MAX_LIVE_RECURRENCES +
+      GRUVBOK::MIDI::MAX_SCHEDULED_EVENTS;
+  typedef MIDIScheduler<SCHEDULER_CAPACITY> Scheduler;
+
 private:
   Song* song;                    // The complete song data
   Hardware* hardware;            // Hardware I/O
-  MIDIScheduler* scheduler;      // MIDI event scheduler
+  Scheduler* scheduler;          // MIDI event scheduler
+  MIDIDispatcher* dispatcher;    // Interrupt-driven MIDI output
+  TimeSource* timeSource;        // Main loop time (shared with the scheduler)
   Mode* modes[15];               // Array of mode instances
 
   // Playback state
@@ -38,21 +76,24 @@ private:
   uint8_t currentMode;           // Currently selected mode for editing (0-14)
   uint8_t sequencePosition;      // Current position in Mode 0 pattern sequence (0-15)
 
-  // Timing
+  // Timing (steps and MIDI clock both derived from the master tick,
+  // which runs in the timer interrupt)
   float bpm;                     // Current tempo
-  unsigned long stepInterval;    // Time between steps (ms)
-  unsigned long lastStepTime;    // Last step advance time
-  unsigned long clockInterval;   // MIDI clock interval (ms)
-  unsigned long lastClockTime;   // Last MIDI clock time
+  TickEngine tickEngine;         // 96 PPQN master clock + ISR → loop queue
+  uint32_t lastStepTick;         // Master tick of the last step taken from tickEngine
+  TimerInterrupt tickTimer;      // Drives tickEngine.onInterrupt()
+  static Sequencer* activeInstance;  // Target of the interrupt handler
+  CatchUpPlanner catchUp;        // What to do with steps missed during a stall
 
   // MIDI Clock
   bool sendClock;                // Enable/disable MIDI clock output
 
   // State
   bool isPlaying;                // Playback state
+  uint32_t congestedSteps;       // Steps that hit scheduler backpressure
 
 public:
-  Sequencer(Song* s, Hardware* hw, MIDIScheduler* sched);
+  Sequencer(Song* s, Hardware* hw, Scheduler* sched, MIDIDispatcher* out);
   ~Sequencer();
 
   /**
@@ -121,6 +162,23 @@ public:
    */
   void setClockEnabled(bool enabled) { sendClock = enabled; }
 
+  /**
+   * Choose how steps missed during a main loop stall are played
+   */
+  void setCatchUpPolicy(CatchUpPlanner::Policy policy) { catchUp.setPolicy(policy); }
+  CatchUpPlanner::Policy getCatchUpPolicy() const { return catchUp.getPolicy(); }
+
+  /**
+   * Stall counters (number of stalls, longest stall, steps skipped/compressed)
+   */
+  const CatchUpPlanner::Stats& getStallStats() const { return catchUp.getStats(); }
+  void resetStallStats() { catchUp.resetStats(); }
+
+  /**
+   * Steps whose events did not all fit the scheduler, or left it nearly full
+   */
+  uint32_t getCongestedStepCount() const { return congestedSteps; }
+
 private:
   /**
    * Advance to next step
@@ -129,16 +187,40 @@ private:
 
   /**
    * Process current step across all modes
+   * @param stepTime Ideal start of the step (master tick time, microseconds);
+   *                 all event deltas of the step are relative to it
+   */
+  void processStep(unsigned long stepTime);
+
+  /**
+   * Timer interrupt handler
+   */
+  static void onTickInterrupt();
+
+  /**
+   * Send MIDI clock pulse (interrupt context), stamped with the
+   * interrupt's time so it shares one timestamp with the dispatch
+   */
+  void sendClockPulse(uint32_t now);
+
+  /**
+   * Queue an immediate debug control change (lowest priority, skipped
+   * under scheduler backpressure)
    */
-  void processStep();
+  void postControlChange(uint8_t controller, uint8_t value, uint8_t channel);
 
   /**
-   * Send MIDI clock pulse
+   * Queue an immediate real-time message for output
    */
-  void sendClockPulse();
+  void postRealTime(uint8_t status);
 
   /**
-   * Calculate timing intervals from BPM
+   * Current main loop time, low 32 bits (compare by signed difference)
+   */
+  uint32_t now32() { return (uint32_t)timeSource->now(); }
+
+  /**
+   * Pass tempo to the master tick
    */
   void calculateIntervals();
 
@@ -152,6 +234,12 @@ private:
    */
   void recordEvent(uint8_t buttonIndex, bool state);
 
+  /**
+   * Switch a mode to another pattern; the old pattern's pending events
+   * (echo tails, future notes) are cancelled
+   */
+  void setPattern(uint8_t mode, uint8_t pattern);
+
   /**
    * Read Mode 0 pattern sequence and update current patterns
    * Called at the start of each pattern (step 0)
@@ -159,4 +247,6 @@ private:
   void updatePatternFromSequence();
 };
 
+extern template class MIDIScheduler<Sequencer::SCHEDULER_CAPACITY>;
+
 #endif // SEQUENCER_H
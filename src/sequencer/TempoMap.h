@@ -0,0 +1,101 @@
+#ifndef TEMPOMAP_H
+#define TEMPOMAP_H
+
+#include <stdint.h>
+#include "../core/Constants.h"
+
+/**
+ * TempoMap - Converts between wall time and musical position
+ *
+ * Musical position counts master ticks in 1/2^FRACTION_BITS units. The map
+ * is a straight line through an anchor (time, position) with the current
+ * beat length as slope. A tempo change moves the anchor to the moment of
+ * the change and only alters the slope after it, so the position never
+ * jumps and everything placed after that moment stretches or shrinks with
+ * the new tempo.
+ *
+ * Position and time are both 32-bit and wrap; conversions use signed
+ * differences from the anchor, so they only hold within 2^31 units of it
+ * (35.8 minutes, or 2^19 ticks). At a steady tempo nothing else moves the
+ * anchor, so follow() must be called regularly (the scheduler does on
+ * every step and update): it re-anchors at the current time and position
+ * once either has drifted 2^30 from the anchor.
+ */
+class TempoMap {
+public:
+  static constexpr uint8_t FRACTION_BITS = 12;   // Position units per tick: 4096
+
+private:
+  // Position units per Q24.8 beat-length unit and microsecond
+  static constexpr uint64_t UNITS_PER_BEAT =
+      (uint64_t)GRUVBOK::Timing::MASTER_PPQN << (GRUVBOK::Timing::INTERVAL_FRACTION_BITS + FRACTION_BITS);
+
+  // Re-anchor once time or position is this far from the anchor
+  static constexpr uint32_t REANCHOR_DISTANCE = 1UL << 30;
+
+  uint32_t anchorTime;      // Microseconds
+  uint32_t anchorPosition;  // Position at anchorTime
+  uint32_t beatInterval;    // Q24.8 microseconds per quarter note
+  uint32_t reanchorSpan;    // Microseconds until time or position is REANCHOR_DISTANCE away
+
+  // Time in which the position advances REANCHOR_DISTANCE, capped at that
+  static uint32_t spanFor(uint32_t q8Micros) {
+    uint64_t span = (uint64_t)REANCHOR_DISTANCE * q8Micros / UNITS_PER_BEAT;
+    return span < REANCHOR_DISTANCE ? (uint32_t)span : REANCHOR_DISTANCE;
+  }
+
+public:
+  TempoMap()
+    : anchorTime(0), anchorPosition(0),
+      beatInterval(GRUVBOK::Timing::calculateBeatInterval(GRUVBOK::Timing::DEFAULT_BPM)),
+      reanchorSpan(spanFor(beatInterval)) {}
+
+  /**
+   * Change tempo from a given moment on
+   * @param q8Micros Microseconds per quarter note, Q24.8 fixed point
+   * @param now Time of the change (microseconds)
+   */
+  void setBeatInterval(uint32_t q8Micros, uint32_t now) {
+    anchorPosition = positionAt(now);
+    anchorTime = now;
+    beatInterval = q8Micros > 0 ? q8Micros : 1;
+    reanchorSpan = spanFor(beatInterval);
+  }
+
+  /**
+   * Keep the anchor within range of now (same tempo, same position line)
+   * @param now Current time (microseconds)
+   */
+  void follow(uint32_t now) {
+    int32_t elapsed = (int32_t)(now - anchorTime);
+    uint32_t distance = elapsed < 0 ? (uint32_t)-(int64_t)elapsed : (uint32_t)elapsed;
+    if (distance < reanchorSpan) return;
+    anchorPosition = positionAt(now);
+    anchorTime = now;
+  }
+
+  uint32_t getBeatInterval() const { return beatInterval; }
+
+  /**
+   * Musical position at a time
+   */
+  uint32_t positionAt(uint32_t time) const {
+    int64_t elapsed = (int32_t)(time - anchorTime);
+    return anchorPosition + (uint32_t)(int32_t)(elapsed * (int64_t)UNITS_PER_BEAT / beatInterval);
+  }
+
+  /**
+   * Time a musical position is reached at the current tempo
+   */
+  uint32_t timeAt(uint32_t position) const {
+    int64_t distance = (int32_t)(position - anchorPosition);
+    return anchorTime + (uint32_t)(int32_t)(distance * beatInterval / (int64_t)UNITS_PER_BEAT);
+  }
+
+  /**
+   * Length of a number of master ticks in position units
+   */
+  static uint32_t ticks(uint32_t numTicks) { return numTicks << FRACTION_BITS; }
+};
+
+#endif  // TEMPOMAP_H
@@ -0,0 +1,146 @@
+#ifndef TICKENGINE_H
+#define TICKENGINE_H
+
+#include <stdint.h>
+#include <atomic>
+#include "../core/Constants.h"
+#include "../core/SPSCQueue.h"
+#include "MasterClock.h"
+
+/**
+ * TickEvent - One step tick, handed from the ISR to the main loop
+ */
+struct TickEvent {
+  uint32_t tick;    // Master tick number since start
+  uint32_t time;    // Ideal time of the tick (microseconds)
+  uint8_t epoch;    // Playback run the tick belongs to (see TickEngine::start)
+};
+
+/**
+ * TickEngine - Interrupt-driven master clock
+ *
+ * The timer interrupt calls onInterrupt(now), which runs the MasterClock,
+ * returns the MIDI clock pulses for the interrupt to send and pushes every
+ * step tick into a lock-free SPSC queue. The main loop pops the steps with
+ * poll() and does the actual work (mode processing, MIDI output). Tick
+ * timing therefore no longer depends on how long a main loop pass takes:
+ * a slow pass delays the work, never the beat.
+ *
+ * Contexts:
+ * - Interrupt: onInterrupt() only
+ * - Main loop: everything else
+ *
+ * Cross-context state is a queue and a few atomics; nothing disables
+ * interrupts. Tempo and start requests are picked up by the next
+ * interrupt. Ticks queued before a restart carry the old epoch and are
+ * dropped by poll().
+ */
+class TickEngine {
+public:
+  static constexpr uint16_t QUEUE_SIZE = 64;  // > 1 s of steps at 800 BPM
+
+private:
+  // Interrupt-owned
+  MasterClock clock;
+  uint8_t clockEpoch;
+
+  // Shared
+  SPSCQueue<TickEvent, QUEUE_SIZE> queue;
+  std::atomic<uint32_t> pendingBeatInterval;
+  std::atomic<uint32_t> pendingStartTime;
+  std::atomic<uint8_t> epoch;          // Bumped by start(), adopted by the ISR
+  std::atomic<bool> running;
+  std::atomic<uint32_t> overflows;     // Steps dropped because the queue was full
+
+public:
+  TickEngine()
+    : clockEpoch(0),
+      pendingBeatInterval(GRUVBOK::Timing::calculateBeatInterval(GRUVBOK::Timing::DEFAULT_BPM)),
+      pendingStartTime(0), epoch(0), running(false), overflows(0) {}
+
+  // ========================================
+  // Main loop side
+  // ========================================
+
+  /**
+   * Set tempo (applied by the next interrupt)
+   */
+  void setTempo(float bpm) {
+    pendingBeatInterval.store(GRUVBOK::Timing::calculateBeatInterval(bpm),
+                              std::memory_order_relaxed);
+  }
+
+  /**
+   * Start (or restart) at tick 0
+   * @param now Time of tick 0 (microseconds)
+   */
+  void start(uint32_t now) {
+    pendingStartTime.store(now, std::memory_order_relaxed);
+    epoch.fetch_add(1, std::memory_order_release);
+    running.store(true, std::memory_order_release);
+  }
+
+  /**
+   * Stop producing ticks
+   */
+  void stop() {
+    running.store(false, std::memory_order_release);
+  }
+
+  bool isRunning() const { return running.load(std::memory_order_relaxed); }
+
+  /**
+   * Take the next tick of the current run
+   * @return false if no tick is waiting
+   */
+  bool poll(TickEvent& out) {
+    uint8_t current = epoch.load(std::memory_order_relaxed);
+    while (queue.pop(out)) {
+      if (out.epoch == current) return true;
+    }
+    return false;
+  }
+
+  /**
+   * Steps lost because the main loop fell more than QUEUE_SIZE steps
+   * behind (the tick numbers of the later ones show the gap)
+   */
+  uint32_t getOverflowCount() const { return overflows.load(std::memory_order_relaxed); }
+
+  // ========================================
+  // Interrupt side
+  // ========================================
+
+  /**
+   * Timer interrupt handler body
+   * @param now Current time (microseconds)
+   * @return Number of MIDI clock pulses that fell due (for sending from
+   *         the interrupt, at tick time)
+   */
+  uint8_t onInterrupt(uint32_t now) {
+    if (!running.load(std::memory_order_acquire)) return 0;
+
+    uint8_t requested = epoch.load(std::memory_order_acquire);
+    if (requested != clockEpoch) {
+      clockEpoch = requested;
+      clock.reset(pendingStartTime.load(std::memory_order_relaxed));
+    }
+    clock.setBeatInterval(pendingBeatInterval.load(std::memory_order_relaxed));
+
+    uint8_t pulses = 0;
+    while (clock.due(now)) {
+      clock.advance();
+
+      if (clock.isClockTick()) pulses++;
+      if (!clock.isStepTick()) continue;
+
+      TickEvent event = {clock.getTick(), clock.getTickTime(), clockEpoch};
+      if (!queue.push(event)) {
+        overflows.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    return pulses;
+  }
+};
+
+#endif  // TICKENGINE_H
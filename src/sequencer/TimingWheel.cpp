@@ -0,0 +1,4 @@
+#include "TimingWheel.h"
+
+// The scheduler's default size, compiled once here
+template class TimingWheel<>;
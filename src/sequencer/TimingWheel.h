@@ -0,0 +1,343 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <stdint.h>
+#include "../core/Constants.h"
+#include "../core/SlotMask.h"
+
+/**
+ * TimingWheel - Hierarchical timing wheel for the MIDI scheduler
+ *
+ * Orders a fixed pool of nodes (indices 0..CAPACITY-1) by due time.
+ * The wheel only stores links and times; the caller owns the payload.
+ * Node indices are the smallest type that holds Capacity (SlotIndex):
+ * one byte per link up to 254 nodes.
+ *
+ * Four levels of 256 buckets each, 8 bits of the 32-bit time per level.
+ * With microsecond time:
+ * - Level 0: 1 us buckets     (exact event times, 256 us window)
+ * - Level 1: 256 us buckets   (sub-step ticks, 65 ms window)
+ * - Level 2: 65.5 ms buckets  (about half a step at 120 BPM; steps and bars)
+ * - Level 3: 16.8 s buckets   (long echo tails, wraps with the 32-bit time)
+ *
+ * A node lives on the level of the highest 8-bit group in which its time
+ * differs from the cursor. When the cursor enters a higher-level bucket,
+ * that bucket is cascaded down one or more levels. Every node cascades at
+ * most three times, so insert and expiry are both O(1). Far-future events
+ * (Mode3 echo tails) sit untouched in outer buckets until they get close.
+ *
+ * Per-level occupancy bitmaps let advance() jump straight to the next
+ * non-empty bucket instead of ticking through empty ones.
+ *
+ * Buckets are FIFO lists, and all nodes with the same time always share one
+ * bucket, so same-time nodes come out in insertion order.
+ *
+ * Time comparisons use signed differences, so the 32-bit time may wrap.
+ * Nodes scheduled at a time the wheel has already advanced past go straight
+ * onto the ready list.
+ */
+template<uint16_t Capacity = GRUVBOK::MIDI::MAX_SCHEDULED_EVENTS>
+class TimingWheel {
+public:
+  typedef typename SlotIndex<Capacity>::type Index;
+
+  static constexpr Index CAPACITY = Capacity;
+  static constexpr Index NONE = SlotIndex<Capacity>::NONE;
+
+  TimingWheel() {
+    reset(0);
+  }
+
+  /**
+   * Drop all nodes and set the cursor
+   * @param now First time that has not been processed yet
+   */
+  void reset(uint32_t now);
+
+  /**
+   * Add a node (must not already be in the wheel)
+   * @param node Node index (0 to CAPACITY-1)
+   * @param time Due time
+   */
+  void insert(Index node, uint32_t time);
+
+  /**
+   * Take a node out of the wheel or the ready list
+   * @param node Node index currently in the wheel
+   */
+  void remove(Index node);
+
+  /**
+   * Move every node due at or before now onto the ready list,
+   * in time order (FIFO within the same time)
+   */
+  void advance(uint32_t now);
+
+  /**
+   * Take the next node off the ready list
+   * @return Node index, or NONE if nothing is ready
+   */
+  Index popReady();
+
+  /**
+   * Due time of a node in the wheel or on the ready list
+   */
+  uint32_t getTime(Index node) const { return times[node]; }
+
+  /**
+   * Number of nodes in the wheel plus on the ready list
+   */
+  Index size() const { return count; }
+
+private:
+  static constexpr uint8_t LEVELS = 4;
+  static constexpr uint8_t LEVEL_BITS = 8;
+  static constexpr uint16_t SLOTS = 1 << LEVEL_BITS;
+  static constexpr uint8_t WORDS = SLOTS / 32;
+  static constexpr uint16_t READY = LEVELS * SLOTS;  // List id of the ready list
+
+  uint32_t times[CAPACITY];
+  Index next[CAPACITY];                  // Circular doubly-linked bucket lists
+  Index prev[CAPACITY];
+  uint16_t lists[CAPACITY];              // List each node is on (for remove)
+  Index heads[LEVELS * SLOTS + 1];       // Bucket heads, plus the ready list
+  uint32_t occupied[LEVELS][WORDS];      // One bit per non-empty bucket
+  uint8_t occupiedWords[LEVELS];         // One bit per non-zero word above
+
+  uint32_t cursor;                       // First time not yet processed
+  Index count;
+
+  // Place a node relative to the cursor (time must not be before the cursor)
+  void place(Index node, uint32_t time);
+
+  // List helpers
+  void append(uint16_t list, Index node);
+  void markOccupied(uint8_t level, uint8_t slot);
+  void markEmpty(uint8_t level, uint8_t slot);
+
+  // Lowest non-empty slot at or after 'from', wrapping around; -1 if none
+  int16_t findSlot(uint8_t level, uint8_t from) const;
+
+  // Earliest non-empty bucket; false if the wheel is empty
+  bool findEarliest(uint8_t& level, uint8_t& slot, uint32_t& start) const;
+};
+
+template<uint16_t Capacity>
+void TimingWheel<Capacity>::reset(uint32_t now) {
+  for (uint16_t i = 0; i <= READY; i++) {
+    heads[i] = NONE;
+  }
+  for (uint8_t level = 0; level < LEVELS; level++) {
+    for (uint8_t w = 0; w < WORDS; w++) {
+      occupied[level][w] = 0;
+    }
+    occupiedWords[level] = 0;
+  }
+  cursor = now;
+  count = 0;
+}
+
+template<uint16_t Capacity>
+void TimingWheel<Capacity>::insert(Index node, uint32_t time) {
+  count++;
+
+  // Times the cursor has already passed are due immediately
+  if ((int32_t)(time - cursor) < 0) {
+    times[node] = time;
+    append(READY, node);
+    return;
+  }
+  place(node, time);
+}
+
+template<uint16_t Capacity>
+void TimingWheel<Capacity>::advance(uint32_t now) {
+  uint32_t target = now + 1;  // Everything before target is due
+
+  while (true) {
+    uint8_t level;
+    uint8_t slot;
+    uint32_t start;
+
+    bool found = findEarliest(level, slot, start);
+
+    // An outer bucket the cursor has entered must always be cascaded, even
+    // if nothing in it is due yet, so later inserts cannot overtake it
+    bool entered = found && level > 0 && (int32_t)(start - cursor) <= 0;
+
+    if (!entered && (!found || (int32_t)(start - target) >= 0)) {
+      // Nothing due. Move the cursor up to target, then loop once more so
+      // any outer bucket the cursor just entered gets cascaded.
+      if ((int32_t)(target - cursor) > 0) {
+        cursor = target;
+        continue;
+      }
+      return;
+    }
+
+    uint16_t bucket = level * SLOTS + slot;
+    Index head = heads[bucket];
+    heads[bucket] = NONE;
+    markEmpty(level, slot);
+
+    if (level == 0) {
+      // Level 0 buckets hold a single time: splice the whole list onto ready
+      Index node = head;
+      do {
+        lists[node] = READY;
+        node = next[node];
+      } while (node != head);
+
+      Index readyHead = heads[READY];
+      if (readyHead == NONE) {
+        heads[READY] = head;
+      } else {
+        Index readyTail = prev[readyHead];
+        Index tail = prev[head];
+        next[readyTail] = head;
+        prev[head] = readyTail;
+        next[tail] = readyHead;
+        prev[readyHead] = tail;
+      }
+      cursor = start + 1;
+    } else {
+      // Cascade: re-place each node (in order) relative to the bucket start
+      if ((int32_t)(start - cursor) > 0) {
+        cursor = start;
+      }
+      Index node = head;
+      do {
+        Index following = next[node];
+        place(node, times[node]);
+        node = following;
+      } while (node != head);
+    }
+  }
+}
+
+template<uint16_t Capacity>
+void TimingWheel<Capacity>::remove(Index node) {
+  uint16_t list = lists[node];
+
+  if (next[node] == node) {
+    heads[list] = NONE;
+    if (list != READY) {
+      markEmpty(list / SLOTS, list % SLOTS);
+    }
+  } else {
+    Index before = prev[node];
+    Index after = next[node];
+    next[before] = after;
+    prev[after] = before;
+    if (heads[list] == node) {
+      heads[list] = after;
+    }
+  }
+  count--;
+}
+
+template<uint16_t Capacity>
+typename TimingWheel<Capacity>::Index TimingWheel<Capacity>::popReady() {
+  Index head = heads[READY];
+  if (head == NONE) return NONE;
+
+  if (next[head] == head) {
+    heads[READY] = NONE;
+  } else {
+    Index tail = prev[head];
+    Index following = next[head];
+    next[tail] = following;
+    prev[following] = tail;
+    heads[READY] = following;
+  }
+  count--;
+  return head;
+}
+
+template<uint16_t Capacity>
+void TimingWheel<Capacity>::place(Index node, uint32_t time) {
+  times[node] = time;
+
+  // Level = highest 8-bit group where time and cursor differ
+  uint32_t diff = time ^ cursor;
+  uint8_t level = 0;
+  if (diff >= SLOTS) {
+    level = (31 - __builtin_clz(diff)) / LEVEL_BITS;
+  }
+  uint8_t slot = (time >> (level * LEVEL_BITS)) & (SLOTS - 1);
+
+  append(level * SLOTS + slot, node);
+  markOccupied(level, slot);
+}
+
+template<uint16_t Capacity>
+void TimingWheel<Capacity>::append(uint16_t list, Index node) {
+  lists[node] = list;
+  Index head = heads[list];
+  if (head == NONE) {
+    heads[list] = node;
+    next[node] = node;
+    prev[node] = node;
+  } else {
+    Index tail = prev[head];
+    next[tail] = node;
+    prev[node] = tail;
+    next[node] = head;
+    prev[head] = node;
+  }
+}
+
+template<uint16_t Capacity>
+void TimingWheel<Capacity>::markOccupied(uint8_t level, uint8_t slot) {
+  occupied[level][slot >> 5] |= (uint32_t)1 << (slot & 31);
+  occupiedWords[level] |= (uint8_t)(1 << (slot >> 5));
+}
+
+template<uint16_t Capacity>
+void TimingWheel<Capacity>::markEmpty(uint8_t level, uint8_t slot) {
+  uint32_t& word = occupied[level][slot >> 5];
+  word &= ~((uint32_t)1 << (slot & 31));
+  if (word == 0) {
+    occupiedWords[level] &= (uint8_t)~(1 << (slot >> 5));
+  }
+}
+
+template<uint16_t Capacity>
+int16_t TimingWheel<Capacity>::findSlot(uint8_t level, uint8_t from) const {
+  if (occupiedWords[level] == 0) return -1;
+
+  // Partial first word: bits at or after 'from'
+  uint8_t firstWord = from >> 5;
+  uint32_t bits = occupied[level][firstWord] & (~(uint32_t)0 << (from & 31));
+  if (bits != 0) {
+    return (firstWord << 5) + __builtin_ctz(bits);
+  }
+
+  // Remaining words after the first, then wrap around to the start
+  uint8_t later = occupiedWords[level] & (uint8_t)(0xFF << (firstWord + 1));
+  uint8_t words = later ? later : occupiedWords[level];
+  uint8_t w = __builtin_ctz(words);
+  return (w << 5) + __builtin_ctz(occupied[level][w]);
+}
+
+template<uint16_t Capacity>
+bool TimingWheel<Capacity>::findEarliest(uint8_t& level, uint8_t& slot, uint32_t& start) const {
+  // Lower levels always hold earlier times than higher ones, and within a
+  // level the earliest bucket is the first occupied slot from the cursor on
+  for (level = 0; level < LEVELS; level++) {
+    uint8_t shift = level * LEVEL_BITS;
+    uint8_t cursorSlot = (cursor >> shift) & (SLOTS - 1);
+    int16_t found = findSlot(level, cursorSlot);
+    if (found < 0) continue;
+
+    slot = (uint8_t)found;
+    uint8_t offset = (uint8_t)(slot - cursorSlot);
+    start = ((cursor >> shift) + offset) << shift;
+    return true;
+  }
+  return false;
+}
+
+extern template class TimingWheel<>;
+
+#endif  // TIMINGWHEEL_H
@@ -0,0 +1,193 @@
+#ifndef VOICETRACKER_H
+#define VOICETRACKER_H
+
+#include <stdint.h>
+
+/**
+ * VoiceTracker - Which notes are sounding on each MIDI channel
+ *
+ * The scheduler passes every note on/off through the tracker as it leaves
+ * for the output, so the tracker always mirrors what the synth has heard.
+ *
+ * Per channel:
+ * - 128-bit active-note bitmap (one bit per pitch)
+ * - Reference count per pitch: a second NOTE_ON of a sounding pitch (a
+ *   Mode1 flam) retriggers it, and only the last matching NOTE_OFF
+ *   releases it. Earlier offs are suppressed, so the short flam note can
+ *   no longer cut the main hit.
+ * - Voices in start order, for stealing the oldest when the polyphony
+ *   limit is reached
+ *
+ * NOTE_OFFs for pitches that are not sounding are redundant and suppressed
+ * (counted). releaseNext() walks the bitmaps for a panic that sends exact
+ * NOTE_OFFs instead of a blanket CC123.
+ */
+class VoiceTracker {
+public:
+  static constexpr uint8_t CHANNELS = 16;
+  static constexpr uint8_t MAX_VOICES = 16;   // Per channel
+  static constexpr uint8_t NONE = 0xFF;
+
+private:
+  struct Channel {
+    uint32_t active[4];          // Sounding pitches (bit per pitch)
+    uint8_t refs[128];           // Note-ons not yet matched by an off
+    uint8_t order[MAX_VOICES];   // Sounding pitches, oldest first
+    uint8_t voiceCount;
+  };
+
+  Channel channels[CHANNELS];
+  uint8_t polyphony;             // Voices per channel before stealing
+
+  uint32_t suppressedOffs;       // Redundant or still-held offs not sent
+  uint32_t stolenVoices;         // Voices released to make room
+
+  static bool testBit(const uint32_t* bits, uint8_t pitch) {
+    return (bits[pitch >> 5] >> (pitch & 31)) & 1;
+  }
+
+  // Forget a sounding pitch (bitmap, count and voice order)
+  void release(Channel& ch, uint8_t pitch) {
+    ch.active[pitch >> 5] &= ~((uint32_t)1 << (pitch & 31));
+    ch.refs[pitch] = 0;
+    for (uint8_t i = 0; i < ch.voiceCount; i++) {
+      if (ch.order[i] == pitch) {
+        for (uint8_t j = i + 1; j < ch.voiceCount; j++) {
+          ch.order[j - 1] = ch.order[j];
+        }
+        ch.voiceCount--;
+        break;
+      }
+    }
+  }
+
+public:
+  VoiceTracker() : polyphony(MAX_VOICES) {
+    reset();
+  }
+
+  /**
+   * Forget every voice and clear statistics
+   */
+  void reset() {
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+      resetChannel(c + 1);
+    }
+    suppressedOffs = 0;
+    stolenVoices = 0;
+  }
+
+  /**
+   * Set the per-channel polyphony limit (1 to MAX_VOICES)
+   */
+  void setPolyphony(uint8_t voices) {
+    if (voices < 1) voices = 1;
+    if (voices > MAX_VOICES) voices = MAX_VOICES;
+    polyphony = voices;
+  }
+
+  uint8_t getPolyphony() const { return polyphony; }
+
+  /**
+   * A NOTE_ON is being sent
+   * @param channel MIDI channel (1-16)
+   * @return Pitch of a voice stolen to make room (send its NOTE_OFF
+   *         first), or NONE
+   */
+  uint8_t noteOn(uint8_t channel, uint8_t pitch) {
+    Channel& ch = channels[(channel - 1) & 0x0F];
+    pitch &= 0x7F;
+
+    if (testBit(ch.active, pitch)) {
+      if (ch.refs[pitch] < 0xFF) ch.refs[pitch]++;  // Retrigger
+      return NONE;
+    }
+
+    uint8_t stolen = NONE;
+    if (ch.voiceCount >= polyphony) {
+      stolen = ch.order[0];
+      release(ch, stolen);
+      stolenVoices++;
+    }
+
+    ch.active[pitch >> 5] |= (uint32_t)1 << (pitch & 31);
+    ch.refs[pitch] = 1;
+    ch.order[ch.voiceCount++] = pitch;
+    return stolen;
+  }
+
+  /**
+   * A NOTE_OFF is about to be sent
+   * @return true if it releases the pitch and must be sent; false if the
+   *         pitch was not sounding or is still held by another note-on
+   */
+  bool noteOff(uint8_t channel, uint8_t pitch) {
+    Channel& ch = channels[(channel - 1) & 0x0F];
+    pitch &= 0x7F;
+
+    if (!testBit(ch.active, pitch)) {
+      suppressedOffs++;
+      return false;
+    }
+    if (--ch.refs[pitch] > 0) {
+      suppressedOffs++;
+      return false;
+    }
+    release(ch, pitch);
+    return true;
+  }
+
+  /**
+   * All notes on a channel were silenced (CC123)
+   */
+  void resetChannel(uint8_t channel) {
+    Channel& ch = channels[(channel - 1) & 0x0F];
+    for (uint8_t w = 0; w < 4; w++) {
+      ch.active[w] = 0;
+    }
+    for (uint8_t p = 0; p < 128; p++) {
+      ch.refs[p] = 0;
+    }
+    ch.voiceCount = 0;
+  }
+
+  /**
+   * Take one sounding note for a panic (lowest channel and pitch first)
+   * @return false once nothing is sounding
+   */
+  bool releaseNext(uint8_t& channel, uint8_t& pitch) {
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+      Channel& ch = channels[c];
+      if (ch.voiceCount == 0) continue;
+      for (uint8_t w = 0; w < 4; w++) {
+        if (ch.active[w] == 0) continue;
+        channel = c + 1;
+        pitch = (w << 5) + __builtin_ctz(ch.active[w]);
+        release(ch, pitch);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool isSounding(uint8_t channel, uint8_t pitch) const {
+    return testBit(channels[(channel - 1) & 0x0F].active, pitch & 0x7F);
+  }
+
+  uint8_t getVoiceCount(uint8_t channel) const {
+    return channels[(channel - 1) & 0x0F].voiceCount;
+  }
+
+  uint16_t getTotalVoices() const {
+    uint16_t total = 0;
+    for (uint8_t c = 0; c < CHANNELS; c++) {
+      total += channels[c].voiceCount;
+    }
+    return total;
+  }
+
+  uint32_t getSuppressedOffCount() const { return suppressedOffs; }
+  uint32_t getStolenVoiceCount() const { return stolenVoices; }
+};
+
+#endif  // VOICETRACKER_H
@@ -0,0 +1,86 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include "../src/sequencer/MIDIScheduler.h"
+
+// Benchmark: cost of MIDIScheduler::update() versus queue occupancy
+//
+// The scheduler is filled with N events far in the future, so update() finds
+// nothing due. With the old linear slot scan this cost grew with N; with the
+// timing wheel it only checks the occupancy bitmaps and should stay flat.
+
+static const uint16_t ITERATIONS = 10000;
+static const uint8_t OCCUPANCY[] = {0, 8, 16, 32, 48, 63};
+static const uint8_t NUM_LEVELS = sizeof(OCCUPANCY) / sizeof(OCCUPANCY[0]);
+
+static float measureUpdateCost(MIDIScheduler<>& scheduler, uint8_t occupancy) {
+    scheduler.clear();
+    for (uint8_t i = 0; i < occupancy; i++) {
+        // Distinct times 600 ms out: they wait in an upper wheel level, and
+        // none comes due (or cascades down) while update() is timed
+        scheduler.note(1, 60, 100, 600000UL + (unsigned long)i * 37UL);
+    }
+
+    unsigned long start = micros();
+    for (uint16_t i = 0; i < ITERATIONS; i++) {
+        scheduler.update();
+    }
+    unsigned long elapsed = micros() - start;
+
+    return (float)elapsed * 1000.0f / ITERATIONS;  // ns per update()
+}
+
+void test_bench_update_cost_is_flat() {
+    static MIDIScheduler<> scheduler;
+    float cost[NUM_LEVELS];
+    char line[64];
+
+    for (uint8_t i = 0; i < NUM_LEVELS; i++) {
+        cost[i] = measureUpdateCost(scheduler, OCCUPANCY[i]);
+        snprintf(line, sizeof(line), "occupancy %2u: %8.1f ns/update",
+                 OCCUPANCY[i], (double)cost[i]);
+        TEST_MESSAGE(line);
+    }
+
+    // Full queue may cost at most 2x the empty queue (plus timer noise)
+    TEST_ASSERT_TRUE(cost[NUM_LEVELS - 1] <= cost[0] * 2.0f + 200.0f);
+    scheduler.clear();
+}
+
+void test_bench_insert_cost() {
+    static MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    char line[64];
+
+    for (uint8_t i = 0; i < 32; i++) {
+        buffer.noteOn(1, 60, 100, (unsigned long)(31 - i) * 13UL);
+    }
+
+    unsigned long elapsed = 0;
+    for (uint16_t round = 0; round < 100; round++) {
+        scheduler.clear();
+        unsigned long start = micros();
+        scheduler.scheduleAll(buffer, 0);
+        scheduler.scheduleAll(buffer, 0);
+        elapsed += micros() - start;
+    }
+
+    snprintf(line, sizeof(line), "insert: %8.1f ns/event",
+             (double)((float)elapsed * 1000.0f / (100.0f * 64.0f)));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_EQUAL(64, scheduler.pending());
+    scheduler.clear();
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bench_update_cost_is_flat);
+    RUN_TEST(test_bench_insert_cost);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Nothing to do here
+}
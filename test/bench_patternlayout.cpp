@@ -0,0 +1,206 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include "../src/core/Pattern.h"
+
+// Benchmark: track-major versus step-major Pattern storage
+//
+// Reads what Sequencer::processStep() reads on a step where every track of
+// every mode is live: for each of 15 modes (one current pattern each) the
+// step's track mask and the 8 events of that step. Per step it reports
+//  - event cache lines touched, for 32-byte lines (Cortex-M7 D-cache) and
+//    64-byte lines (host), from the addresses actually read. With a cold
+//    cache each is a miss; the M7 has no cache miss counter, so this is
+//    how its misses are counted
+//  - time with a cold cache and with a warm one: CPU cycles from the DWT
+//    cycle counter on Teensy 4.x, nanoseconds on the host
+//
+// On Teensy 4.x the patterns are placed in OCRAM (DMAMEM) and invalidated
+// from the D-cache before each cold step. The default RAM (DTCM) is not
+// cached at all, so there the layout only changes the address arithmetic.
+// On an x86 host the lines are flushed with clflush.
+//
+// Recorded results, per step:
+//   x86 host (-O1)  track-major 120 lines, cold ~2600-2780 ns, warm ~210-330 ns
+//                   step-major   15 lines, cold ~1800-1980 ns, warm ~180-270 ns
+//   Teensy 4.x      not measured yet: the Cortex-M7 cycle counts (cold and
+//                   warm, OCRAM) are still to be taken on hardware. Until
+//                   then the M7 figure is only the line count, 120 vs 15
+
+static const uint8_t MODES = 15;
+static const uint16_t COLD_ROUNDS = 20;
+static const uint16_t WARM_ROUNDS = 2000;
+
+#if defined(ARDUINO) && defined(__IMXRT1062__)
+#define PATTERN_MEMORY DMAMEM
+static const char* UNIT = "cycles";
+
+static inline uint32_t timestamp() { return ARM_DWT_CYCCNT; }
+
+static void evict(void* data, uint32_t size) {
+    arm_dcache_flush_delete(data, size);
+}
+#else
+#include <chrono>
+#define PATTERN_MEMORY
+static const char* UNIT = "ns";
+
+static inline uint32_t timestamp() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Flush the patterns' lines to memory, as arm_dcache_flush_delete() does
+static void evict(void* data, uint32_t size) {
+    for (uint32_t i = 0; i < size; i += 64) {
+        __builtin_ia32_clflush((const char*)data + i);
+    }
+    __builtin_ia32_mfence();
+}
+#else
+static uint8_t sweep[8u << 20];  // Pushes the patterns out of L1/L2
+
+static void evict(void* data, uint32_t size) {
+    (void)data;
+    (void)size;
+    for (uint32_t i = 0; i < sizeof(sweep); i += 64) {
+        sweep[i]++;
+    }
+}
+#endif
+#endif
+
+PATTERN_MEMORY static BasicPattern<TrackMajor> trackMajor[MODES];
+PATTERN_MEMORY static BasicPattern<StepMajor> stepMajor[MODES];
+static volatile uint32_t checksum;
+
+template<typename P>
+static void fill(P* patterns) {
+    for (uint8_t m = 0; m < MODES; m++) {
+        patterns[m].clear();
+        for (uint8_t t = 0; t < 8; t++) {
+            for (uint8_t s = 0; s < 16; s++) {
+                patterns[m][t][s] = Event(true, m, t, s, 64);
+            }
+        }
+    }
+}
+
+// The processStep() read pattern
+template<typename P>
+static uint32_t readStep(const P* patterns, uint8_t step) {
+    uint32_t sum = 0;
+    for (uint8_t m = 0; m < MODES; m++) {
+        const P& pattern = patterns[m];
+        uint8_t live = pattern.getStepTracks(step);
+        while (live != 0) {
+            uint8_t t = (uint8_t)__builtin_ctz(live);
+            live &= live - 1;
+            sum += pattern.getTrack(t).getEvent(step).getRaw();
+        }
+    }
+    return sum;
+}
+
+template<typename P>
+static uint8_t linesTouched(const P* patterns, uint8_t step, uintptr_t lineSize) {
+    uintptr_t lines[MODES * 8];
+    uint8_t count = 0;
+    for (uint8_t m = 0; m < MODES; m++) {
+        for (uint8_t t = 0; t < 8; t++) {
+            uintptr_t line = (uintptr_t)&patterns[m].getTrack(t).getEvent(step) / lineSize;
+            bool seen = false;
+            for (uint8_t i = 0; i < count && !seen; i++) {
+                seen = lines[i] == line;
+            }
+            if (!seen) lines[count++] = line;
+        }
+    }
+    return count;
+}
+
+struct LayoutCost {
+    float lines32;
+    float lines64;
+    float cold;  // cycles or ns per step
+    float warm;
+};
+
+template<typename P>
+static LayoutCost measure(P* patterns) {
+    LayoutCost cost = {0, 0, 0, 0};
+    const P* view = patterns;
+
+    for (uint8_t s = 0; s < 16; s++) {
+        cost.lines32 += linesTouched(view, s, 32);
+        cost.lines64 += linesTouched(view, s, 64);
+    }
+    cost.lines32 /= 16;
+    cost.lines64 /= 16;
+
+    uint32_t elapsed = 0;
+    for (uint16_t round = 0; round < COLD_ROUNDS; round++) {
+        for (uint8_t s = 0; s < 16; s++) {
+            evict(patterns, sizeof(P) * MODES);
+            uint32_t start = timestamp();
+            checksum = checksum + readStep(view, s);
+            elapsed += timestamp() - start;
+        }
+    }
+    cost.cold = (float)elapsed / (COLD_ROUNDS * 16.0f);
+
+    uint32_t start = timestamp();
+    for (uint16_t round = 0; round < WARM_ROUNDS; round++) {
+        for (uint8_t s = 0; s < 16; s++) {
+            checksum = checksum + readStep(view, s);
+        }
+    }
+    cost.warm = (float)(timestamp() - start) / (WARM_ROUNDS * 16.0f);
+    return cost;
+}
+
+static void report(const char* name, const LayoutCost& cost) {
+    char line[96];
+    snprintf(line, sizeof(line),
+             "%-11s %5.1f lines/step (32 B) %5.1f (64 B), cold %8.1f, warm %7.1f %s/step",
+             name, (double)cost.lines32, (double)cost.lines64,
+             (double)cost.cold, (double)cost.warm, UNIT);
+    TEST_MESSAGE(line);
+}
+
+void test_bench_step_read_cost_by_layout() {
+    fill(trackMajor);
+    fill(stepMajor);
+
+    // Both layouts hold the same song
+    for (uint8_t s = 0; s < 16; s++) {
+        TEST_ASSERT_EQUAL(readStep((const BasicPattern<TrackMajor>*)trackMajor, s),
+                          readStep((const BasicPattern<StepMajor>*)stepMajor, s));
+    }
+
+    LayoutCost byTrack = measure(trackMajor);
+    LayoutCost byStep = measure(stepMajor);
+    report("track-major", byTrack);
+    report("step-major", byStep);
+
+    // One line per mode instead of one per track
+    TEST_ASSERT_EQUAL(MODES * 8, (int)byTrack.lines32);
+    TEST_ASSERT_EQUAL(MODES, (int)byStep.lines32);
+    TEST_ASSERT_EQUAL(MODES, (int)byStep.lines64);
+
+    // Fewer misses may not cost more on a cold cache (plus timer noise)
+    TEST_ASSERT_TRUE(byStep.cold <= byTrack.cold * 1.2f + 100.0f);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bench_step_read_cost_by_layout);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Nothing to do here
+}
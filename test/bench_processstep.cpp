@@ -0,0 +1,146 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include "../src/core/Song.h"
+#include "../src/core/DefaultSongs.h"
+#include "../src/modes/ModeList.h"
+#include "../src/modes/Mode0_PatternSequencer.h"
+#include "../src/modes/Mode1_DrumMachine.h"
+#include "../src/modes/Mode2_AcidBass.h"
+#include "../src/modes/Mode3_EuclideanFade.h"
+#include "../src/modes/Mode4_MetaArp.h"
+#include "../src/modes/Mode5_BasslineProgression.h"
+#include "../src/sequencer/MIDIScheduler.h"
+#include "../src/sequencer/SchedulerSink.h"
+
+// Benchmark: cost of one Sequencer::processStep() visit loop
+//
+// Compares the old loop (every track of every mode, 15 x 8 reads and
+// virtual calls per step) with the occupancy loop (only the tracks whose
+// switch mask is set at the step, silent modes skipped). Both feed
+// the same scheduler, on the default song (patterns 1-12 of the demo,
+// one bar each) and on an empty song.
+
+typedef ModeList<Mode0_PatternSequencer, Mode1_DrumMachine, Mode2_AcidBass,
+                 Mode3_EuclideanFade, Mode4_MetaArp, Mode5_BasslineProgression> Modes;
+
+static const uint16_t CAPACITY = Modes::MAX_EVENTS_PER_STEP + GRUVBOK::MIDI::MAX_SCHEDULED_EVENTS;
+static const unsigned long STEP_US = 125000UL;  // 16ths at 120 BPM
+static const uint8_t ROUNDS = 20;
+
+static MIDIScheduler<CAPACITY> scheduler;
+static Song song;
+static Mode* modes[15];
+static uint16_t mismatchedBars = 0;
+
+static void visitAllTracks(uint8_t patternIndex, uint8_t step,
+                           unsigned long stepTime, SchedulerSink& sink) {
+    for (uint8_t m = 0; m < 15; m++) {
+        if (modes[m] == nullptr) continue;
+        const Pattern& pattern = song.getPattern(m, patternIndex);
+        for (uint8_t t = 0; t < Pattern::getNumTracks(); t++) {
+            sink.setOrigin(m, t);
+            modes[m]->processEvent(t, pattern[t][step], stepTime, sink);
+        }
+    }
+}
+
+static void visitLiveTracks(uint8_t patternIndex, uint8_t step,
+                            unsigned long stepTime, SchedulerSink& sink) {
+    for (uint8_t m = 0; m < 15; m++) {
+        if (modes[m] == nullptr) continue;
+        uint16_t modeBit = (uint16_t)1 << m;
+        if (Modes::SILENT_MODES & modeBit) continue;
+        uint8_t live = (Modes::IDLE_STEP_MODES & modeBit)
+            ? 0xFF : song.getLiveTracks(m, patternIndex, step);
+        if (live == 0) continue;
+        const Pattern& pattern = song.getPattern(m, patternIndex);
+        while (live != 0) {
+            uint8_t t = (uint8_t)__builtin_ctz(live);
+            live &= live - 1;
+            sink.setOrigin(m, t);
+            modes[m]->processEvent(t, pattern[t][step], stepTime, sink);
+        }
+    }
+}
+
+// Plays one bar of a pattern; returns the events and generators it left
+static uint16_t playBar(bool liveOnly, uint8_t patternIndex, unsigned long& elapsed) {
+    scheduler.clear();
+    unsigned long start = micros();
+    for (uint8_t step = 0; step < 16; step++) {
+        unsigned long stepTime = (unsigned long)step * STEP_US;
+        scheduler.beginStep(stepTime);
+        SchedulerSink sink(scheduler, stepTime);
+        if (liveOnly) {
+            visitLiveTracks(patternIndex, step, stepTime, sink);
+        } else {
+            visitAllTracks(patternIndex, step, stepTime, sink);
+        }
+    }
+    elapsed += micros() - start;
+    return scheduler.pending() + scheduler.getActiveGenerators();
+}
+
+// ns per step over patterns first..last; both loops must schedule the same
+static float measureStepCost(bool liveOnly, uint8_t first, uint8_t last) {
+    unsigned long elapsed = 0;
+    for (uint8_t round = 0; round < ROUNDS; round++) {
+        for (uint8_t p = first; p <= last; p++) {
+            unsigned long ignored = 0;
+            uint16_t expected = playBar(!liveOnly, p, ignored);
+            if (playBar(liveOnly, p, elapsed) != expected) mismatchedBars++;
+        }
+    }
+    uint32_t steps = (uint32_t)ROUNDS * (last - first + 1) * 16;
+    return (float)elapsed * 1000.0f / steps;
+}
+
+static void report(const char* name, float allCost, float liveCost) {
+    char line[80];
+    snprintf(line, sizeof(line), "%-8s all tracks %8.1f ns/step, live only %8.1f ns/step",
+             name, (double)allCost, (double)liveCost);
+    TEST_MESSAGE(line);
+}
+
+void test_bench_step_cost_default_song() {
+    DefaultSongs::loadDemoSong(song);
+    float allCost = measureStepCost(false, 1, 12);
+    float liveCost = measureStepCost(true, 1, 12);
+    report("default", allCost, liveCost);
+    TEST_ASSERT_EQUAL(0, mismatchedBars);
+
+    // Skipping empty tracks may not make a step slower (plus timer noise)
+    TEST_ASSERT_TRUE(liveCost <= allCost + 200.0f);
+}
+
+void test_bench_step_cost_empty_song() {
+    DefaultSongs::loadEmpty(song);
+    float allCost = measureStepCost(false, 0, 0);
+    float liveCost = measureStepCost(true, 0, 0);
+    report("empty", allCost, liveCost);
+    TEST_ASSERT_EQUAL(0, mismatchedBars);
+
+    // Only Mode2's idle steps are left: well under half the full scan
+    TEST_ASSERT_TRUE(liveCost * 2.0f <= allCost + 200.0f);
+}
+
+void setup() {
+    Modes::create(modes);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bench_step_cost_default_song);
+    RUN_TEST(test_bench_step_cost_empty_song);
+
+    UNITY_END();
+
+    for (uint8_t i = 0; i < Modes::COUNT; i++) {
+        delete modes[i];
+        modes[i] = nullptr;
+    }
+}
+
+void loop() {
+    // Nothing to do here
+}
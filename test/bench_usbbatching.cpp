@@ -0,0 +1,168 @@
+#include <unity.h>
+#include <stdio.h>
+#include "../src/sequencer/MIDIDispatcher.h"
+#include "../src/sequencer/MIDIEncoding.h"
+
+// Benchmark: USB transfers and output latency, one flush per message versus
+// one flush per dispatch tick
+//
+// Fake USB sink: writes go to a transmit buffer and flush() queues the
+// buffer as one transfer. The host takes one transfer per 125 us
+// microframe (high speed bulk endpoint, simplified), so every flush costs
+// a microframe and messages queued behind other transfers wait for theirs.
+// Latency = microframe that carries a message - its due time.
+
+static const uint32_t MICROFRAME_US = 125;
+static const uint32_t STEP_US = 125000;          // 120 BPM
+static const uint8_t STEPS = 16;
+
+struct FakeUsbSink {
+    uint32_t now;                // Time of the current dispatch interrupt
+    uint32_t nextFrame;          // First microframe not yet taken
+    uint32_t buffered[64];       // Due times of written, unflushed packets
+    uint8_t bufferedCount;
+
+    uint32_t frames;
+    uint32_t messages;
+    uint8_t maxPerFrame;
+    uint64_t totalLatency;
+    uint32_t maxLatency;
+
+    void reset() {
+        now = 0;
+        nextFrame = 0;
+        bufferedCount = 0;
+        frames = 0;
+        messages = 0;
+        maxPerFrame = 0;
+        totalLatency = 0;
+        maxLatency = 0;
+    }
+
+    void write(const MIDIMessage& msg) {
+        (void)MIDIEncoding::usbPacket(msg);
+        if (bufferedCount < 64) buffered[bufferedCount++] = msg.time;
+    }
+
+    void flush() {
+        if (bufferedCount == 0) return;
+
+        uint32_t frame = ((now + MICROFRAME_US - 1) / MICROFRAME_US) * MICROFRAME_US;
+        if (frame < nextFrame) frame = nextFrame;
+        nextFrame = frame + MICROFRAME_US;
+
+        frames++;
+        messages += bufferedCount;
+        if (bufferedCount > maxPerFrame) maxPerFrame = bufferedCount;
+        for (uint8_t i = 0; i < bufferedCount; i++) {
+            uint32_t latency = frame - buffered[i];
+            totalLatency += latency;
+            if (latency > maxLatency) maxLatency = latency;
+        }
+        bufferedCount = 0;
+    }
+};
+
+static FakeUsbSink sink;
+
+// Before: every message is its own USB transfer
+static void perMessageOutput(const MIDIMessage* messages, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        sink.write(messages[i]);
+        sink.flush();
+    }
+}
+
+// After: the tick's messages are packed back to back and flushed once
+static void batchedOutput(const MIDIMessage* messages, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        sink.write(messages[i]);
+    }
+    sink.flush();
+}
+
+static void note(MIDIDispatcher& dispatcher, uint32_t time, uint8_t channel,
+                 uint8_t pitch, uint32_t length) {
+    dispatcher.post(MIDIMessage::channelMessage(time, 0x90, channel, pitch, 100));
+    dispatcher.post(MIDIMessage::channelMessage(time + length, 0x80, channel, pitch, 0));
+}
+
+// A busy step: 8 drum hits, bass with two CCs, a 4-note arp, 3 echoes
+static void postBusyStep(MIDIDispatcher& dispatcher, uint32_t stepTime, uint8_t step) {
+    for (uint8_t i = 0; i < 8; i++) {
+        note(dispatcher, stepTime, 2, 36 + i, 50000);
+    }
+    dispatcher.post(MIDIMessage::channelMessage(stepTime, 0xB0, 3, 65, step & 1 ? 127 : 0));
+    dispatcher.post(MIDIMessage::channelMessage(stepTime, 0xB0, 3, 5, step * 8));
+    note(dispatcher, stepTime, 3, 36 + step % 12, 100000);
+    for (uint8_t i = 0; i < 4; i++) {
+        note(dispatcher, stepTime + i * (STEP_US / 4), 5, 60 + i * 4, 20000);
+    }
+    for (uint8_t i = 1; i <= 3; i++) {
+        note(dispatcher, stepTime + i * 15000, 4, 72, 10000);
+    }
+}
+
+static void runSong(MIDIDispatcher& dispatcher) {
+    dispatcher.setCCFilter(MIDIDispatcher::CC_PASS_ALL);
+    sink.reset();
+
+    uint32_t end = (STEPS + 1) * STEP_US;
+    uint8_t step = 0;
+    for (uint32_t now = 0; now < end; now += 100) {
+        if (step < STEPS && now == step * STEP_US) {
+            postBusyStep(dispatcher, now, step);
+            step++;
+        }
+        sink.now = now;
+        dispatcher.onInterrupt(now);
+    }
+}
+
+void test_bench_usb_batching() {
+    static MIDIDispatcher perMessage(perMessageOutput);
+    static MIDIDispatcher perTick(batchedOutput);
+    char line[112];
+
+    runSong(perMessage);
+    FakeUsbSink before = sink;
+    runSong(perTick);
+    FakeUsbSink after = sink;
+
+    TEST_ASSERT_EQUAL(before.messages, after.messages);
+
+    snprintf(line, sizeof(line), "per message: %4u transfers, %5.2f msg/frame (max %2u), latency avg %6.1f us max %5u us",
+             (unsigned)before.frames, (double)before.messages / before.frames, before.maxPerFrame,
+             (double)before.totalLatency / before.messages, (unsigned)before.maxLatency);
+    TEST_MESSAGE(line);
+    snprintf(line, sizeof(line), "per tick:    %4u transfers, %5.2f msg/frame (max %2u), latency avg %6.1f us max %5u us",
+             (unsigned)after.frames, (double)after.messages / after.frames, after.maxPerFrame,
+             (double)after.totalLatency / after.messages, (unsigned)after.maxLatency);
+    TEST_MESSAGE(line);
+
+    TEST_ASSERT_TRUE(after.frames < before.frames);
+    TEST_ASSERT_TRUE(after.maxLatency <= before.maxLatency);
+    TEST_ASSERT_TRUE(after.totalLatency <= before.totalLatency);
+}
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bench_usb_batching);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,135 @@
+#include <unity.h>
+#include "../src/sequencer/BandwidthGovernor.h"
+
+void test_burst_then_budget() {
+    BandwidthGovernor governor(4, 8);
+
+    // A full bucket lets one burst through back to back
+    for (uint8_t i = 0; i < 8; i++) {
+        TEST_ASSERT_TRUE(governor.tryTake(1000));
+    }
+    TEST_ASSERT_FALSE(governor.tryTake(1000));
+
+    // Then the budget rate: 4 per ms, refilled from microseconds
+    TEST_ASSERT_FALSE(governor.tryTake(1249));
+    TEST_ASSERT_TRUE(governor.tryTake(1250));
+    TEST_ASSERT_FALSE(governor.tryTake(1250));
+    uint8_t sent = 0;
+    for (uint32_t t = 1300; t <= 2250; t += 50) {
+        if (governor.tryTake(t)) sent++;
+    }
+    TEST_ASSERT_EQUAL(4, sent);
+}
+
+void test_forced_messages_use_the_budget() {
+    BandwidthGovernor governor(1, 2);
+
+    // Clock and notes always go out, even into debt
+    for (uint8_t i = 0; i < 5; i++) {
+        governor.take(0);
+    }
+    TEST_ASSERT_FALSE(governor.tryTake(0));
+
+    // Debt is bounded at one burst: 2 ms to repay, then 1 ms per token
+    TEST_ASSERT_FALSE(governor.tryTake(2999));
+    TEST_ASSERT_TRUE(governor.tryTake(3000));
+}
+
+void test_bucket_is_capped_after_idle_time() {
+    BandwidthGovernor governor(16, 4);
+    governor.take(0);
+
+    // A long pause never saves up more than one burst
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(governor.tryTake(10000000));
+    }
+    TEST_ASSERT_FALSE(governor.tryTake(10000000));
+}
+
+void test_zero_budget_is_unlimited() {
+    BandwidthGovernor governor(0, 1);
+    for (uint16_t i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(governor.tryTake(0));
+    }
+}
+
+void test_refill_across_timer_wrap() {
+    BandwidthGovernor governor(1, 1);
+    uint32_t start = 0xFFFFFE00;
+
+    TEST_ASSERT_TRUE(governor.tryTake(start));
+    TEST_ASSERT_FALSE(governor.tryTake(start + 999));
+    TEST_ASSERT_TRUE(governor.tryTake(start + 1000));  // micros() wrapped
+}
+
+void test_earlier_timestamp_adds_no_tokens() {
+    BandwidthGovernor governor(1, 2);
+    governor.take(5000);
+    governor.take(5000);
+
+    // A message stamped just before the last refill must not read as
+    // 71 minutes of refill
+    governor.take(4990);
+    TEST_ASSERT_FALSE(governor.tryTake(4995));
+
+    // It still took its token: one in debt, refilled at 1 per ms
+    TEST_ASSERT_FALSE(governor.tryTake(6999));
+    TEST_ASSERT_TRUE(governor.tryTake(7000));
+    TEST_ASSERT_FALSE(governor.tryTake(7000));
+}
+
+void test_rate_window() {
+    BandwidthGovernor governor(0, 1);
+
+    governor.take(0);
+    governor.tryTake(500);
+    governor.take(999);
+    TEST_ASSERT_EQUAL(3, governor.getWindowCount());
+
+    // A new millisecond starts a new count
+    governor.take(1000);
+    TEST_ASSERT_EQUAL(1, governor.getWindowCount());
+}
+
+void test_set_budget_refills() {
+    BandwidthGovernor governor(1, 1);
+    TEST_ASSERT_TRUE(governor.tryTake(0));
+    TEST_ASSERT_FALSE(governor.tryTake(0));
+
+    governor.setBudget(8, 3);
+    TEST_ASSERT_EQUAL(8, governor.getBudget());
+    TEST_ASSERT_EQUAL(3, governor.getBurst());
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_TRUE(governor.tryTake(0));
+    }
+    TEST_ASSERT_FALSE(governor.tryTake(0));
+}
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_burst_then_budget);
+    RUN_TEST(test_forced_messages_use_the_budget);
+    RUN_TEST(test_bucket_is_capped_after_idle_time);
+    RUN_TEST(test_zero_budget_is_unlimited);
+    RUN_TEST(test_refill_across_timer_wrap);
+    RUN_TEST(test_earlier_timestamp_adds_no_tokens);
+    RUN_TEST(test_rate_window);
+    RUN_TEST(test_set_budget_refills);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,172 @@
+#include <unity.h>
+#include "../src/sequencer/CatchUpPlanner.h"
+
+using namespace GRUVBOK::Timing;
+
+// Five steps 18750 us apart (800 BPM), picked up well after the last one
+static const uint32_t STEP = 18750;
+static const uint32_t START = 1000000;
+static uint32_t times[5];
+static uint32_t now;
+
+static void makeBacklog() {
+    for (uint8_t i = 0; i < 5; i++) {
+        times[i] = START + i * STEP;
+    }
+    now = times[4] + 500;  // Newest step is only slightly late
+}
+
+void test_single_late_step_is_not_a_stall() {
+    CatchUpPlanner planner;
+    uint32_t t = START;
+    planner.beginBatch(&t, 1, START + STALL_THRESHOLD_US * 3);
+
+    uint32_t base = 0;
+    TEST_ASSERT_TRUE(planner.planStep(0, base));
+    TEST_ASSERT_EQUAL_UINT32(START, base);
+    TEST_ASSERT_EQUAL(0, planner.getMissedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, planner.getStats().stalls);
+}
+
+void test_steps_within_threshold_are_not_missed() {
+    CatchUpPlanner planner;
+    uint32_t t[2] = {START, START + 2000};
+    planner.beginBatch(t, 2, START + STALL_THRESHOLD_US);
+
+    TEST_ASSERT_EQUAL(0, planner.getMissedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, planner.getStats().stalls);
+}
+
+void test_replay_all_keeps_logical_times() {
+    CatchUpPlanner planner;
+    planner.setPolicy(CatchUpPlanner::REPLAY_ALL);
+    makeBacklog();
+    planner.beginBatch(times, 5, now);
+
+    for (uint8_t i = 0; i < 5; i++) {
+        uint32_t base = 0;
+        TEST_ASSERT_TRUE(planner.planStep(i, base));
+        TEST_ASSERT_EQUAL_UINT32(times[i], base);
+    }
+    TEST_ASSERT_EQUAL(4, planner.getMissedCount());
+    TEST_ASSERT_EQUAL_UINT32(4, planner.getStats().stepsReplayed);
+}
+
+void test_skip_to_now_drops_missed_steps() {
+    CatchUpPlanner planner;
+    planner.setPolicy(CatchUpPlanner::SKIP_TO_NOW);
+    makeBacklog();
+    planner.beginBatch(times, 5, now);
+
+    uint32_t base = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_FALSE(planner.planStep(i, base));
+    }
+    TEST_ASSERT_TRUE(planner.planStep(4, base));
+    TEST_ASSERT_EQUAL_UINT32(times[4], base);
+    TEST_ASSERT_EQUAL_UINT32(4, planner.getStats().stepsSkipped);
+}
+
+void test_compress_spreads_missed_steps_over_window() {
+    CatchUpPlanner planner;
+    planner.setPolicy(CatchUpPlanner::COMPRESS);
+    makeBacklog();
+    planner.beginBatch(times, 5, now);
+
+    uint32_t previous = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        uint32_t base = 0;
+        TEST_ASSERT_TRUE(planner.planStep(i, base));
+        TEST_ASSERT_TRUE(base >= now);
+        TEST_ASSERT_TRUE(base - now < CATCHUP_WINDOW_US);
+        if (i > 0) TEST_ASSERT_TRUE(base > previous);
+        previous = base;
+    }
+
+    // The current step ends the roll
+    uint32_t base = 0;
+    TEST_ASSERT_TRUE(planner.planStep(4, base));
+    TEST_ASSERT_TRUE(base > previous);
+    TEST_ASSERT_TRUE(base - now <= CATCHUP_WINDOW_US);
+    TEST_ASSERT_EQUAL_UINT32(4, planner.getStats().stepsCompressed);
+}
+
+void test_compress_keeps_step_order() {
+    CatchUpPlanner planner;
+    planner.setPolicy(CatchUpPlanner::COMPRESS);
+    makeBacklog();
+    planner.beginBatch(times, 5, now);
+
+    // Missed steps, then the current one, in order, none in the past
+    uint32_t previous = now;
+    for (uint8_t i = 0; i < 5; i++) {
+        uint32_t base = 0;
+        TEST_ASSERT_TRUE(planner.planStep(i, base));
+        TEST_ASSERT_TRUE((int32_t)(base - previous) >= (i == 0 ? 0 : 1));
+        previous = base;
+    }
+
+    // The roll is cut short so the next step (picked up on time, in the
+    // next batch) still comes after it
+    uint32_t next = times[4] + STEP;
+    TEST_ASSERT_TRUE((int32_t)(next - previous) > 0);
+    planner.beginBatch(&next, 1, next + 100);
+    uint32_t base = 0;
+    TEST_ASSERT_TRUE(planner.planStep(0, base));
+    TEST_ASSERT_TRUE((int32_t)(base - previous) > 0);
+}
+
+void test_stall_statistics() {
+    CatchUpPlanner planner;
+    makeBacklog();
+    planner.beginBatch(times, 5, now);
+    planner.beginBatch(times + 3, 2, times[4] + 1000);
+
+    const CatchUpPlanner::Stats& stats = planner.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.stalls);
+    TEST_ASSERT_EQUAL_UINT32(now - times[0], stats.longestStall);
+    TEST_ASSERT_EQUAL_UINT32(5, stats.stepsSkipped);
+
+    planner.resetStats();
+    TEST_ASSERT_EQUAL_UINT32(0, planner.getStats().stalls);
+    TEST_ASSERT_EQUAL_UINT32(0, planner.getStats().longestStall);
+    TEST_ASSERT_EQUAL_UINT32(0, planner.getStats().stepsSkipped);
+}
+
+void test_stall_across_timer_wrap() {
+    CatchUpPlanner planner;
+    uint32_t t[3] = {0xFFFF0000UL, 0xFFFF0000UL + STEP, 0xFFFF0000UL + 2 * STEP};
+    planner.beginBatch(t, 3, t[2] + 100);
+
+    TEST_ASSERT_EQUAL(2, planner.getMissedCount());
+    TEST_ASSERT_EQUAL_UINT32(2 * STEP + 100, planner.getStats().longestStall);
+}
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_single_late_step_is_not_a_stall);
+    RUN_TEST(test_steps_within_threshold_are_not_missed);
+    RUN_TEST(test_replay_all_keeps_logical_times);
+    RUN_TEST(test_skip_to_now_drops_missed_steps);
+    RUN_TEST(test_compress_spreads_missed_steps_over_window);
+    RUN_TEST(test_compress_keeps_step_order);
+    RUN_TEST(test_stall_statistics);
+    RUN_TEST(test_stall_across_timer_wrap);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,197 @@
+#include <unity.h>
+#include "../src/sequencer/MasterClock.h"
+#include "../src/core/MIDIEvent.h"
+#include "../src/modes/Mode5_BasslineProgression.h"
+
+using namespace GRUVBOK::Timing;
+
+// Run the clock for 'duration' us, polling every 'poll' us
+struct TickLog {
+    uint16_t steps;
+    uint16_t pulses;
+    uint32_t lastStepTime;
+    uint32_t lastPulseTime;
+    bool stepOffGrid;
+};
+
+static TickLog runClock(MasterClock& clock, uint32_t start, uint32_t duration, uint32_t poll) {
+    TickLog log = {0, 0, 0, 0, false};
+    for (uint32_t t = start; t - start <= duration; t += poll) {
+        while (clock.due(t)) {
+            clock.advance();
+            if (clock.isClockTick()) {
+                log.pulses++;
+                log.lastPulseTime = clock.getTickTime();
+            }
+            if (clock.isStepTick()) {
+                log.steps++;
+                log.lastStepTime = clock.getTickTime();
+                // Every step must also be a clock pulse
+                if (!clock.isClockTick()) log.stepOffGrid = true;
+            }
+        }
+    }
+    return log;
+}
+
+void test_master_tick_resolution() {
+    TEST_ASSERT_EQUAL(96, MasterClock::PPQN);
+    TEST_ASSERT_EQUAL(24, MasterClock::TICKS_PER_STEP);
+    TEST_ASSERT_EQUAL(4, MasterClock::TICKS_PER_CLOCK);
+}
+
+void test_six_pulses_per_step() {
+    MasterClock clock;
+    clock.setTempo(120.0f);
+    clock.reset(0);
+
+    // 1 second at 120 BPM = 2 beats = 8 steps = 48 pulses
+    TickLog log = runClock(clock, 0, 1000000, 100);
+    TEST_ASSERT_EQUAL(8, log.steps);
+    TEST_ASSERT_EQUAL(48, log.pulses);
+    TEST_ASSERT_FALSE(log.stepOffGrid);
+    TEST_ASSERT_EQUAL(1000000UL, log.lastStepTime);
+}
+
+void test_clock_and_steps_phase_locked() {
+    const float tempos[] = {20.0f, 97.0f, 133.0f, 800.0f};
+
+    for (uint8_t i = 0; i < 4; i++) {
+        MasterClock clock;
+        clock.setTempo(tempos[i]);
+        clock.reset(1000);
+
+        TickLog log = runClock(clock, 1000, 30000000UL, 37);
+        TEST_ASSERT_FALSE(log.stepOffGrid);
+        TEST_ASSERT_TRUE(log.steps > 0);
+        TEST_ASSERT_EQUAL(log.steps, log.pulses / 6);
+
+        // Last step was a pulse too, at the same instant
+        if (log.pulses % 6 == 0) {
+            TEST_ASSERT_EQUAL(log.lastStepTime, log.lastPulseTime);
+        }
+
+        // No drift against the ideal step period
+        double ideal = 1000.0 + (double)log.steps * MICROS_PER_MINUTE / tempos[i] / STEPS_PER_BEAT;
+        double error = (double)log.lastStepTime - ideal;
+        TEST_ASSERT_TRUE(error > -2.0 && error < 2.0);
+    }
+}
+
+void test_first_step_one_step_after_reset() {
+    MasterClock clock;
+    clock.setTempo(120.0f);
+    clock.reset(0);
+
+    TickLog early = runClock(clock, 0, 124999, 1);
+    TEST_ASSERT_EQUAL(0, early.steps);
+    TEST_ASSERT_EQUAL(5, early.pulses);  // 20833 us per pulse
+
+    TEST_ASSERT_TRUE(clock.due(125000));
+    clock.advance();
+    TEST_ASSERT_TRUE(clock.isStepTick());
+    TEST_ASSERT_EQUAL(24, clock.getTick());
+}
+
+void test_jitter_bounded_by_poll_gap() {
+    // Simulated polled loop with irregular gaps (1-60 us per iteration)
+    MasterClock clock;
+    clock.setTempo(800.0f);
+    clock.reset(0);
+
+    uint32_t now = 0;
+    uint32_t rng = 42;
+    double worst = 0.0;
+
+    while (clock.getTick() < 20000) {
+        rng = rng * 1664525UL + 1013904223UL;
+        now += 1 + (rng >> 24) % 60;
+
+        while (clock.due(now)) {
+            clock.advance();
+            double ideal = MICROS_PER_MINUTE / 800.0 / MasterClock::PPQN * clock.getTick();
+            double jitter = (double)now - ideal;
+            if (jitter < 0) jitter = -jitter;
+            if (jitter > worst) worst = jitter;
+        }
+    }
+
+    // Bounded by the poll gap, never accumulating
+    TEST_ASSERT_TRUE(worst < 100.0);
+}
+
+void test_tempo_change_applies_to_pending_tick() {
+    MasterClock clock;
+    clock.setTempo(120.0f);  // 5208.3 us per tick
+    clock.reset(0);
+
+    clock.setTempo(240.0f);  // 2604.2 us per tick
+    TEST_ASSERT_FALSE(clock.due(2604));
+    TEST_ASSERT_TRUE(clock.due(2605));
+}
+
+void test_wraps_32_bit_clock() {
+    MasterClock clock;
+    clock.setTempo(120.0f);
+    clock.reset(0xFFFFFFFFUL - 1000);
+
+    for (uint8_t i = 0; i < MasterClock::TICKS_PER_STEP; i++) {
+        TEST_ASSERT_TRUE(clock.due(125000UL));
+        clock.advance();
+    }
+    TEST_ASSERT_FALSE(clock.due(125000UL));
+    TEST_ASSERT_EQUAL(123999UL, clock.getTickTime());
+}
+
+void test_buffer_ticks_follow_tempo() {
+    MIDIEventBuffer<> buffer;
+
+    // Default tempo (120 BPM): one step = 125 ms
+    TEST_ASSERT_EQUAL(125000UL, buffer.ticks(TICKS_PER_STEP));
+    TEST_ASSERT_EQUAL(62500UL, buffer.ticks(TICKS_PER_STEP / 2));
+
+    // 240 BPM: half as long
+    buffer.setBeatInterval(calculateBeatInterval(240.0f));
+    TEST_ASSERT_EQUAL(62500UL, buffer.ticks(TICKS_PER_STEP));
+
+    // 20 BPM, long echo tails do not overflow
+    buffer.setBeatInterval(calculateBeatInterval(20.0f));
+    TEST_ASSERT_EQUAL(750000UL * 127UL * 16UL, buffer.ticks(TICKS_PER_STEP * 127UL * 16UL));
+}
+
+void test_mode5_offbeat_lands_on_tick_grid() {
+    Mode5_BasslineProgression mode(6);
+    Event event;
+    event.setSwitch(true);
+    event.setPot(0, 64);
+    event.setPot(1, 0);
+    event.setPot(2, 20);   // Root + Fifth: fifth on the half step
+    event.setPot(3, 0);
+
+    MIDIEventBuffer<> buffer;
+    buffer.setBeatInterval(calculateBeatInterval(150.0f));  // 100 ms steps
+    mode.processEvent(0, event, 0, buffer);
+
+    TEST_ASSERT_EQUAL(4, buffer.size());
+    TEST_ASSERT_EQUAL(50000UL, buffer[2].delta);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_master_tick_resolution);
+    RUN_TEST(test_six_pulses_per_step);
+    RUN_TEST(test_clock_and_steps_phase_locked);
+    RUN_TEST(test_first_step_one_step_after_reset);
+    RUN_TEST(test_jitter_bounded_by_poll_gap);
+    RUN_TEST(test_tempo_change_applies_to_pending_tick);
+    RUN_TEST(test_wraps_32_bit_clock);
+    RUN_TEST(test_buffer_ticks_follow_tempo);
+    RUN_TEST(test_mode5_offbeat_lands_on_tick_grid);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Nothing to do here
+}
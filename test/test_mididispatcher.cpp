@@ -0,0 +1,454 @@
+#include <unity.h>
+#include "../src/sequencer/MIDIDispatcher.h"
+
+#ifndef ARDUINO
+#include <atomic>
+#include <chrono>
+#include <thread>
+#endif
+
+// Recording output (called from the consumer side only)
+static const uint16_t LOG_SIZE = 512;
+static MIDIMessage sentLog[LOG_SIZE];
+static uint16_t sentCount = 0;
+static uint16_t batchCount = 0;
+
+static void recordOutput(const MIDIMessage* messages, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (sentCount < LOG_SIZE) sentLog[sentCount++] = messages[i];
+    }
+    batchCount++;
+}
+
+static void resetLog() {
+    sentCount = 0;
+    batchCount = 0;
+}
+
+static MIDIMessage noteAt(uint32_t time, uint8_t note) {
+    return MIDIMessage::channelMessage(time, 0x90, 1, note, 100);
+}
+
+void test_message_encoding() {
+    MIDIMessage msg = MIDIMessage::channelMessage(0, 0x90, 10, 36, 127);
+    TEST_ASSERT_EQUAL(0x99, msg.status);
+    TEST_ASSERT_EQUAL(0x90, msg.getType());
+    TEST_ASSERT_EQUAL(10, msg.getChannel());
+    TEST_ASSERT_FALSE(msg.isRealTime());
+    TEST_ASSERT_TRUE(MIDIMessage::realTime(0, 0xF8).isRealTime());
+}
+
+void test_sends_only_due_messages_in_time_order() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+
+    dispatcher.post(noteAt(300, 3));
+    dispatcher.post(noteAt(100, 1));
+    dispatcher.post(noteAt(200, 2));
+    dispatcher.post(noteAt(100, 11));  // Same time as note 1, posted later
+
+    dispatcher.onInterrupt(99);
+    TEST_ASSERT_EQUAL(0, sentCount);
+    TEST_ASSERT_EQUAL(4, dispatcher.getPendingCount());
+
+    dispatcher.onInterrupt(200);
+    TEST_ASSERT_EQUAL(3, sentCount);
+    TEST_ASSERT_EQUAL(1, sentLog[0].data1);
+    TEST_ASSERT_EQUAL(11, sentLog[1].data1);
+    TEST_ASSERT_EQUAL(2, sentLog[2].data1);
+    TEST_ASSERT_EQUAL(1, batchCount);  // One output call for the batch
+
+    dispatcher.onInterrupt(300);
+    TEST_ASSERT_EQUAL(4, sentCount);
+    TEST_ASSERT_EQUAL(3, sentLog[3].data1);
+    TEST_ASSERT_EQUAL(0, dispatcher.getPendingCount());
+}
+
+void test_early_post_does_not_block_due_message() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+
+    dispatcher.post(noteAt(5000, 1));  // Posted ahead of time
+    dispatcher.onInterrupt(1000);
+    dispatcher.post(noteAt(1000, 2));  // Due now, posted after
+    dispatcher.onInterrupt(1000);
+
+    TEST_ASSERT_EQUAL(1, sentCount);
+    TEST_ASSERT_EQUAL(2, sentLog[0].data1);
+}
+
+void test_full_pending_list_does_not_block_due_message() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+
+    for (uint8_t i = 0; i < MIDIDispatcher::PENDING_SIZE; i++) {
+        dispatcher.post(noteAt(5000 + i, 1));  // Fills the sorted list
+    }
+    dispatcher.post(noteAt(9000, 3));        // Furthest future, still in the ring
+    dispatcher.onInterrupt(1000);
+    TEST_ASSERT_EQUAL(MIDIDispatcher::PENDING_SIZE, dispatcher.getPendingCount());
+    TEST_ASSERT_EQUAL(1, dispatcher.getEvictedCount());
+
+    dispatcher.post(noteAt(1000, 2));  // Due now, posted after
+    dispatcher.onInterrupt(1000);
+    TEST_ASSERT_EQUAL(1, sentCount);
+    TEST_ASSERT_EQUAL(2, sentLog[0].data1);
+    TEST_ASSERT_EQUAL(2, dispatcher.getEvictedCount());  // The last early post made room
+
+    // The earliest PENDING_SIZE - 1 early posts still go out
+    dispatcher.onInterrupt(6000);
+    TEST_ASSERT_EQUAL(MIDIDispatcher::PENDING_SIZE, sentCount);
+    TEST_ASSERT_EQUAL(0, dispatcher.getPendingCount());
+}
+
+void test_wrap_safe_due_check() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+
+    dispatcher.post(noteAt(0x00000010UL, 2));
+    dispatcher.post(noteAt(0xFFFFFFF0UL, 1));
+
+    dispatcher.onInterrupt(0xFFFFFFFFUL);
+    TEST_ASSERT_EQUAL(1, sentCount);
+    TEST_ASSERT_EQUAL(1, sentLog[0].data1);
+
+    dispatcher.onInterrupt(0x00000010UL);
+    TEST_ASSERT_EQUAL(2, sentCount);
+}
+
+void test_overflow_and_max_fill() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+
+    for (uint16_t i = 0; i < MIDIDispatcher::getCapacity() + 3; i++) {
+        dispatcher.post(noteAt(i, i & 0x7F));
+    }
+    TEST_ASSERT_EQUAL(3, dispatcher.getOverflowCount());
+    TEST_ASSERT_EQUAL(MIDIDispatcher::getCapacity(), dispatcher.getMaxFill());
+    TEST_ASSERT_FALSE(dispatcher.hasSpace());
+
+    // Draining frees the ring; statistics stay until reset
+    dispatcher.onInterrupt(1000);
+    dispatcher.onInterrupt(1000);
+    TEST_ASSERT_EQUAL(MIDIDispatcher::getCapacity(), sentCount);
+    TEST_ASSERT_TRUE(dispatcher.hasSpace());
+    TEST_ASSERT_EQUAL(3, dispatcher.getOverflowCount());
+
+    dispatcher.resetStats();
+    TEST_ASSERT_EQUAL(0, dispatcher.getOverflowCount());
+    TEST_ASSERT_EQUAL(0, dispatcher.getMaxFill());
+}
+
+static MIDIMessage ccAt(uint32_t time, uint8_t channel, uint8_t controller, uint8_t value) {
+    return MIDIMessage::channelMessage(time, 0xB0, channel, controller, value);
+}
+
+void test_duplicate_ccs_are_dropped() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+
+    dispatcher.post(ccAt(10, 3, 65, 100));
+    dispatcher.post(ccAt(20, 3, 65, 100));   // Repeat: dropped
+    dispatcher.post(ccAt(30, 4, 65, 100));   // Other channel
+    dispatcher.post(ccAt(40, 3, 5, 100));    // Other controller
+    dispatcher.post(ccAt(50, 3, 65, 90));    // New value
+    dispatcher.post(ccAt(60, 3, 123, 0));    // All notes off: never cached
+    dispatcher.post(ccAt(70, 3, 123, 0));
+    dispatcher.onInterrupt(100);
+
+    TEST_ASSERT_EQUAL(6, sentCount);
+    TEST_ASSERT_EQUAL(1, dispatcher.getSuppressedCCCount());
+    TEST_ASSERT_EQUAL(90, sentLog[3].data2);
+
+    // Forgetting the cache lets the same value through again
+    dispatcher.invalidateControllerCache();
+    dispatcher.post(ccAt(200, 3, 65, 90));
+    dispatcher.onInterrupt(200);
+    TEST_ASSERT_EQUAL(7, sentCount);
+
+    // Reset all controllers forgets the channel
+    dispatcher.post(ccAt(300, 3, 121, 0));
+    dispatcher.post(ccAt(301, 3, 65, 90));
+    dispatcher.onInterrupt(301);
+    TEST_ASSERT_EQUAL(9, sentCount);
+}
+
+void test_cc_filter_can_be_disabled() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+    dispatcher.setCCFilter(MIDIDispatcher::CC_PASS_ALL);
+
+    dispatcher.post(ccAt(10, 2, 10, 64));
+    dispatcher.post(ccAt(20, 2, 10, 64));
+    dispatcher.onInterrupt(100);
+    TEST_ASSERT_EQUAL(2, sentCount);
+    TEST_ASSERT_EQUAL(0, dispatcher.getSuppressedCCCount());
+}
+
+void test_ccs_coalesce_within_one_tick() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+    dispatcher.setCCFilter(MIDIDispatcher::CC_DROP_DUPLICATES | MIDIDispatcher::CC_COALESCE);
+
+    dispatcher.post(ccAt(10, 2, 20, 1));
+    dispatcher.post(noteAt(20, 36));
+    dispatcher.post(ccAt(30, 2, 20, 2));
+    dispatcher.post(ccAt(40, 2, 21, 7));
+    dispatcher.post(ccAt(50, 2, 20, 3));     // Last value wins
+    dispatcher.onInterrupt(100);
+
+    TEST_ASSERT_EQUAL(3, sentCount);
+    TEST_ASSERT_EQUAL(36, sentLog[0].data1);
+    TEST_ASSERT_EQUAL(21, sentLog[1].data1);
+    TEST_ASSERT_EQUAL(3, sentLog[2].data2);
+    TEST_ASSERT_EQUAL(2, dispatcher.getCoalescedCCCount());
+
+    // Separate ticks are not coalesced, and scratch state is clean
+    dispatcher.post(ccAt(200, 2, 20, 4));
+    dispatcher.onInterrupt(200);
+    dispatcher.post(ccAt(300, 2, 20, 5));
+    dispatcher.onInterrupt(300);
+    TEST_ASSERT_EQUAL(5, sentCount);
+
+    dispatcher.resetStats();
+    TEST_ASSERT_EQUAL(0, dispatcher.getCoalescedCCCount());
+}
+
+void test_ccs_over_budget_are_deferred_then_thinned() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+    dispatcher.setBandwidth(1, 2);  // 1 message per ms, burst of 2
+
+    dispatcher.post(ccAt(0, 1, 10, 1));
+    dispatcher.post(ccAt(0, 1, 11, 1));
+    dispatcher.post(ccAt(0, 1, 12, 1));     // Over budget: deferred
+    dispatcher.post(noteAt(0, 36));         // Notes always go out
+    dispatcher.onInterrupt(0);
+    TEST_ASSERT_EQUAL(3, sentCount);
+    TEST_ASSERT_EQUAL(1, dispatcher.getDeferredCCCount());
+    TEST_ASSERT_EQUAL(1, dispatcher.getDeferredCount());
+
+    // A newer value for the deferred controller replaces it
+    dispatcher.post(ccAt(100, 1, 12, 2));
+    dispatcher.onInterrupt(100);
+    TEST_ASSERT_EQUAL(3, sentCount);
+    TEST_ASSERT_EQUAL(1, dispatcher.getThinnedCCCount());
+    TEST_ASSERT_EQUAL(1, dispatcher.getDeferredCount());
+
+    // The note took a token too: budget is back after 2 ms
+    dispatcher.onInterrupt(1000);
+    TEST_ASSERT_EQUAL(3, sentCount);
+    dispatcher.onInterrupt(2000);
+    TEST_ASSERT_EQUAL(4, sentCount);
+    TEST_ASSERT_EQUAL(12, sentLog[3].data1);
+    TEST_ASSERT_EQUAL(2, sentLog[3].data2);
+    TEST_ASSERT_EQUAL(0, dispatcher.getDeferredCount());
+
+    dispatcher.resetStats();
+    TEST_ASSERT_EQUAL(0, dispatcher.getDeferredCCCount());
+    TEST_ASSERT_EQUAL(0, dispatcher.getThinnedCCCount());
+}
+
+void test_full_deferred_list_drops_debug_ccs_first() {
+    MIDIDispatcher dispatcher(recordOutput);
+    resetLog();
+    dispatcher.setBandwidth(1, 1);
+
+    dispatcher.post(ccAt(0, 1, 1, 1));       // Takes the only token
+    dispatcher.post(ccAt(0, 16, 1, 5).withPriority(MIDIEvent::PRIORITY_DEBUG));
+    for (uint8_t i = 0; i < MIDIDispatcher::DEFERRED_SIZE; i++) {
+        dispatcher.post(ccAt(0, 2, 20 + i, 1));
+    }
+    dispatcher.onInterrupt(0);
+
+    TEST_ASSERT_EQUAL(1, sentCount);
+    TEST_ASSERT_EQUAL(MIDIDispatcher::DEFERRED_SIZE, dispatcher.getDeferredCount());
+    TEST_ASSERT_EQUAL(1, dispatcher.getThinnedCCCount());
+
+    // Deferred CCs leave oldest first; the debug CC was the one dropped
+    dispatcher.onInterrupt(1000);
+    TEST_ASSERT_EQUAL(2, sentCount);
+    TEST_ASSERT_EQUAL(2, sentLog[1].getChannel());
+    TEST_ASSERT_EQUAL(20, sentLog[1].data1);
+}
+
+// 300 BPM with every mode playing: 15 channels x 2 notes per step, clock
+// every 8333 us, and a CC flood of 4 per 100 us tick (40 per ms against a
+// budget of 16). Clock and notes must go out in the tick they are due;
+// CCs get what is left, and the last value of each controller arrives.
+static uint32_t simNow;
+static uint32_t lateMessages;
+static uint32_t clocksSent;
+static uint32_t notesSent;
+static uint32_t ccsSent;
+static uint8_t lastCC[8];
+
+static void timingOutput(const MIDIMessage* messages, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        const MIDIMessage& msg = messages[i];
+        if (msg.getType() == 0xB0) {
+            ccsSent++;
+            lastCC[msg.data1 - 20] = msg.data2;
+            continue;
+        }
+        if (simNow - msg.time >= 100) lateMessages++;
+        if (msg.status == 0xF8) clocksSent++;
+        else notesSent++;
+    }
+}
+
+void test_clock_and_notes_never_wait_for_cc_spam() {
+    MIDIDispatcher dispatcher(timingOutput);
+    lateMessages = clocksSent = notesSent = ccsSent = 0;
+
+    const uint32_t TICK = 100;
+    const uint32_t STEP = 50000;   // 300 BPM sixteenths
+    const uint32_t CLOCK = 8333;   // 24 PPQN at 300 BPM
+    const uint32_t DURATION = 400000;
+    uint32_t nextClock = 0;
+    uint32_t clockTicks = 0;
+    uint32_t nextStep = 0;
+    uint8_t value = 0;
+    uint8_t expectedCC[8];
+
+    for (simNow = 0; simNow < DURATION; simNow += TICK) {
+        // Main loop: notes for the next step posted ahead, CCs as they come
+        if (simNow + TICK >= nextStep) {
+            for (uint8_t channel = 1; channel <= 15; channel++) {
+                dispatcher.post(MIDIMessage::channelMessage(nextStep, 0x90, channel, 36, 100));
+                dispatcher.post(MIDIMessage::channelMessage(nextStep, 0x90, channel, 48, 100));
+            }
+            nextStep += STEP;
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            uint8_t controller = (value + i) & 7;
+            dispatcher.post(ccAt(simNow, 1, 20 + controller, value & 0x7F));
+            expectedCC[controller] = value & 0x7F;
+        }
+        value++;
+
+        // Interrupt: clock first, then the due messages
+        if (simNow >= nextClock) {
+            dispatcher.sendNow(MIDIMessage::realTime(simNow, 0xF8));
+            nextClock += CLOCK;
+            clockTicks++;
+        }
+        dispatcher.onInterrupt(simNow);
+    }
+
+    // Drain what is still deferred
+    for (uint32_t end = simNow + 10000; simNow < end; simNow += TICK) {
+        dispatcher.onInterrupt(simNow);
+    }
+
+    TEST_ASSERT_EQUAL(0, dispatcher.getOverflowCount());
+    TEST_ASSERT_EQUAL(0, lateMessages);
+    TEST_ASSERT_EQUAL(clockTicks, clocksSent);
+    TEST_ASSERT_TRUE(clockTicks >= DURATION / CLOCK);
+    TEST_ASSERT_EQUAL((DURATION / STEP + 1) * 30, notesSent);  // Last step posted ahead, sent while draining
+    TEST_ASSERT_TRUE(dispatcher.getDeferredCCCount() > 0);
+    TEST_ASSERT_TRUE(dispatcher.getThinnedCCCount() > 0);
+
+    // CCs held to the budget (plus the initial burst)
+    TEST_ASSERT_TRUE(ccsSent <= (simNow / 1000) * GRUVBOK::MIDI::OUTPUT_BUDGET_PER_MS +
+                                GRUVBOK::MIDI::OUTPUT_BURST);
+
+    // Thinning never loses a controller's final value
+    TEST_ASSERT_EQUAL(0, dispatcher.getDeferredCount());
+    for (uint8_t i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL(expectedCC[i], lastCC[i]);
+    }
+}
+
+#ifndef ARDUINO
+// Producer (main loop) and consumer (timer interrupt) threads hammering the
+// ring at the same time. Every message must come out exactly once, never
+// before its due time, or be counted as an overflow.
+static std::atomic<uint32_t> fakeNow(0);
+static uint32_t deliveredMask[4096 / 32];
+static uint32_t duplicates = 0;
+static uint32_t early = 0;
+static uint32_t delivered = 0;
+
+static void checkingOutput(const MIDIMessage* messages, uint8_t count) {
+    uint32_t now = fakeNow.load();
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t seq = ((uint16_t)messages[i].data1 << 7) | messages[i].data2;
+        uint32_t bit = (uint32_t)1 << (seq & 31);
+        if (deliveredMask[seq >> 5] & bit) duplicates++;
+        deliveredMask[seq >> 5] |= bit;
+        if ((int32_t)(messages[i].time - now) > 0) early++;
+        delivered++;
+    }
+}
+
+void test_concurrent_producer_and_consumer() {
+    static MIDIDispatcher dispatcher(checkingOutput);
+    const uint16_t COUNT = 4096;
+    std::atomic<bool> producing(true);
+
+    std::thread consumer([&]() {
+        while (producing.load() || delivered + dispatcher.getOverflowCount() < COUNT) {
+            fakeNow.fetch_add(3);
+            dispatcher.onInterrupt(fakeNow.load());
+            std::this_thread::yield();
+        }
+    });
+
+    uint32_t rng = 99;
+    for (uint16_t seq = 0; seq < COUNT; seq++) {
+        rng = rng * 1664525UL + 1013904223UL;
+        uint32_t due = fakeNow.load() + (rng >> 16) % 2000;
+        MIDIMessage msg = MIDIMessage::channelMessage(due, 0x90, 1, seq >> 7, seq & 0x7F);
+        while (!dispatcher.hasSpace()) {
+            std::this_thread::yield();
+        }
+        dispatcher.post(msg);
+        if ((seq & 63) == 0) std::this_thread::yield();
+    }
+    producing.store(false);
+    consumer.join();
+
+    TEST_ASSERT_EQUAL(0, dispatcher.getOverflowCount());
+    TEST_ASSERT_EQUAL(COUNT, delivered);
+    TEST_ASSERT_EQUAL(0, duplicates);
+    TEST_ASSERT_EQUAL(0, early);
+    TEST_ASSERT_TRUE(dispatcher.getMaxFill() > 0);
+}
+#endif
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_message_encoding);
+    RUN_TEST(test_sends_only_due_messages_in_time_order);
+    RUN_TEST(test_early_post_does_not_block_due_message);
+    RUN_TEST(test_full_pending_list_does_not_block_due_message);
+    RUN_TEST(test_wrap_safe_due_check);
+    RUN_TEST(test_overflow_and_max_fill);
+    RUN_TEST(test_duplicate_ccs_are_dropped);
+    RUN_TEST(test_cc_filter_can_be_disabled);
+    RUN_TEST(test_ccs_coalesce_within_one_tick);
+    RUN_TEST(test_ccs_over_budget_are_deferred_then_thinned);
+    RUN_TEST(test_full_deferred_list_drops_debug_ccs_first);
+    RUN_TEST(test_clock_and_notes_never_wait_for_cc_spam);
+#ifndef ARDUINO
+    RUN_TEST(test_concurrent_producer_and_consumer);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,108 @@
+#include <unity.h>
+#include "../src/sequencer/MIDIEncoding.h"
+
+using namespace MIDIEncoding;
+
+void test_usb_packet_layout() {
+    MIDIMessage noteOn = MIDIMessage::channelMessage(0, 0x90, 2, 36, 100);
+    TEST_ASSERT_EQUAL_UINT32(0x64249109UL, usbPacket(noteOn));
+
+    MIDIMessage cc = MIDIMessage::channelMessage(0, 0xB0, 16, 65, 127);
+    TEST_ASSERT_EQUAL_UINT32(0x7F41BF0BUL, usbPacket(cc));
+
+    // Real-time: single byte, code index 0xF; cable in the high nibble
+    MIDIMessage clock = MIDIMessage::realTime(0, 0xF8);
+    TEST_ASSERT_EQUAL_UINT32(0x0000F81FUL, usbPacket(clock, 1));
+}
+
+void test_usb_pack_batch() {
+    MIDIMessage messages[3] = {
+        MIDIMessage::channelMessage(0, 0x90, 1, 60, 100),
+        MIDIMessage::channelMessage(0, 0x80, 1, 60, 0),
+        MIDIMessage::realTime(0, 0xFA)
+    };
+    uint32_t packets[3];
+    TEST_ASSERT_EQUAL(3, packUsb(messages, 3, packets));
+    TEST_ASSERT_EQUAL_UINT32(usbPacket(messages[1]), packets[1]);
+}
+
+void test_running_status_omits_repeated_status() {
+    RunningStatusEncoder encoder;
+    uint8_t out[16];
+
+    MIDIMessage messages[4] = {
+        MIDIMessage::channelMessage(0, 0x90, 2, 36, 100),
+        MIDIMessage::channelMessage(0, 0x90, 2, 42, 80),
+        MIDIMessage::channelMessage(0, 0x80, 2, 36, 0),   // As note on, velocity 0
+        MIDIMessage::channelMessage(0, 0x90, 3, 36, 90)   // New channel: new status
+    };
+    TEST_ASSERT_EQUAL(10, encoder.encode(messages, 4, out));
+
+    const uint8_t expected[10] = {0x91, 36, 100, 42, 80, 36, 0, 0x92, 36, 90};
+    for (uint8_t i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL(expected[i], out[i]);
+    }
+}
+
+void test_running_status_survives_real_time() {
+    RunningStatusEncoder encoder;
+    uint8_t out[8];
+
+    encoder.encode(MIDIMessage::channelMessage(0, 0xB0, 1, 10, 64), out);
+    TEST_ASSERT_EQUAL(1, encoder.encode(MIDIMessage::realTime(0, 0xF8), out));
+    TEST_ASSERT_EQUAL(0xF8, out[0]);
+    TEST_ASSERT_EQUAL(2, encoder.encode(MIDIMessage::channelMessage(0, 0xB0, 1, 10, 65), out));
+
+    // After a reset the status is sent again
+    encoder.reset();
+    TEST_ASSERT_EQUAL(3, encoder.encode(MIDIMessage::channelMessage(0, 0xB0, 1, 10, 66), out));
+}
+
+void test_plain_note_off_option() {
+    RunningStatusEncoder encoder;
+    encoder.setNoteOffAsNoteOn(false);
+    uint8_t out[8];
+
+    encoder.encode(MIDIMessage::channelMessage(0, 0x90, 1, 60, 100), out);
+    TEST_ASSERT_EQUAL(3, encoder.encode(MIDIMessage::channelMessage(0, 0x80, 1, 60, 0), out));
+    TEST_ASSERT_EQUAL(0x80, out[0]);
+}
+
+void test_two_byte_messages() {
+    RunningStatusEncoder encoder;
+    uint8_t out[8];
+
+    // Program change has one data byte
+    MIDIMessage program = MIDIMessage::channelMessage(0, 0xC0, 1, 5, 0);
+    TEST_ASSERT_EQUAL(1, program.getDataLength());
+    TEST_ASSERT_EQUAL(2, encoder.encode(program, out));
+    TEST_ASSERT_EQUAL(1, encoder.encode(program, out));
+    TEST_ASSERT_EQUAL_UINT32(0x0005C00CUL, usbPacket(program));
+}
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_usb_packet_layout);
+    RUN_TEST(test_usb_pack_batch);
+    RUN_TEST(test_running_status_omits_repeated_status);
+    RUN_TEST(test_running_status_survives_real_time);
+    RUN_TEST(test_plain_note_off_option);
+    RUN_TEST(test_two_byte_messages);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,223 @@
+#include <unity.h>
+#include "../src/sequencer/MIDIDispatcher.h"
+#include "../src/sequencer/MIDIPort.h"
+
+#ifndef ARDUINO
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../src/platform/HostMIDIPort.h"
+#endif
+
+// Byte stream standing in for a serial port: takes at most 'room' bytes
+// per flush
+struct FakeStream {
+    uint8_t bytes[1024];
+    uint16_t length = 0;
+    int room = 1024;
+
+    int availableForWrite() const { return room; }
+
+    size_t write(const uint8_t* data, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            bytes[length++] = data[i];
+        }
+        room -= (int)count;
+        return count;
+    }
+};
+
+static MIDIMessage noteOn(uint8_t channel, uint8_t note) {
+    return MIDIMessage::channelMessage(0, 0x90, channel, note, 100);
+}
+
+void test_routing_by_channel() {
+    MIDIDispatcher dispatcher;
+    RecordingMIDIPort<16> low;
+    RecordingMIDIPort<16> high;
+    low.setChannels(0x00FF);            // Channels 1-8
+    high.setChannels(0xFF00);           // Channels 9-16
+    high.setRealTime(false);
+    TEST_ASSERT_TRUE(dispatcher.addPort(&low));
+    TEST_ASSERT_TRUE(dispatcher.addPort(&high));
+
+    dispatcher.post(noteOn(1, 36));
+    dispatcher.post(noteOn(10, 38));
+    dispatcher.post(noteOn(8, 40));
+    dispatcher.onInterrupt(0);
+    dispatcher.sendNow(MIDIMessage::realTime(0, MIDIMessage::CLOCK));
+
+    TEST_ASSERT_EQUAL(3, low.size());
+    TEST_ASSERT_EQUAL(36, low[0].data1);
+    TEST_ASSERT_EQUAL(40, low[1].data1);
+    TEST_ASSERT_EQUAL(MIDIMessage::CLOCK, low[2].status);
+    TEST_ASSERT_EQUAL(1, high.size());
+    TEST_ASSERT_EQUAL(38, high[0].data1);
+
+    // Re-route at runtime
+    low.routeChannel(10, true);
+    high.routeChannel(10, false);
+    dispatcher.post(noteOn(10, 42));
+    dispatcher.onInterrupt(0);
+    TEST_ASSERT_EQUAL(4, low.size());
+    TEST_ASSERT_EQUAL(1, high.size());
+}
+
+void test_port_limit() {
+    MIDIDispatcher dispatcher;
+    RecordingMIDIPort<1> ports[MIDIDispatcher::MAX_PORTS + 1];
+    for (uint8_t i = 0; i < MIDIDispatcher::MAX_PORTS; i++) {
+        TEST_ASSERT_TRUE(dispatcher.addPort(&ports[i]));
+    }
+    TEST_ASSERT_FALSE(dispatcher.addPort(&ports[MIDIDispatcher::MAX_PORTS]));
+    TEST_ASSERT_FALSE(dispatcher.addPort(nullptr));
+    TEST_ASSERT_EQUAL(MIDIDispatcher::MAX_PORTS, dispatcher.getPortCount());
+}
+
+void test_stream_port_keeps_partial_messages() {
+    FakeStream serial;
+    StreamMIDIPort<FakeStream> din(&serial);
+
+    din.enqueue(noteOn(1, 36));
+    din.enqueue(noteOn(1, 38));                                 // Running status
+    din.enqueue(MIDIMessage::channelMessage(0, 0x80, 1, 36, 0)); // Note on, velocity 0
+
+    // Two bytes of room per flush: messages are split across flushes
+    serial.room = 2;
+    din.flush();
+    TEST_ASSERT_EQUAL(2, serial.length);
+    for (uint8_t i = 0; i < 4; i++) {
+        serial.room = 2;
+        din.flush();
+    }
+
+    const uint8_t expected[] = {0x90, 36, 100, 38, 100, 36, 0};
+    TEST_ASSERT_EQUAL(sizeof(expected), serial.length);
+    for (uint8_t i = 0; i < sizeof(expected); i++) {
+        TEST_ASSERT_EQUAL(expected[i], serial.bytes[i]);
+    }
+    TEST_ASSERT_EQUAL(0, din.getQueued());
+}
+
+void test_slow_port_never_stalls_another() {
+    MIDIDispatcher dispatcher;
+    FakeStream serial;
+    serial.room = 0;                    // Receiver not taking anything
+    StreamMIDIPort<FakeStream> din(&serial);
+    RecordingMIDIPort<256> usb;
+    dispatcher.addPort(&din);
+    dispatcher.addPort(&usb);
+
+    for (uint16_t i = 0; i < 200; i++) {
+        dispatcher.post(noteOn(1, i & 0x7F));
+        dispatcher.onInterrupt(i);
+    }
+
+    TEST_ASSERT_EQUAL(200, usb.size());
+    TEST_ASSERT_EQUAL(0, usb.getOverflowCount());
+    TEST_ASSERT_EQUAL(MIDIPort::QUEUE_SIZE - 1, din.getQueued());
+    TEST_ASSERT_EQUAL(200 - (MIDIPort::QUEUE_SIZE - 1), din.getOverflowCount());
+
+    // Once the port drains, it carries on from its queue
+    serial.room = 1024;
+    din.flush();
+    TEST_ASSERT_EQUAL(0, din.getQueued());
+    TEST_ASSERT_TRUE(serial.length > 0);
+}
+
+void test_main_loop_ports_are_serviced_outside_the_interrupt() {
+    MIDIDispatcher dispatcher;
+    RecordingMIDIPort<8> recorder(false);
+    dispatcher.addPort(&recorder);
+
+    dispatcher.post(noteOn(3, 60));
+    dispatcher.onInterrupt(0);
+    TEST_ASSERT_EQUAL(0, recorder.size());
+    TEST_ASSERT_EQUAL(1, recorder.getQueued());
+
+    dispatcher.servicePorts();
+    TEST_ASSERT_EQUAL(1, recorder.size());
+    TEST_ASSERT_EQUAL(0x92, recorder[0].status);
+}
+
+#ifndef ARDUINO
+void test_host_port_writes_to_a_pipe() {
+    int fds[2];
+    TEST_ASSERT_EQUAL(0, pipe(fds));
+    {
+        MIDIDispatcher dispatcher;
+        HostMIDIPort host(fds[1]);
+        dispatcher.addPort(&host);
+
+        dispatcher.post(noteOn(2, 36));
+        dispatcher.post(MIDIMessage::channelMessage(0, 0xB0, 2, 7, 90));
+        dispatcher.onInterrupt(0);
+        dispatcher.sendNow(MIDIMessage::realTime(0, MIDIMessage::CLOCK));
+        dispatcher.servicePorts();
+
+        uint8_t bytes[16];
+        ssize_t n = read(fds[0], bytes, sizeof(bytes));
+        const uint8_t expected[] = {0x91, 36, 100, 0xB1, 7, 90, 0xF8};
+        TEST_ASSERT_EQUAL(sizeof(expected), n);
+        for (uint8_t i = 0; i < sizeof(expected); i++) {
+            TEST_ASSERT_EQUAL(expected[i], bytes[i]);
+        }
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void test_full_pipe_does_not_block() {
+    int fds[2];
+    TEST_ASSERT_EQUAL(0, pipe(fds));
+    {
+        HostMIDIPort host(fds[1]);      // Makes the descriptor non-blocking
+
+        // Nobody reads: fill the pipe
+        uint8_t junk[512] = {};
+        while (write(fds[1], junk, sizeof(junk)) > 0) {
+        }
+        TEST_ASSERT_EQUAL(EAGAIN, errno);
+
+        host.enqueue(noteOn(1, 36));
+        host.flush();                   // Returns instead of blocking
+        TEST_ASSERT_EQUAL(0, host.getQueued());  // Taken into the partial message
+
+        host.enqueue(noteOn(1, 38));
+        host.flush();
+        TEST_ASSERT_EQUAL(1, host.getQueued());
+    }
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_routing_by_channel);
+    RUN_TEST(test_port_limit);
+    RUN_TEST(test_stream_port_keeps_partial_messages);
+    RUN_TEST(test_slow_port_never_stalls_another);
+    RUN_TEST(test_main_loop_ports_are_serviced_outside_the_interrupt);
+#ifndef ARDUINO
+    RUN_TEST(test_host_port_writes_to_a_pipe);
+    RUN_TEST(test_full_pipe_does_not_block);
+#endif
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
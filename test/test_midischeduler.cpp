@@ -1,11 +1,13 @@
 #include <unity.h>
+#include <Arduino.h>
 #include "../src/sequencer/MIDIScheduler.h"
+#include "../src/modes/Mode1_DrumMachine.h"
 
 // Note: These tests focus on the scheduling logic and buffer management
 // Actual MIDI output requires hardware/USB MIDI and is tested separately
 
 void test_scheduler_initialization() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
     // Scheduler should initialize with no active events
     // (No direct way to verify without exposing internals, but update() should not crash)
     scheduler.update();
@@ -13,7 +15,7 @@ void test_scheduler_initialization() {
 }
 
 void test_scheduler_clear() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Schedule some events
     scheduler.note(1, 60, 100, 0);
@@ -28,7 +30,7 @@ void test_scheduler_clear() {
 }
 
 void test_scheduler_channel_validation() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Invalid channels should be rejected silently (channel 0)
     scheduler.note(0, 60, 100, 0);  // Should not crash
@@ -52,7 +54,7 @@ void test_scheduler_channel_validation() {
 }
 
 void test_scheduler_note_scheduling() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Schedule a note on with immediate execution (delta=0)
     scheduler.note(1, 60, 100, 0);
@@ -67,7 +69,7 @@ void test_scheduler_note_scheduling() {
 }
 
 void test_scheduler_cc_scheduling() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Schedule CC messages
     scheduler.cc(1, 10, 64, 0);    // Pan center
@@ -79,7 +81,7 @@ void test_scheduler_cc_scheduling() {
 }
 
 void test_scheduler_stopall() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Schedule some notes
     scheduler.note(1, 60, 100, 0);
@@ -94,7 +96,7 @@ void test_scheduler_stopall() {
 }
 
 void test_scheduler_buffer_management() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Fill the buffer with events (max 64 events)
     for (uint8_t i = 0; i < 64; i++) {
@@ -109,7 +111,7 @@ void test_scheduler_buffer_management() {
 }
 
 void test_scheduler_multiple_channels() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Schedule events on different channels
     scheduler.note(1, 36, 127, 0);   // Kick on channel 1
@@ -122,7 +124,7 @@ void test_scheduler_multiple_channels() {
 }
 
 void test_scheduler_delta_timing() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Schedule events with various delta times
     scheduler.note(1, 60, 100, 0);      // Immediate
@@ -141,7 +143,7 @@ void test_scheduler_delta_timing() {
 }
 
 void test_scheduler_event_interleaving() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Schedule interleaved note on/off/cc events
     scheduler.note(1, 60, 100, 0);
@@ -159,7 +161,7 @@ void test_scheduler_event_interleaving() {
 }
 
 void test_scheduler_clear_after_scheduling() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Schedule many events
     for (uint8_t i = 0; i < 20; i++) {
@@ -182,7 +184,7 @@ void test_scheduler_clear_after_scheduling() {
 }
 
 void test_scheduler_boundary_values() {
-    MIDIScheduler scheduler;
+    MIDIScheduler<> scheduler;
 
     // Test boundary MIDI values
     scheduler.note(1, 0, 0, 0);        // Min note, min velocity
@@ -198,6 +200,1063 @@ void test_scheduler_boundary_values() {
     TEST_ASSERT_TRUE(true);
 }
 
+void test_data_bytes_clamp_instead_of_wrapping() {
+    // Note 130 must not play as note 2
+    MIDIEvent on = MIDIEvent::noteOn(1, 130, 200);
+    TEST_ASSERT_EQUAL(127, on.data1);
+    TEST_ASSERT_EQUAL(127, on.data2);
+    TEST_ASSERT_EQUAL(127, MIDIEvent::noteOff(1, 255).data1);
+    TEST_ASSERT_EQUAL(127, MIDIEvent::cc(1, 128, 129).data1);
+    TEST_ASSERT_EQUAL(127, MIDIEvent::cc(1, 128, 129).data2);
+    TEST_ASSERT_EQUAL(127, MIDIEvent::tie(1, 140, 150, 0).data1);
+    TEST_ASSERT_EQUAL(127, MIDIEvent::tie(1, 140, 150, 0).data2);
+
+    // Also when scheduled directly
+    ManualTimeSource clock(1000);
+    MIDIScheduler<> scheduler;
+    scheduler.setTimeSource(&clock);
+    scheduler.note(1, 130, 200, 10);
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(1010, event));
+    TEST_ASSERT_EQUAL(127, event.data1);
+    TEST_ASSERT_EQUAL(127, event.data2);
+}
+
+void test_scheduler_pops_in_time_order() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+
+    buffer.noteOn(1, 64, 100, 30);
+    buffer.noteOn(1, 60, 100, 10);
+    buffer.noteOn(1, 62, 100, 20);
+    TEST_ASSERT_EQUAL(3, scheduler.scheduleAll(buffer, 1000));
+
+    MIDIEvent event;
+    TEST_ASSERT_FALSE(scheduler.popDue(1009, event));  // Nothing due yet
+
+    TEST_ASSERT_TRUE(scheduler.popDue(1030, event));
+    TEST_ASSERT_EQUAL(60, event.data1);
+    TEST_ASSERT_TRUE(scheduler.popDue(1030, event));
+    TEST_ASSERT_EQUAL(62, event.data1);
+    TEST_ASSERT_TRUE(scheduler.popDue(1030, event));
+    TEST_ASSERT_EQUAL(64, event.data1);
+    TEST_ASSERT_FALSE(scheduler.popDue(1030, event));
+}
+
+void test_scheduler_same_time_is_fifo() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+
+    // NOTE_OFF then NOTE_ON for the same pitch at the same time must not swap
+    buffer.noteOff(2, 36, 50);
+    buffer.noteOn(2, 36, 100, 50);
+    // Pad the heap so the pair is not trivially adjacent
+    for (uint8_t i = 0; i < 20; i++) {
+        buffer.cc(2, 10, i, 50);
+    }
+    scheduler.scheduleAll(buffer, 0);
+
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(50, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+    TEST_ASSERT_TRUE(scheduler.popDue(50, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_ON, event.type);
+    for (uint8_t i = 0; i < 20; i++) {
+        TEST_ASSERT_TRUE(scheduler.popDue(50, event));
+        TEST_ASSERT_EQUAL(i, event.data2);
+    }
+}
+
+void test_scheduler_capacity_and_reuse() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+
+    for (uint8_t i = 0; i < 32; i++) {
+        buffer.noteOn(1, i, 100, 100 - i);
+    }
+    TEST_ASSERT_EQUAL(32, scheduler.scheduleAll(buffer, 0));
+    TEST_ASSERT_EQUAL(32, scheduler.scheduleAll(buffer, 0));
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getCapacity(), scheduler.pending());
+
+    // Full: nothing more fits
+    TEST_ASSERT_EQUAL(0, scheduler.scheduleAll(buffer, 0));
+
+    // Draining frees slots for reuse
+    MIDIEvent event;
+    uint8_t drained = 0;
+    while (scheduler.popDue(100, event)) drained++;
+    TEST_ASSERT_EQUAL(64, drained);
+    TEST_ASSERT_EQUAL(0, scheduler.pending());
+    TEST_ASSERT_EQUAL(32, scheduler.scheduleAll(buffer, 0));
+}
+
+static MIDIMessage handedOver[8];
+static uint8_t handedOverCount = 0;
+
+static void captureOutput(const MIDIMessage* messages, uint8_t count) {
+    for (uint8_t i = 0; i < count && handedOverCount < 8; i++) {
+        handedOver[handedOverCount++] = messages[i];
+    }
+}
+
+void test_scheduler_hands_lookahead_to_dispatcher() {
+    MIDIDispatcher dispatcher(captureOutput);
+    MIDIScheduler<> scheduler(&dispatcher);
+    MIDIEventBuffer<> buffer;
+    handedOverCount = 0;
+
+    unsigned long now = micros();
+    buffer.noteOn(3, 60, 100, 0);
+    buffer.noteOff(3, 60, 500);        // Inside the lookahead window
+    buffer.stopAll(3, 1000000);        // Far future, stays in the wheel
+    scheduler.scheduleAll(buffer, now);
+
+    scheduler.update();
+    TEST_ASSERT_EQUAL(1, scheduler.pending());
+
+    // The dispatch interrupt sends each message at its exact time
+    dispatcher.onInterrupt(now + 499);
+    TEST_ASSERT_EQUAL(1, handedOverCount);
+    TEST_ASSERT_EQUAL(0x92, handedOver[0].status);
+    dispatcher.onInterrupt(now + 500);
+    TEST_ASSERT_EQUAL(2, handedOverCount);
+    TEST_ASSERT_EQUAL(0x82, handedOver[1].status);
+    TEST_ASSERT_EQUAL((uint32_t)(now + 500), handedOver[1].time);
+}
+
+void test_scheduler_logical_time_absorbs_lateness() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+
+    // Step was due 3 ms ago; its events keep their spacing from the ideal time
+    unsigned long stepTime = micros() - 3000;
+    scheduler.beginStep(stepTime);
+    TEST_ASSERT_TRUE(scheduler.getLastStepLateness() >= 3000);
+    TEST_ASSERT_TRUE(scheduler.getLastStepLateness() < 100000);
+
+    buffer.noteOn(1, 60, 100, 0);
+    buffer.noteOff(1, 60, 50000);
+    scheduler.scheduleAll(buffer, stepTime);
+
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(stepTime, event));
+    TEST_ASSERT_EQUAL((uint32_t)stepTime, (uint32_t)event.delta);
+    TEST_ASSERT_FALSE(scheduler.popDue(stepTime + 49999, event));
+    TEST_ASSERT_TRUE(scheduler.popDue(stepTime + 50000, event));
+    TEST_ASSERT_EQUAL((uint32_t)(stepTime + 50000), (uint32_t)event.delta);
+
+    // Max is kept until reset; an on-time step reports no lateness
+    uint32_t worst = scheduler.getMaxStepLateness();
+    scheduler.beginStep(micros() + 1000);
+    TEST_ASSERT_EQUAL(0, scheduler.getLastStepLateness());
+    TEST_ASSERT_EQUAL(worst, scheduler.getMaxStepLateness());
+    scheduler.resetLatencyStats();
+    TEST_ASSERT_EQUAL(0, scheduler.getMaxStepLateness());
+}
+
+static MIDIMessage sentLog[64];
+static uint8_t sentCount = 0;
+
+static void recordOutput(const MIDIMessage* messages, uint8_t count) {
+    for (uint8_t i = 0; i < count && sentCount < 64; i++) {
+        sentLog[sentCount++] = messages[i];
+    }
+}
+
+void test_scheduler_flam_off_does_not_cut_main_hit() {
+    MIDIDispatcher dispatcher(recordOutput);
+    MIDIScheduler<> scheduler(&dispatcher);
+    MIDIEventBuffer<> buffer;
+    sentCount = 0;
+
+    unsigned long now = micros();
+    buffer.noteOn(2, 38, 60, 0);        // Flam
+    buffer.noteOff(2, 38, 300);         // Short flam off
+    buffer.noteOn(2, 38, 100, 100);     // Main hit
+    buffer.noteOff(2, 38, 1000);        // Main off
+    buffer.noteOff(2, 38, 1500);        // Redundant
+    scheduler.scheduleAll(buffer, now);
+
+    scheduler.update();
+    dispatcher.onInterrupt(now + 1500);
+
+    TEST_ASSERT_EQUAL(3, sentCount);
+    TEST_ASSERT_EQUAL(0x91, sentLog[0].status);
+    TEST_ASSERT_EQUAL(0x91, sentLog[1].status);
+    TEST_ASSERT_EQUAL(0x81, sentLog[2].status);
+    TEST_ASSERT_EQUAL((uint32_t)(now + 1000), sentLog[2].time);
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.getVoices().getSuppressedOffCount());
+}
+
+void test_scheduler_full_pool_never_drops_note_off() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+
+    for (uint8_t i = 0; i < 32; i++) {
+        buffer.noteOn(1, i, 100, 1000 + i);
+    }
+    scheduler.scheduleAll(buffer, 0);
+    scheduler.scheduleAll(buffer, 0);
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getCapacity(), scheduler.pending());
+
+    // A CC is dropped, a NOTE_OFF displaces the furthest-future NOTE_ON
+    scheduler.cc(1, 10, 64, 0);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getDroppedCount());
+
+    MIDIEventBuffer<> offs;
+    offs.noteOff(1, 5, 500);
+    TEST_ASSERT_EQUAL(1, scheduler.scheduleAll(offs, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getEvictedCount());
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getCapacity(), scheduler.pending());
+
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(500, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+
+    // The evicted NOTE_ON was one of the two latest (note 31)
+    uint8_t lateNotes = 0;
+    while (scheduler.popDue(2000, event)) {
+        if (event.data1 == 31) lateNotes++;
+    }
+    TEST_ASSERT_EQUAL(1, lateNotes);
+}
+
+void test_scheduler_overflow_evicts_lowest_priority_furthest_future() {
+    MIDIScheduler<> scheduler;
+    MIDIEvent event;
+
+    // 32 musical CCs and 32 debug CCs fill the pool
+    for (uint8_t i = 0; i < 32; i++) {
+        scheduler.cc(1, 10, i, 1000 + i);
+        scheduler.cc(16, 1, i, 1000 + i, MIDIEvent::PRIORITY_DEBUG);
+    }
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getCapacity(), scheduler.pending());
+    TEST_ASSERT_TRUE(scheduler.hasBackpressure());
+
+    // A debug CC finds nothing below it and is dropped
+    scheduler.cc(16, 2, 0, 0, MIDIEvent::PRIORITY_DEBUG);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getDropCount(MIDIEvent::PRIORITY_DEBUG));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getEvictedCount());
+
+    // A note evicts the furthest-future debug CC
+    MIDIEventBuffer<> buffer;
+    buffer.noteOn(2, 36, 100, 0);
+    TEST_ASSERT_EQUAL(1, scheduler.scheduleAll(buffer, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.getDropCount(MIDIEvent::PRIORITY_DEBUG));
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getEvictedCount());
+
+    uint8_t debugCount = 0;
+    bool sawLastDebug = false;
+    while (scheduler.popDue(5000, event)) {
+        if (event.channel == 16) {
+            debugCount++;
+            if (event.data2 == 31) sawLastDebug = true;
+        }
+    }
+    TEST_ASSERT_EQUAL(31, debugCount);
+    TEST_ASSERT_FALSE(sawLastDebug);
+
+    // Once all debug CCs are gone, musical CCs give way to notes
+    for (uint8_t i = 0; i < 64; i++) {
+        scheduler.cc(1, 10, i & 0x7F, 1000 + i);
+    }
+    buffer.clear();
+    buffer.noteOn(2, 36, 100, 0);
+    buffer.noteOff(2, 36, 100);
+    TEST_ASSERT_EQUAL(2, scheduler.scheduleAll(buffer, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.getDropCount(MIDIEvent::PRIORITY_CC));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getDropCount(MIDIEvent::PRIORITY_NOTE_ON));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getDropCount(MIDIEvent::PRIORITY_NOTE_OFF));
+
+    scheduler.resetDropStats();
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getDroppedCount());
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getEvictedCount());
+}
+
+void test_scheduler_backpressure_scales_with_capacity() {
+    // Four times the default pool: four times the free-slot threshold
+    static MIDIScheduler<4 * GRUVBOK::MIDI::MAX_SCHEDULED_EVENTS> scheduler;
+    const uint16_t threshold = 4 * GRUVBOK::MIDI::BACKPRESSURE_FREE_SLOTS;
+
+    uint8_t pitch = 0;
+    while (scheduler.getFreeSlots() > threshold) {
+        scheduler.note(1 + pitch / 128, pitch % 128, 100, 1000000);
+        pitch++;
+    }
+    TEST_ASSERT_FALSE(scheduler.hasBackpressure());
+    scheduler.note(2, 127, 100, 1000000);
+    TEST_ASSERT_TRUE(scheduler.hasBackpressure());
+}
+
+void test_scheduler_reports_backpressure() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    MIDIEvent event;
+
+    TEST_ASSERT_FALSE(scheduler.hasBackpressure());
+    for (uint8_t i = 0; i < 32; i++) {
+        buffer.noteOn(1, i, 100, 1000);
+    }
+    scheduler.scheduleAll(buffer, 0);
+    scheduler.scheduleAll(buffer, 0);
+    TEST_ASSERT_EQUAL(0, scheduler.getFreeSlots());
+    TEST_ASSERT_TRUE(scheduler.hasBackpressure());
+
+    // Short of the buffer size: events were lost
+    TEST_ASSERT_EQUAL(0, scheduler.scheduleAll(buffer, 0));
+    TEST_ASSERT_EQUAL_UINT32(32, scheduler.getDropCount(MIDIEvent::PRIORITY_NOTE_ON));
+
+    // Draining clears it once a scheduleAll() goes through again
+    while (scheduler.popDue(1000, event)) {}
+    buffer.clear();
+    buffer.noteOn(1, 60, 100, 0);
+    TEST_ASSERT_EQUAL(1, scheduler.scheduleAll(buffer, 0));
+    TEST_ASSERT_FALSE(scheduler.hasBackpressure());
+}
+
+void test_scheduler_panic_sends_exact_note_offs() {
+    MIDIDispatcher dispatcher(recordOutput);
+    MIDIScheduler<> scheduler(&dispatcher);
+    MIDIEventBuffer<> buffer;
+    sentCount = 0;
+
+    unsigned long now = micros();
+    buffer.noteOn(2, 36, 100, 0);
+    buffer.noteOn(3, 48, 100, 0);
+    buffer.noteOn(3, 55, 100, 1500);    // Posted ahead, not yet started
+    buffer.noteOff(3, 48, 1000000);     // Far future
+    scheduler.scheduleAll(buffer, now);
+    scheduler.update();
+    TEST_ASSERT_EQUAL(3, scheduler.getVoices().getTotalVoices());
+
+    scheduler.clear();
+    TEST_ASSERT_EQUAL(3, scheduler.panic());
+    TEST_ASSERT_EQUAL(0, scheduler.getVoices().getTotalVoices());
+
+    dispatcher.onInterrupt(now + 1500);
+    TEST_ASSERT_EQUAL(6, sentCount);
+
+    // Every sounding note gets its own NOTE_OFF, after the last note-on
+    uint8_t offs = 0;
+    for (uint8_t i = 0; i < sentCount; i++) {
+        if (sentLog[i].getType() == 0x80) {
+            offs++;
+            TEST_ASSERT_TRUE(i >= 3);
+        }
+    }
+    TEST_ASSERT_EQUAL(3, offs);
+}
+
+void test_scheduler_polyphony_limit() {
+    MIDIDispatcher dispatcher(recordOutput);
+    MIDIScheduler<> scheduler(&dispatcher);
+    MIDIEventBuffer<> buffer;
+    sentCount = 0;
+    scheduler.setPolyphony(2);
+
+    unsigned long now = micros();
+    buffer.noteOn(5, 60, 100, 0);
+    buffer.noteOn(5, 64, 100, 100);
+    buffer.noteOn(5, 67, 100, 200);
+    scheduler.scheduleAll(buffer, now);
+    scheduler.update();
+    dispatcher.onInterrupt(now + 200);
+
+    // The oldest voice is released just before the new note starts
+    TEST_ASSERT_EQUAL(4, sentCount);
+    TEST_ASSERT_EQUAL(0x84, sentLog[2].status);
+    TEST_ASSERT_EQUAL(60, sentLog[2].data1);
+    TEST_ASSERT_EQUAL(0x94, sentLog[3].status);
+    TEST_ASSERT_EQUAL(67, sentLog[3].data1);
+    TEST_ASSERT_EQUAL(2, scheduler.getVoices().getVoiceCount(5));
+}
+
+void test_scheduler_marks_message_priority() {
+    MIDIDispatcher dispatcher(recordOutput);
+    MIDIScheduler<> scheduler(&dispatcher);
+    sentCount = 0;
+
+    // The output budget needs to know which CCs may wait
+    unsigned long now = micros();
+    scheduler.cc(16, 1, 3, 0, MIDIEvent::PRIORITY_DEBUG);
+    scheduler.cc(2, 10, 64, 0);
+    scheduler.note(2, 36, 100, 0);
+    scheduler.stopall(2, 0);
+    scheduler.update();
+    dispatcher.onInterrupt(now + GRUVBOK::MIDI::DISPATCH_LOOKAHEAD_US);
+
+    TEST_ASSERT_EQUAL(4, sentCount);
+    TEST_ASSERT_EQUAL(MIDIEvent::PRIORITY_DEBUG, sentLog[0].priority);
+    TEST_ASSERT_EQUAL(MIDIEvent::PRIORITY_CC, sentLog[1].priority);
+    TEST_ASSERT_EQUAL(MIDIEvent::PRIORITY_NOTE_ON, sentLog[2].priority);
+    TEST_ASSERT_EQUAL(MIDIEvent::PRIORITY_NOTE_OFF, sentLog[3].priority);
+}
+
+void test_scheduler_polled_output_to_port() {
+    RecordingMIDIPort<8> port;
+    MIDIScheduler<> scheduler(&port);
+
+    unsigned long now = micros();
+    scheduler.note(4, 60, 100, 0);
+    scheduler.cc(4, 74, 30, 0);
+    scheduler.note(4, 62, 100, 1000000);   // Not due yet
+    scheduler.update();
+
+    TEST_ASSERT_EQUAL(2, port.size());
+    TEST_ASSERT_EQUAL(0x93, port[0].status);
+    TEST_ASSERT_EQUAL(0xB3, port[1].status);
+    TEST_ASSERT_TRUE((int32_t)(port[0].time - (uint32_t)now) >= 0);
+    TEST_ASSERT_EQUAL(1, scheduler.pending());
+
+    // panic() reaches the port too
+    TEST_ASSERT_EQUAL(1, scheduler.panic());
+    TEST_ASSERT_EQUAL(3, port.size());
+    TEST_ASSERT_EQUAL(0x83, port[2].status);
+}
+
+void test_scheduler_handle_cancel_and_retime() {
+    MIDIScheduler<> scheduler;
+    unsigned long now = micros();
+
+    EventHandle on = scheduler.note(1, 60, 100, 1000);
+    EventHandle off = scheduler.off(1, 60, 5000);
+    TEST_ASSERT_TRUE(scheduler.isPending(on));
+    TEST_ASSERT_EQUAL(2, scheduler.pending());
+
+    // Retime: the off now fires first
+    unsigned long time;
+    TEST_ASSERT_TRUE(scheduler.getTime(off, time));
+    TEST_ASSERT_TRUE(scheduler.retime(off, time - 4500));
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 1000000, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+    TEST_ASSERT_FALSE(scheduler.isPending(off));  // Fired: handle is stale
+    TEST_ASSERT_FALSE(scheduler.cancel(off));
+
+    // Cancel frees the slot at once
+    TEST_ASSERT_TRUE(scheduler.cancel(on));
+    TEST_ASSERT_FALSE(scheduler.cancel(on));
+    TEST_ASSERT_EQUAL(0, scheduler.pending());
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getCapacity(), scheduler.getFreeSlots());
+
+    // A reused slot does not answer to an old handle
+    EventHandle reused = scheduler.note(1, 62, 100, 1000);
+    TEST_ASSERT_EQUAL(on.slot, reused.slot);
+    TEST_ASSERT_FALSE(scheduler.isPending(on));
+    TEST_ASSERT_FALSE(scheduler.retime(on, now));
+    TEST_ASSERT_TRUE(scheduler.isPending(reused));
+
+    // clear() invalidates everything; invalid channels give no handle
+    scheduler.clear();
+    TEST_ASSERT_FALSE(scheduler.isPending(reused));
+    TEST_ASSERT_TRUE(scheduler.note(0, 60, 100).isNone());
+}
+
+void test_scheduler_cancel_origin_cuts_tails() {
+    MIDIDispatcher dispatcher(recordOutput);
+    MIDIScheduler<> scheduler(&dispatcher);
+    MIDIEventBuffer<> buffer;
+    sentCount = 0;
+
+    // Mode 3, track 2: a note now and two echoes later; track 5 plays too
+    unsigned long now = micros();
+    buffer.setOrigin(3, 2);
+    buffer.noteOn(4, 60, 100, 0);
+    buffer.noteOff(4, 60, 100000);
+    buffer.noteOn(4, 63, 80, 200000);
+    buffer.noteOff(4, 63, 300000);
+    buffer.noteOn(4, 66, 64, 400000);
+    buffer.noteOff(4, 66, 500000);
+    buffer.setOrigin(3, 5);
+    buffer.noteOn(4, 70, 100, 200000);
+    buffer.noteOff(4, 70, 300000);
+    scheduler.scheduleAll(buffer, now);
+    scheduler.update();
+    dispatcher.onInterrupt(now);
+    TEST_ASSERT_EQUAL(1, sentCount);            // First note is sounding
+
+    // Pattern change: track 2's echoes go, its sounding note still ends
+    TEST_ASSERT_EQUAL(4, scheduler.cancelOrigin(3, 2));
+    TEST_ASSERT_EQUAL(3, scheduler.pending());
+    TEST_ASSERT_EQUAL(0, scheduler.cancelOrigin(3, 2));
+
+    // All tracks of the mode
+    TEST_ASSERT_EQUAL(2, scheduler.cancelOrigin(3));
+    TEST_ASSERT_EQUAL(1, scheduler.pending());
+
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 1000000, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+    TEST_ASSERT_EQUAL(60, event.data1);
+}
+
+void test_scheduler_cancel_channel() {
+    MIDIScheduler<> scheduler;
+    scheduler.note(2, 36, 100, 1000);
+    scheduler.off(2, 36, 2000);
+    scheduler.cc(2, 10, 64, 1000);
+    scheduler.stopall(2, 3000);
+    scheduler.note(3, 36, 100, 1000);
+    scheduler.off(3, 36, 2000);
+
+    TEST_ASSERT_EQUAL(3, scheduler.cancelChannel(2));
+    TEST_ASSERT_EQUAL(3, scheduler.pending());   // STOP_ALL and channel 3 stay
+}
+
+void test_scheduler_tie_extends_pending_note_off() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    unsigned long now = micros();
+
+    buffer.setOrigin(2, 0);
+    buffer.noteOn(3, 48, 100, 0);
+    buffer.noteOff(3, 48, 100000);
+    scheduler.scheduleAll(buffer, now);
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(now, event));      // Note started
+
+    // Next step ties: the off moves, no new note
+    buffer.clear();
+    buffer.tie(3, 48, 100, 150000);
+    TEST_ASSERT_EQUAL(1, scheduler.scheduleAll(buffer, now + 50000));
+    TEST_ASSERT_EQUAL(1, scheduler.pending());
+    TEST_ASSERT_FALSE(scheduler.popDue(now + 199999, event));
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 200000, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+
+    // Nothing to extend: the tie starts a note
+    TEST_ASSERT_EQUAL(1, scheduler.scheduleAll(buffer, now + 300000));
+    TEST_ASSERT_EQUAL(2, scheduler.pending());
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 300000, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_ON, event.type);
+    TEST_ASSERT_EQUAL(100, event.data2);
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 450000, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+    TEST_ASSERT_EQUAL(0, event.data2);
+}
+
+void test_scheduler_tick_events_follow_tempo_change() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    unsigned long now = micros();
+
+    // At 120 BPM both are one beat (500 ms) away
+    buffer.setOrigin(3, 0);
+    buffer.noteOnTicks(4, 60, 100, GRUVBOK::Timing::MASTER_PPQN);
+    buffer.noteOffTicks(4, 60, GRUVBOK::Timing::MASTER_PPQN * 2);
+    buffer.noteOn(4, 72, 100, 500000);
+    TEST_ASSERT_TRUE(buffer.isTickTimed(0));
+    TEST_ASSERT_FALSE(buffer.isTickTimed(2));
+    TEST_ASSERT_EQUAL(3, scheduler.scheduleAll(buffer, now));
+    TEST_ASSERT_EQUAL(3, scheduler.pending());
+
+    // Half way there the tempo halves: the rest of the tick-timed wait
+    // takes twice as long, the microsecond event stays put
+    scheduler.setTempo(GRUVBOK::Timing::calculateBeatInterval(60.0f), now + 250000);
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 500000, event));
+    TEST_ASSERT_EQUAL(72, event.data1);
+    TEST_ASSERT_FALSE(scheduler.popDue(now + 749990, event));
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 750010, event));
+    TEST_ASSERT_EQUAL(60, event.data1);
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_ON, event.type);
+    TEST_ASSERT_UINT32_WITHIN(2, now + 750000, event.delta);
+
+    // Pending tick-timed events are cancelled like any other
+    TEST_ASSERT_EQUAL(1, scheduler.pending());
+    TEST_ASSERT_EQUAL(0, scheduler.cancelOrigin(3));   // Off of a started note stays
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 1750010, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getCapacity(), scheduler.getFreeSlots());
+}
+
+void test_scheduler_runs_through_the_32_bit_wrap() {
+    // Two seconds before micros() would wrap, after 71.6 minutes of uptime
+    ManualTimeSource clock(0xFFFFFFFFULL - 2000000);
+    RecordingMIDIPort<128> port;
+    MIDIScheduler<> scheduler(&port);
+    scheduler.setTimeSource(&clock);
+
+    // Notes across the wrap, timed in microseconds and in ticks
+    MIDIEventBuffer<> buffer;
+    uint32_t start = (uint32_t)clock.now();
+    for (uint8_t i = 0; i < 16; i++) {
+        buffer.noteOn(1, 40 + i, 100, i * 250000UL);
+        buffer.noteOff(1, 40 + i, i * 250000UL + 125000);
+    }
+    TEST_ASSERT_EQUAL(32, scheduler.scheduleAll(buffer, start));
+    buffer.clear();
+    for (uint8_t i = 0; i < 16; i++) {
+        uint32_t at = GRUVBOK::Timing::TICKS_PER_STEP * (16 + i);   // 2 s and on
+        buffer.noteOnTicks(2, 40 + i, 100, at);
+        buffer.noteOffTicks(2, 40 + i, at + GRUVBOK::Timing::TICKS_PER_STEP / 2);
+    }
+    TEST_ASSERT_EQUAL(32, scheduler.scheduleAll(buffer, start));
+
+    // Fast-forward in 100 us passes: every message arrives, none early
+    uint16_t seen = 0;
+    while (clock.now() < 0x100000000ULL + 3000000) {
+        clock.advance(100);
+        scheduler.update();
+        uint32_t now = (uint32_t)clock.now();
+        for (; seen < port.size(); seen++) {
+            int32_t late = (int32_t)(now - port[seen].time);
+            TEST_ASSERT_TRUE(late >= 0);
+            TEST_ASSERT_TRUE(late <= 100);
+        }
+    }
+    TEST_ASSERT_EQUAL(64, port.size());
+    TEST_ASSERT_EQUAL(0, scheduler.pending());
+
+    // In time order across the wrap
+    for (uint8_t i = 1; i < 64; i++) {
+        TEST_ASSERT_TRUE((int32_t)(port[i].time - port[i - 1].time) >= 0);
+    }
+    TEST_ASSERT_EQUAL(0, scheduler.getVoices().getTotalVoices());
+}
+
+void test_scheduler_steady_tempo_past_the_anchor_range() {
+    // 60 BPM from power-on, never changed: the tempo anchor stays at 0
+    ManualTimeSource clock(0);
+    RecordingMIDIPort<64> port;
+    MIDIScheduler<> scheduler(&port);
+    scheduler.setTimeSource(&clock);
+    scheduler.setTempo(GRUVBOK::Timing::calculateBeatInterval(60.0f), 0);
+
+    // Play on, one step a second, until 2 s before anchor + 2^31 us
+    const uint32_t start = 0x80000000UL - 2000000;
+    while (clock.now() + 1000000 < start) {
+        scheduler.beginStep((uint32_t)clock.now());
+        scheduler.update();
+        clock.advance(1000000);
+    }
+    clock.set(start);
+    scheduler.beginStep(start);
+
+    // Tick-timed notes, one per 250 ms step, across anchor + 2^31
+    MIDIEventBuffer<> buffer;
+    for (uint8_t i = 0; i < 16; i++) {
+        uint32_t at = GRUVBOK::Timing::TICKS_PER_STEP * i;
+        buffer.noteOnTicks(3, 50 + i, 100, at);
+        buffer.noteOffTicks(3, 50 + i, at + GRUVBOK::Timing::TICKS_PER_STEP / 2);
+    }
+    TEST_ASSERT_EQUAL(32, scheduler.scheduleAll(buffer, start));
+
+    // Every message arrives on time, none stays pending
+    uint16_t seen = 0;
+    while (clock.now() < (uint64_t)start + 5000000) {
+        clock.advance(100);
+        scheduler.update();
+        uint32_t now = (uint32_t)clock.now();
+        for (; seen < port.size(); seen++) {
+            int32_t late = (int32_t)(now - port[seen].time);
+            TEST_ASSERT_TRUE(late >= 0);
+            TEST_ASSERT_TRUE(late <= 101);  // Tick to time conversion rounds by 1 us
+        }
+    }
+    TEST_ASSERT_EQUAL(32, port.size());
+    TEST_ASSERT_EQUAL(0, scheduler.pending());
+    TEST_ASSERT_UINT32_WITHIN(2, start + 15 * 250000UL, port[30].time);  // Last note on
+}
+
+void test_recurrence_rule() {
+    // Chromatic: degrees are semitones, clamped to the MIDI range
+    Recurrence echoes;
+    echoes.root = 120;
+    echoes.degreeStep = 3;
+    TEST_ASSERT_EQUAL(120, echoes.pitchAt(0));
+    TEST_ASSERT_EQUAL(126, echoes.pitchAt(2));
+    TEST_ASSERT_EQUAL(127, echoes.pitchAt(3));
+    echoes.degreeStep = -5;
+    TEST_ASSERT_EQUAL(115, echoes.pitchAt(1));
+
+    // Major scale, down from degree 8, folded into 1 octave
+    Recurrence arp;
+    arp.root = 60;
+    arp.scale = 0x0AB5;                 // C D E F G A B
+    arp.firstDegree = 8;
+    arp.degreeStep = -1;
+    TEST_ASSERT_EQUAL(74, arp.pitchAt(0));   // D5
+    TEST_ASSERT_EQUAL(72, arp.pitchAt(1));
+    TEST_ASSERT_EQUAL(71, arp.pitchAt(2));
+    TEST_ASSERT_EQUAL(59, arp.pitchAt(9));   // Degree -1: B3
+    arp.octaves = 1;
+    TEST_ASSERT_EQUAL(62, arp.pitchAt(0));
+    TEST_ASSERT_EQUAL(71, arp.pitchAt(9));
+
+    // Velocity: scaled, stepped, floored
+    Recurrence fade;
+    fade.velocityScale = 205;
+    fade.minVelocity = 10;
+    TEST_ASSERT_EQUAL(80, fade.nextVelocity(100));
+    TEST_ASSERT_EQUAL(10, fade.nextVelocity(11));
+    fade.velocityScale = 256;
+    fade.velocityStep = -5;
+    fade.minVelocity = 60;
+    TEST_ASSERT_EQUAL(95, fade.nextVelocity(100));
+    TEST_ASSERT_EQUAL(60, fade.nextVelocity(62));
+}
+
+void test_scheduler_generator_expands_when_due() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    unsigned long now = micros();
+
+    Recurrence arp;
+    arp.channel = 5;
+    arp.root = 48;
+    arp.degreeStep = 2;
+    arp.count = 4;
+    arp.velocity = 100;
+    arp.velocityStep = -10;
+    arp.interval = 1000;
+    arp.length = 500;
+    TEST_ASSERT_TRUE(buffer.recur(arp, 200));
+    TEST_ASSERT_EQUAL(1, buffer.size());
+    TEST_ASSERT_EQUAL(1, scheduler.scheduleAll(buffer, now));
+
+    // One slot for the whole run
+    TEST_ASSERT_EQUAL(1, scheduler.pending());
+    TEST_ASSERT_EQUAL(1, scheduler.getActiveGenerators());
+
+    MIDIEvent event;
+    TEST_ASSERT_FALSE(scheduler.popDue(now + 199, event));
+    for (uint8_t i = 0; i < 4; i++) {
+        unsigned long at = now + 200 + i * 1000UL;
+        TEST_ASSERT_TRUE(scheduler.popDue(at, event));
+        TEST_ASSERT_EQUAL(MIDIEvent::NOTE_ON, event.type);
+        TEST_ASSERT_EQUAL(5, event.channel);
+        TEST_ASSERT_EQUAL(48 + 2 * i, event.data1);
+        TEST_ASSERT_EQUAL(100 - 10 * i, event.data2);
+        TEST_ASSERT_EQUAL((uint32_t)at, event.delta);
+        TEST_ASSERT_TRUE(scheduler.pending() <= 2);     // Generator + this note's off
+
+        TEST_ASSERT_FALSE(scheduler.popDue(at + 499, event));
+        TEST_ASSERT_TRUE(scheduler.popDue(at + 500, event));
+        TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+        TEST_ASSERT_EQUAL(48 + 2 * i, event.data1);
+    }
+    TEST_ASSERT_EQUAL(0, scheduler.pending());
+    TEST_ASSERT_EQUAL(0, scheduler.getActiveGenerators());
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getCapacity(), scheduler.getFreeSlots());
+}
+
+void test_scheduler_generator_cancel_and_tempo() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    unsigned long now = micros();
+
+    // Echoes a beat apart, half a beat long, timed in ticks
+    Recurrence echoes;
+    echoes.channel = 4;
+    echoes.count = 8;
+    echoes.interval = GRUVBOK::Timing::MASTER_PPQN;
+    echoes.length = GRUVBOK::Timing::MASTER_PPQN / 2;
+    buffer.setOrigin(3, 1);
+    TEST_ASSERT_TRUE(buffer.recurTicks(echoes));
+    scheduler.scheduleAll(buffer, now);
+
+    MIDIEvent event;
+    TEST_ASSERT_TRUE(scheduler.popDue(now, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_ON, event.type);
+
+    // Tempo halves: the rest of the tail stretches with it
+    scheduler.setTempo(GRUVBOK::Timing::calculateBeatInterval(60.0f), now);
+    TEST_ASSERT_FALSE(scheduler.popDue(now + 499990, event));
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 500010, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+    TEST_ASSERT_FALSE(scheduler.popDue(now + 999990, event));
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 1000010, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_ON, event.type);
+
+    // A pattern change ends the tail; the sounding echo still gets its off
+    TEST_ASSERT_EQUAL(1, scheduler.cancelOrigin(3, 1));
+    TEST_ASSERT_EQUAL(0, scheduler.getActiveGenerators());
+    TEST_ASSERT_EQUAL(1, scheduler.pending());
+    TEST_ASSERT_TRUE(scheduler.popDue(now + 1500010, event));
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_OFF, event.type);
+    TEST_ASSERT_FALSE(scheduler.popDue(now + 100000000, event));
+}
+
+void test_scheduler_generator_limit() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    Recurrence run;
+    run.count = 4;
+    run.interval = 1000000;
+
+    // One past a full pool: the newcomer takes the place of an old tail
+    uint8_t started = 0;
+    for (uint8_t i = 0; i <= MIDIScheduler<>::getMaxGenerators(); i++) {
+        buffer.clear();
+        buffer.recur(run);
+        started += scheduler.scheduleAll(buffer, micros());
+    }
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getMaxGenerators() + 1, started);
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getMaxGenerators(), scheduler.getActiveGenerators());
+    TEST_ASSERT_EQUAL(1, scheduler.getDropCount(MIDIEvent::PRIORITY_NOTE_ON));
+    TEST_ASSERT_EQUAL(1, scheduler.getEvictedCount());
+
+    // Clearing frees them all
+    scheduler.clear();
+    TEST_ASSERT_EQUAL(0, scheduler.getActiveGenerators());
+}
+
+// Plays out from..until in 250 us passes; counts NOTE_ONs and NOTE_OFFs
+// per channel
+static void drainNotes(MIDIScheduler<>& scheduler, unsigned long from, unsigned long until,
+                       uint8_t* ons, uint8_t* offs) {
+    MIDIEvent event;
+    for (unsigned long t = from; (long)(until - t) >= 0; t += 250) {
+        while (scheduler.popDue(t, event)) {
+            if (event.type == MIDIEvent::NOTE_ON) ons[event.channel]++;
+            if (event.type == MIDIEvent::NOTE_OFF) offs[event.channel]++;
+        }
+    }
+}
+
+void test_scheduler_overlapping_tails_all_play() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    unsigned long now = micros();
+
+    // 24 tails alive at once: one on each Mode3 and Mode4 track, and a
+    // second on half of the Mode3 tracks
+    Recurrence tail;
+    tail.count = 4;
+    tail.interval = 100000;
+    tail.length = 50000;
+    uint8_t started = 0;
+    for (uint8_t i = 0; i < 24; i++) {
+        uint8_t mode = i < 8 || i >= 16 ? 3 : 4;
+        tail.channel = mode + 1;
+        buffer.clear();
+        buffer.setOrigin(mode, i % 8);
+        buffer.recur(tail, i * 1000UL);
+        started += scheduler.scheduleAll(buffer, now);
+    }
+    TEST_ASSERT_EQUAL(24, started);
+    TEST_ASSERT_EQUAL(24, scheduler.getActiveGenerators());
+
+    uint8_t ons[17] = {0};
+    uint8_t offs[17] = {0};
+    drainNotes(scheduler, now, now + 1000000, ons, offs);
+    TEST_ASSERT_EQUAL(16 * 4, ons[4]);
+    TEST_ASSERT_EQUAL(8 * 4, ons[5]);
+    TEST_ASSERT_EQUAL(16 * 4, offs[4]);
+    TEST_ASSERT_EQUAL(8 * 4, offs[5]);
+    TEST_ASSERT_EQUAL(0, scheduler.getDropCount(MIDIEvent::PRIORITY_NOTE_ON));
+    TEST_ASSERT_EQUAL(0, scheduler.getActiveGenerators());
+}
+
+void test_scheduler_full_pool_evicts_furthest_along() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    unsigned long now = micros();
+    uint8_t ons[17] = {0};
+    uint8_t offs[17] = {0};
+
+    Recurrence tail;
+    tail.count = 4;
+    tail.interval = 100000;
+    tail.length = 50000;
+
+    // A full pool; the tail on channel 2 has played its first note. The
+    // others are staggered so their notes do not overlap
+    tail.length = 500;
+    for (uint8_t i = 0; i < MIDIScheduler<>::getMaxGenerators(); i++) {
+        tail.channel = i == 5 ? 2 : 1;
+        buffer.clear();
+        buffer.recur(tail, i == 5 ? 0 : 10000 + i * 1000UL);
+        scheduler.scheduleAll(buffer, now);
+    }
+    drainNotes(scheduler, now, now, ons, offs);
+    TEST_ASSERT_EQUAL(1, ons[2]);
+
+    // The next tail replaces it; its sounding note still ends
+    tail.channel = 3;
+    buffer.clear();
+    buffer.recur(tail, 10000);
+    TEST_ASSERT_EQUAL(1, scheduler.scheduleAll(buffer, now));
+    TEST_ASSERT_EQUAL(1, scheduler.getEvictedCount());
+    TEST_ASSERT_EQUAL(MIDIScheduler<>::getMaxGenerators(), scheduler.getActiveGenerators());
+
+    drainNotes(scheduler, now, now + 1000000, ons, offs);
+    TEST_ASSERT_EQUAL(1, ons[2]);
+    TEST_ASSERT_EQUAL(1, offs[2]);
+    TEST_ASSERT_EQUAL((MIDIScheduler<>::getMaxGenerators() - 1) * 4, ons[1]);
+    TEST_ASSERT_EQUAL(4, ons[3]);
+}
+
+void test_scheduler_tails_per_track_limit() {
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    unsigned long now = micros();
+
+    // Two tails on one track, the second quieter, then a third
+    Recurrence tail;
+    tail.count = 4;
+    tail.interval = 100000;
+    tail.length = 50000;
+    const uint8_t velocities[3] = {100, 50, 100};
+    for (uint8_t i = 0; i < 3; i++) {
+        tail.channel = 5 + i;
+        tail.velocity = velocities[i];
+        buffer.clear();
+        buffer.setOrigin(4, 2);
+        buffer.recur(tail, 1000);
+        TEST_ASSERT_EQUAL(1, scheduler.scheduleAll(buffer, now));
+    }
+    TEST_ASSERT_EQUAL(GRUVBOK::MIDI::MAX_TAILS_PER_TRACK, scheduler.getActiveGenerators());
+    TEST_ASSERT_EQUAL(1, scheduler.getEvictedCount());
+
+    // Equally far along, so the quieter one gave way
+    uint8_t ons[17] = {0};
+    uint8_t offs[17] = {0};
+    drainNotes(scheduler, now, now + 1000000, ons, offs);
+    TEST_ASSERT_EQUAL(4, ons[5]);
+    TEST_ASSERT_EQUAL(0, ons[6]);
+    TEST_ASSERT_EQUAL(4, ons[7]);
+}
+
+void test_scheduler_sink_matches_buffered_scheduling() {
+    Mode1_DrumMachine drums(2);
+    Event hit(true, 100, 40, 64, 80);  // Flam + pan: 2 note pairs and a CC
+
+    // Straight into the scheduler...
+    MIDIScheduler<> direct;
+    SchedulerSink sink(direct, 1000);
+    sink.setOrigin(1, 0);
+    drums.processEvent(0, hit, 1000, sink);
+
+    // ...and through a recorded buffer
+    MIDIScheduler<> buffered;
+    MIDIEventBuffer<> buffer;
+    buffer.setOrigin(1, 0);
+    drums.processEvent(0, hit, 1000, buffer);
+    TEST_ASSERT_EQUAL(5, buffer.size());
+    TEST_ASSERT_EQUAL(5, buffered.scheduleAll(buffer, 1000));
+
+    TEST_ASSERT_EQUAL(0, sink.getOverflowCount());
+    TEST_ASSERT_EQUAL(buffered.pending(), direct.pending());
+    MIDIEvent a;
+    MIDIEvent b;
+    while (buffered.popDue(10000000, b)) {
+        TEST_ASSERT_TRUE(direct.popDue(10000000, a));
+        TEST_ASSERT_EQUAL(b.type, a.type);
+        TEST_ASSERT_EQUAL(b.data1, a.data1);
+        TEST_ASSERT_EQUAL(b.data2, a.data2);
+        TEST_ASSERT_EQUAL_UINT32(b.delta, a.delta);
+    }
+    TEST_ASSERT_FALSE(direct.popDue(10000000, a));
+
+    // Origins came along: the pattern change path can cancel them
+    drums.processEvent(0, hit, 1000, sink);
+    TEST_ASSERT_EQUAL(5, direct.cancelOrigin(1, 0));
+}
+
+void test_scheduler_sink_reports_overflow() {
+    MIDIScheduler<> scheduler;
+    scheduler.beginStep(0);
+    SchedulerSink sink(scheduler, 0);
+
+    // More than the pool holds, all one class: nothing can be evicted
+    for (uint8_t i = 0; i < MIDIScheduler<>::getCapacity(); i++) {
+        TEST_ASSERT_TRUE(sink.noteOff(1, i, 1000));
+    }
+    TEST_ASSERT_FALSE(sink.cc(1, 10, 64));
+    TEST_ASSERT_FALSE(sink.noteOff(1, 100, 1000));
+    TEST_ASSERT_EQUAL(2, sink.getOverflowCount());
+    TEST_ASSERT_TRUE(scheduler.hasBackpressure());
+
+    // Invalid channels are refused, not scheduled
+    MIDIScheduler<> empty;
+    SchedulerSink other(empty, 0);
+    TEST_ASSERT_FALSE(other.noteOn(0, 60, 100));
+    TEST_ASSERT_EQUAL(1, other.getOverflowCount());
+    TEST_ASSERT_EQUAL(0, empty.pending());
+}
+
+void test_packed_event_keeps_its_fields() {
+    MIDIEvent event = MIDIEvent::noteOn(16, 127, 127, 0xFFFFFFFFUL);
+    TEST_ASSERT_EQUAL(MIDIEvent::NOTE_ON, event.type);
+    TEST_ASSERT_EQUAL(16, event.channel);
+    TEST_ASSERT_EQUAL(127, event.data1);
+    TEST_ASSERT_EQUAL(127, event.data2);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFFUL, event.delta);
+
+    // Out-of-range channels are not folded onto valid ones
+    MIDIScheduler<> scheduler;
+    MIDIEventBuffer<> buffer;
+    buffer.noteOn(17, 60, 100, 0);
+    buffer.noteOn(0, 60, 100, 0);
+    TEST_ASSERT_EQUAL(17, buffer[0].channel);
+    TEST_ASSERT_EQUAL(0, scheduler.scheduleAll(buffer, 0));
+    TEST_ASSERT_EQUAL(0, scheduler.pending());
+
+    // Origin and time base travel inside the event
+    buffer.clear();
+    buffer.setOrigin(14, 7);
+    buffer.noteOnTicks(1, 60, 100, 24);
+    TEST_ASSERT_EQUAL(MIDIEvent::makeOrigin(14, 7), buffer[0].origin);
+    TEST_ASSERT_TRUE(buffer[0].inTicks);
+}
+
+void test_sized_scheduler_and_buffer() {
+    // Index types follow the capacity
+    TEST_ASSERT_EQUAL(1, sizeof(MIDIScheduler<>::Index));
+    TEST_ASSERT_EQUAL(2, sizeof(MIDIScheduler<1000>::Index));
+    TEST_ASSERT_EQUAL(1, sizeof(MIDIEventBuffer<>::Index));
+    TEST_ASSERT_EQUAL(2, sizeof(MIDIEventBuffer<300>::Index));
+
+    // A large pool takes more than 255 events, and a buffer of 300 too
+    static MIDIScheduler<1000, RejectWhenFull> big;
+    static MIDIEventBuffer<300> buffer;
+    for (uint16_t i = 0; i < 300; i++) {
+        buffer.noteOn(1 + i % 16, i % 128, 100, 1000 + i);
+    }
+    TEST_ASSERT_EQUAL(300, buffer.size());
+    TEST_ASSERT_EQUAL(300, big.scheduleAll(buffer, 0));
+    TEST_ASSERT_EQUAL(300, big.pending());
+
+    // Handles reach slots beyond 255
+    MIDIScheduler<1000, RejectWhenFull>::Handle last = big.off(1, 60, 5000);
+    TEST_ASSERT_TRUE(last.slot > 255);
+    TEST_ASSERT_TRUE(big.cancel(last));
+
+    // Events come out in time order across the whole pool
+    MIDIEvent event;
+    uint16_t popped = 0;
+    uint32_t previous = 0;
+    while (big.popDue(100000, event)) {
+        TEST_ASSERT_TRUE(event.delta >= previous);
+        previous = event.delta;
+        popped++;
+    }
+    TEST_ASSERT_EQUAL(300, popped);
+}
+
+void test_reject_when_full_never_evicts() {
+    MIDIScheduler<4, RejectWhenFull> scheduler;
+    for (uint8_t i = 0; i < 4; i++) {
+        TEST_ASSERT_FALSE(scheduler.cc(1, i, 64, 1000).isNone());
+    }
+
+    // Even a NOTE_OFF is dropped rather than displacing a CC
+    TEST_ASSERT_TRUE(scheduler.off(1, 60, 500).isNone());
+    TEST_ASSERT_EQUAL(1, scheduler.getDropCount(MIDIEvent::PRIORITY_NOTE_OFF));
+    TEST_ASSERT_EQUAL(0, scheduler.getEvictedCount());
+    TEST_ASSERT_EQUAL(4, scheduler.pending());
+
+    // The default policy evicts one of the CCs instead
+    MIDIScheduler<4> evicting;
+    for (uint8_t i = 0; i < 4; i++) {
+        evicting.cc(1, i, 64, 1000);
+    }
+    TEST_ASSERT_FALSE(evicting.off(1, 60, 500).isNone());
+    TEST_ASSERT_EQUAL(1, evicting.getEvictedCount());
+}
+
 void setup() {
     UNITY_BEGIN();
 
@@ -213,6 +1272,40 @@ void setup() {
     RUN_TEST(test_scheduler_event_interleaving);
     RUN_TEST(test_scheduler_clear_after_scheduling);
     RUN_TEST(test_scheduler_boundary_values);
+    RUN_TEST(test_data_bytes_clamp_instead_of_wrapping);
+    RUN_TEST(test_scheduler_pops_in_time_order);
+    RUN_TEST(test_scheduler_same_time_is_fifo);
+    RUN_TEST(test_scheduler_capacity_and_reuse);
+    RUN_TEST(test_scheduler_hands_lookahead_to_dispatcher);
+    RUN_TEST(test_scheduler_logical_time_absorbs_lateness);
+    RUN_TEST(test_scheduler_flam_off_does_not_cut_main_hit);
+    RUN_TEST(test_scheduler_full_pool_never_drops_note_off);
+    RUN_TEST(test_scheduler_overflow_evicts_lowest_priority_furthest_future);
+    RUN_TEST(test_scheduler_reports_backpressure);
+    RUN_TEST(test_scheduler_backpressure_scales_with_capacity);
+    RUN_TEST(test_scheduler_panic_sends_exact_note_offs);
+    RUN_TEST(test_scheduler_polyphony_limit);
+    RUN_TEST(test_scheduler_marks_message_priority);
+    RUN_TEST(test_scheduler_polled_output_to_port);
+    RUN_TEST(test_scheduler_handle_cancel_and_retime);
+    RUN_TEST(test_scheduler_cancel_origin_cuts_tails);
+    RUN_TEST(test_scheduler_cancel_channel);
+    RUN_TEST(test_scheduler_tie_extends_pending_note_off);
+    RUN_TEST(test_scheduler_tick_events_follow_tempo_change);
+    RUN_TEST(test_scheduler_runs_through_the_32_bit_wrap);
+    RUN_TEST(test_scheduler_steady_tempo_past_the_anchor_range);
+    RUN_TEST(test_recurrence_rule);
+    RUN_TEST(test_scheduler_generator_expands_when_due);
+    RUN_TEST(test_scheduler_generator_cancel_and_tempo);
+    RUN_TEST(test_scheduler_generator_limit);
+    RUN_TEST(test_scheduler_overlapping_tails_all_play);
+    RUN_TEST(test_scheduler_full_pool_evicts_furthest_along);
+    RUN_TEST(test_scheduler_tails_per_track_limit);
+    RUN_TEST(test_scheduler_sink_matches_buffered_scheduling);
+    RUN_TEST(test_scheduler_sink_reports_overflow);
+    RUN_TEST(test_packed_event_keeps_its_fields);
+    RUN_TEST(test_sized_scheduler_and_buffer);
+    RUN_TEST(test_reject_when_full_never_evicts);
 
     UNITY_END();
 }
@@ -1,5 +1,11 @@
 #include <unity.h>
+#include "../src/modes/ModeList.h"
+#include "../src/modes/Mode0_PatternSequencer.h"
 #include "../src/modes/Mode1_DrumMachine.h"
+#include "../src/modes/Mode2_AcidBass.h"
+#include "../src/modes/Mode3_EuclideanFade.h"
+#include "../src/modes/Mode4_MetaArp.h"
+#include "../src/modes/Mode5_BasslineProgression.h"
 #include "../src/core/MIDIEvent.h"
 
 // Test that modes are truly pure functions with no side effects
@@ -11,10 +17,10 @@ void test_mode_pure_functional_deterministic() {
     Event event(true, 100, 20, 50, 64);  // Switch on, velocity=100, flam=20, length=50, pan=64
 
     // Process event twice with same inputs
-    MIDIEventBuffer buffer1;
+    MIDIEventBuffer<> buffer1;
     mode.processEvent(0, event, 1000, buffer1);
 
-    MIDIEventBuffer buffer2;
+    MIDIEventBuffer<> buffer2;
     mode.processEvent(0, event, 1000, buffer2);
 
     // Should produce identical results (deterministic)
@@ -37,7 +43,7 @@ void test_mode_produces_events_not_side_effects() {
     Event event(true, 127, 0, 64, 64);  // max velocity, no flam, medium length, center pan
 
     // Process event
-    MIDIEventBuffer buffer;
+    MIDIEventBuffer<> buffer;
     mode.processEvent(0, event, 0, buffer);
 
     // Should produce events in buffer (not schedule directly)
@@ -63,13 +69,31 @@ void test_mode_switch_off_produces_no_events() {
     Event event(false, 100, 0, 64, 64);
 
     // Process event
-    MIDIEventBuffer buffer;
+    MIDIEventBuffer<> buffer;
     mode.processEvent(0, event, 0, buffer);
 
     // Should produce no events
     TEST_ASSERT_EQUAL(0, buffer.size());
 }
 
+void test_midieventbuffer_reports_overflow() {
+    MIDIEventBuffer<> buffer;
+
+    for (uint8_t i = 0; i < MIDIEventBuffer<>::getMaxEvents(); i++) {
+        TEST_ASSERT_TRUE(buffer.noteOn(1, i, 100, 0));
+    }
+    TEST_ASSERT_EQUAL(0, buffer.getOverflowCount());
+
+    // Nothing past the end is kept, but every lost write is counted
+    TEST_ASSERT_FALSE(buffer.noteOff(1, 0, 100));
+    TEST_ASSERT_FALSE(buffer.cc(1, 10, 64, 0));
+    TEST_ASSERT_EQUAL(MIDIEventBuffer<>::getMaxEvents(), buffer.size());
+    TEST_ASSERT_EQUAL(2, buffer.getOverflowCount());
+
+    buffer.clear();
+    TEST_ASSERT_EQUAL(0, buffer.getOverflowCount());
+}
+
 void test_mode_flam_produces_multiple_notes() {
     Mode1_DrumMachine mode(2);
 
@@ -77,7 +101,7 @@ void test_mode_flam_produces_multiple_notes() {
     Event event(true, 100, 64, 50, 0);  // Velocity=100, flam=64, length=50, no pan
 
     // Process event
-    MIDIEventBuffer buffer;
+    MIDIEventBuffer<> buffer;
     mode.processEvent(0, event, 0, buffer);
 
     // Should produce 4 events: flam note on/off + main note on/off
@@ -103,7 +127,7 @@ void test_mode_pan_produces_cc_event() {
     Event event(true, 100, 0, 50, 80);  // Velocity=100, no flam, length=50, pan=80
 
     // Process event
-    MIDIEventBuffer buffer;
+    MIDIEventBuffer<> buffer;
     mode.processEvent(0, event, 0, buffer);
 
     // Should produce note on, note off, and CC for pan
@@ -126,7 +150,7 @@ void test_mode_correct_channel() {
 
     Event event(true, 100, 0, 50, 0);
 
-    MIDIEventBuffer buffer;
+    MIDIEventBuffer<> buffer;
     mode.processEvent(0, event, 0, buffer);
 
     // All events should be on channel 5
@@ -142,7 +166,7 @@ void test_mode_correct_drum_notes() {
     Event snareEvent(true, 100, 0, 50, 0);
 
     // Track 0 = Kick (note 36)
-    MIDIEventBuffer kickBuffer;
+    MIDIEventBuffer<> kickBuffer;
     mode.processEvent(0, kickEvent, 0, kickBuffer);
     bool hasKick = false;
     for (uint8_t i = 0; i < kickBuffer.size(); i++) {
@@ -153,7 +177,7 @@ void test_mode_correct_drum_notes() {
     TEST_ASSERT_TRUE(hasKick);
 
     // Track 1 = Snare (note 38)
-    MIDIEventBuffer snareBuffer;
+    MIDIEventBuffer<> snareBuffer;
     mode.processEvent(1, snareEvent, 0, snareBuffer);
     bool hasSnare = false;
     for (uint8_t i = 0; i < snareBuffer.size(); i++) {
@@ -171,10 +195,10 @@ void test_mode_buffer_isolation() {
     Event event2(true, 110, 0, 60, 0);
 
     // Process into separate buffers
-    MIDIEventBuffer buffer1;
+    MIDIEventBuffer<> buffer1;
     mode.processEvent(0, event1, 0, buffer1);
 
-    MIDIEventBuffer buffer2;
+    MIDIEventBuffer<> buffer2;
     mode.processEvent(0, event2, 0, buffer2);
 
     // Buffers should be independent
@@ -194,7 +218,7 @@ void test_mode_buffer_isolation() {
 }
 
 void test_midieventbuffer_operations() {
-    MIDIEventBuffer buffer;
+    MIDIEventBuffer<> buffer;
 
     TEST_ASSERT_TRUE(buffer.isEmpty());
     TEST_ASSERT_EQUAL(0, buffer.size());
@@ -219,6 +243,120 @@ void test_midieventbuffer_operations() {
     TEST_ASSERT_EQUAL(0, buffer.size());
 }
 
+void test_mode3_echo_tail_is_one_recurrence() {
+    Mode3_EuclideanFade mode(4);
+    Event event(true, 64, 64, 127, 80);   // Pitch, 8 steps apart, 8 echoes, +3 semitones
+
+    MIDIEventBuffer<> buffer;
+    mode.processEvent(0, event, 0, buffer);
+
+    TEST_ASSERT_EQUAL(1, buffer.size());
+    TEST_ASSERT_EQUAL(MIDIEvent::RECUR, buffer[0].type);
+    TEST_ASSERT_TRUE(buffer.isTickTimed(0));
+
+    const Recurrence& echoes = buffer.getRecurrence(buffer[0].data1);
+    TEST_ASSERT_EQUAL(8, echoes.count);
+    TEST_ASSERT_EQUAL(2, echoes.growth);
+    TEST_ASSERT_EQUAL(echoes.root + 3, echoes.pitchAt(1));
+    TEST_ASSERT_EQUAL(80, echoes.nextVelocity(100));
+}
+
+void test_mode4_arp_alternates_direction() {
+    Mode4_MetaArp mode(5);
+    Event event(true, 50, 0, 64, 40);     // Major scale, 6 notes
+
+    MIDIEventBuffer<> up;
+    mode.processEvent(2, event, 0, up);
+    MIDIEventBuffer<> down;
+    mode.processEvent(2, event, 0, down);
+
+    TEST_ASSERT_EQUAL(1, up.size());
+    TEST_ASSERT_EQUAL(MIDIEvent::RECUR, up[0].type);
+    const Recurrence& first = up.getRecurrence(0);
+    const Recurrence& second = down.getRecurrence(0);
+    TEST_ASSERT_EQUAL(first.count, second.count);
+    for (uint8_t i = 0; i < first.count; i++) {
+        TEST_ASSERT_EQUAL(first.pitchAt(i), second.pitchAt(first.count - 1 - i));
+    }
+    TEST_ASSERT_EQUAL(first.root + 2, first.pitchAt(1));    // Major second
+}
+
+// Most scheduler slots (a TIE counts two) and recurrences one render()
+// produced, over every track and a grid of slider values
+template<typename M>
+static uint8_t observedWorstCase(M& mode, uint8_t& recurrences) {
+    static const uint8_t values[] = {0, 1, 17, 64, 100, 127};
+    uint8_t worst = 0;
+    recurrences = 0;
+    for (uint8_t track = 0; track < 8; track++) {
+        for (uint16_t combo = 0; combo < 6 * 6 * 6 * 6; combo++) {
+            Event event(true, values[combo % 6], values[combo / 6 % 6],
+                        values[combo / 36 % 6], values[combo / 216]);
+            MIDIEventBuffer<> buffer;
+            mode.processEvent(track, event, 0, buffer);
+
+            uint8_t slots = buffer.size();
+            uint8_t recurs = 0;
+            for (uint8_t i = 0; i < buffer.size(); i++) {
+                if (buffer[i].type == MIDIEvent::TIE) slots++;
+                if (buffer[i].type == MIDIEvent::RECUR) recurs++;
+            }
+            if (slots > worst) worst = slots;
+            if (recurs > recurrences) recurrences = recurs;
+        }
+    }
+    return worst;
+}
+
+void test_mode_event_bounds_hold() {
+    // Declared bounds are exact: reached, never exceeded
+    uint8_t recurrences;
+    Mode0_PatternSequencer mode0(1);
+    TEST_ASSERT_EQUAL(Mode0_PatternSequencer::MAX_EVENTS, observedWorstCase(mode0, recurrences));
+    TEST_ASSERT_EQUAL(Mode0_PatternSequencer::MAX_RECURRENCES, recurrences);
+    Mode1_DrumMachine mode1(2);
+    TEST_ASSERT_EQUAL(Mode1_DrumMachine::MAX_EVENTS, observedWorstCase(mode1, recurrences));
+    TEST_ASSERT_EQUAL(Mode1_DrumMachine::MAX_RECURRENCES, recurrences);
+    Mode2_AcidBass mode2(3);
+    TEST_ASSERT_EQUAL(Mode2_AcidBass::MAX_EVENTS, observedWorstCase(mode2, recurrences));
+    TEST_ASSERT_EQUAL(Mode2_AcidBass::MAX_RECURRENCES, recurrences);
+    Mode3_EuclideanFade mode3(4);
+    TEST_ASSERT_EQUAL(Mode3_EuclideanFade::MAX_EVENTS, observedWorstCase(mode3, recurrences));
+    TEST_ASSERT_EQUAL(Mode3_EuclideanFade::MAX_RECURRENCES, recurrences);
+    Mode4_MetaArp mode4(5);
+    TEST_ASSERT_EQUAL(Mode4_MetaArp::MAX_EVENTS, observedWorstCase(mode4, recurrences));
+    TEST_ASSERT_EQUAL(Mode4_MetaArp::MAX_RECURRENCES, recurrences);
+    Mode5_BasslineProgression mode5(6);
+    TEST_ASSERT_EQUAL(Mode5_BasslineProgression::MAX_EVENTS, observedWorstCase(mode5, recurrences));
+    TEST_ASSERT_EQUAL(Mode5_BasslineProgression::MAX_RECURRENCES, recurrences);
+
+    // A full step of all six: 8 tracks x (0 + 5 + 4 + 1 + 1 + 8)
+    typedef ModeList<Mode0_PatternSequencer, Mode1_DrumMachine, Mode2_AcidBass,
+                     Mode3_EuclideanFade, Mode4_MetaArp, Mode5_BasslineProgression> Modes;
+    TEST_ASSERT_EQUAL(6, Modes::COUNT);
+    TEST_ASSERT_EQUAL(8, Modes::MAX_EVENTS_PER_CALL);
+    TEST_ASSERT_EQUAL(152, Modes::MAX_EVENTS_PER_STEP);
+    TEST_ASSERT_EQUAL(16, Modes::MAX_RECURRENCES_PER_STEP);
+
+    // Tails outlive their step: up to MAX_TAILS_PER_TRACK on each Mode3
+    // and Mode4 track
+    TEST_ASSERT_EQUAL(2 * 8 * GRUVBOK::MIDI::MAX_TAILS_PER_TRACK, Modes::MAX_LIVE_RECURRENCES);
+
+    // Mode0 never emits; Mode2 needs its idle steps (slide reset)
+    TEST_ASSERT_EQUAL(0x0001, Modes::SILENT_MODES);
+    TEST_ASSERT_EQUAL(0x0004, Modes::IDLE_STEP_MODES);
+
+    // create() puts mode i on channel i + 1
+    Mode* slots[6];
+    Modes::create(slots);
+    TEST_ASSERT_EQUAL(1, slots[0]->getChannel());
+    TEST_ASSERT_EQUAL(6, slots[5]->getChannel());
+    TEST_ASSERT_EQUAL_STRING(mode5.getName(), slots[5]->getName());
+    for (uint8_t i = 0; i < 6; i++) {
+        delete slots[i];
+    }
+}
+
 void setup() {
     UNITY_BEGIN();
 
@@ -231,6 +369,10 @@ void setup() {
     RUN_TEST(test_mode_correct_drum_notes);
     RUN_TEST(test_mode_buffer_isolation);
     RUN_TEST(test_midieventbuffer_operations);
+    RUN_TEST(test_midieventbuffer_reports_overflow);
+    RUN_TEST(test_mode3_echo_tail_is_one_recurrence);
+    RUN_TEST(test_mode4_arp_alternates_direction);
+    RUN_TEST(test_mode_event_bounds_hold);
 
     UNITY_END();
 }
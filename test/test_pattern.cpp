@@ -31,7 +31,7 @@ void test_pattern_get_track() {
     Pattern pattern;
 
     // Get track reference and modify
-    Track& track = pattern.getTrack(2);
+    Pattern::TrackRef track = pattern.getTrack(2);
     track[5].setSwitch(true);
     track[5].setPot(1, 127);
 
@@ -96,9 +96,77 @@ void test_pattern_get_num_tracks() {
     TEST_ASSERT_EQUAL(8, Pattern::getNumTracks());
 }
 
+void test_pattern_step_tracks() {
+    Pattern pattern;
+
+    for (uint8_t s = 0; s < 16; s++) {
+        TEST_ASSERT_EQUAL(0, pattern.getStepTracks(s));
+    }
+
+    // Column 4 of the switch plane
+    pattern[0][4].setSwitch(true);
+    pattern[3][4].setSwitch(true);
+    pattern[7][4].setSwitch(true);
+    pattern[3][5].setSwitch(true);
+    TEST_ASSERT_EQUAL(0x89, pattern.getStepTracks(4));
+    TEST_ASSERT_EQUAL(0x08, pattern.getStepTracks(5));
+    TEST_ASSERT_EQUAL(0x00, pattern.getStepTracks(6));
+
+    // Wrapped step index, and turning a switch off
+    pattern[0][4].toggleSwitch();
+    TEST_ASSERT_EQUAL(0x88, pattern.getStepTracks(20));
+}
+
+void test_pattern_step_major_matches_track_major() {
+    BasicPattern<TrackMajor> byTrack;
+    BasicPattern<StepMajor> byStep;
+
+    // Same writes through the same accessors
+    for (uint8_t t = 0; t < 8; t++) {
+        for (uint8_t s = t; s < 16; s += 3) {
+            byTrack[t][s] = Event(true, t, s, 0, 127);
+            byStep[t][s] = Event(true, t, s, 0, 127);
+        }
+    }
+    byTrack.getTrack(4)[7].toggleSwitch();
+    byStep.getTrack(4)[7].toggleSwitch();
+    byTrack[6].clear();
+    byStep[6].clear();
+
+    for (uint8_t t = 0; t < 8; t++) {
+        TEST_ASSERT_EQUAL(byTrack[t].getSwitchMask(), byStep[t].getSwitchMask());
+        TEST_ASSERT_EQUAL(byTrack[t].countActiveEvents(), byStep[t].countActiveEvents());
+        for (uint8_t s = 0; s < 16; s++) {
+            TEST_ASSERT_EQUAL(byTrack[t][s].getRaw(), byStep[t][s].getRaw());
+        }
+    }
+    for (uint8_t s = 0; s < 16; s++) {
+        TEST_ASSERT_EQUAL(byTrack.getStepTracks(s), byStep.getStepTracks(s));
+    }
+
+    byStep.clear();
+    TEST_ASSERT_FALSE(byStep.hasActiveEvents());
+    TEST_ASSERT_TRUE(byStep[5][3].isEmpty());
+}
+
+void test_pattern_step_major_step_is_one_line() {
+    BasicPattern<StepMajor> pattern;
+    const BasicPattern<StepMajor>& view = pattern;
+
+    // A step's 8 tracks are adjacent and start on a 32-byte boundary
+    for (uint8_t s = 0; s < 16; s++) {
+        const char* first = (const char*)&view[0][s];
+        TEST_ASSERT_EQUAL(0, (uintptr_t)first % 32);
+        for (uint8_t t = 1; t < 8; t++) {
+            TEST_ASSERT_EQUAL(t * sizeof(Event), (const char*)&view[t][s] - first);
+        }
+    }
+    TEST_ASSERT_EQUAL(sizeof(BasicPattern<TrackMajor>), sizeof(BasicPattern<StepMajor>));
+}
+
 void test_pattern_memory_size() {
-    // Pattern should be 8 tracks × 64 bytes = 512 bytes
-    TEST_ASSERT_EQUAL(512, sizeof(Pattern));
+    // Pattern should be 8 tracks × 68 bytes = 544 bytes
+    TEST_ASSERT_EQUAL(544, sizeof(Pattern));
 }
 
 void test_pattern_multiple_events_per_track() {
@@ -131,6 +199,9 @@ void setup() {
     RUN_TEST(test_pattern_has_active_events);
     RUN_TEST(test_pattern_index_wrapping);
     RUN_TEST(test_pattern_get_num_tracks);
+    RUN_TEST(test_pattern_step_tracks);
+    RUN_TEST(test_pattern_step_major_matches_track_major);
+    RUN_TEST(test_pattern_step_major_step_is_one_line);
     RUN_TEST(test_pattern_memory_size);
     RUN_TEST(test_pattern_multiple_events_per_track);
 
@@ -99,8 +99,8 @@ void test_song_constants() {
 }
 
 void test_song_memory_size() {
-    // Song should be 15 modes × 32 patterns × 512 bytes = 245,760 bytes
-    size_t expectedSize = 15 * 32 * 512;
+    // Song should be 15 modes × 32 patterns × 544 bytes = 261,120 bytes
+    size_t expectedSize = 15 * 32 * 544;
     TEST_ASSERT_EQUAL(expectedSize, Song::getMemorySize());
 
     // Verify actual sizeof matches expected
@@ -169,6 +169,48 @@ void test_song_multi_mode_song() {
     }
 }
 
+void test_song_occupancy_follows_switches() {
+    Song song;
+
+    TEST_ASSERT_EQUAL(0x00, song.getLiveTracks(1, 0, 4));
+
+    song.getPattern(1, 0)[0][4].setSwitch(true);
+    song.getPattern(1, 0)[3][4].setSwitch(true);
+    TEST_ASSERT_EQUAL(0x09, song.getLiveTracks(1, 0, 4));
+
+    song.getPattern(1, 0)[0][4].toggleSwitch();
+    song.getPattern(1, 0).getTrack(7).getEvent(4).toggleSwitch();
+    TEST_ASSERT_EQUAL(0x88, song.getLiveTracks(1, 0, 4));
+
+    // Other steps, patterns and modes stay empty
+    TEST_ASSERT_EQUAL(0x00, song.getLiveTracks(1, 0, 5));
+    TEST_ASSERT_EQUAL(0x00, song.getLiveTracks(1, 1, 4));
+    TEST_ASSERT_EQUAL(0x00, song.getLiveTracks(2, 0, 4));
+
+    song.clear();
+    TEST_ASSERT_EQUAL(0x00, song.getLiveTracks(1, 0, 4));
+}
+
+void test_song_occupancy_matches_events() {
+    Song song;
+
+    song.getPattern(5, 12)[2][15].setSwitch(true);
+    song.getPattern(5, 12)[6][15].setSwitch(true);
+    song.getPattern(5, 12)[6][0] = Event(true, 64, 0, 0, 0);
+    TEST_ASSERT_EQUAL(0x44, song.getLiveTracks(5, 12, 15));
+    TEST_ASSERT_EQUAL(0x40, song.getLiveTracks(5, 12, 0));
+
+    // Every bit matches its switch
+    for (uint8_t p = 0; p < 32; p++) {
+        for (uint8_t s = 0; s < 16; s++) {
+            for (uint8_t t = 0; t < 8; t++) {
+                bool bit = (song.getLiveTracks(5, p, s) >> t) & 1;
+                TEST_ASSERT_EQUAL(song.getPattern(5, p)[t][s].getSwitch(), bit);
+            }
+        }
+    }
+}
+
 void setup() {
     UNITY_BEGIN();
 
@@ -182,6 +224,8 @@ void setup() {
     RUN_TEST(test_song_memory_size);
     RUN_TEST(test_song_full_pattern_programming);
     RUN_TEST(test_song_multi_mode_song);
+    RUN_TEST(test_song_occupancy_follows_switches);
+    RUN_TEST(test_song_occupancy_matches_events);
 
     UNITY_END();
 }
@@ -0,0 +1,101 @@
+#include <unity.h>
+#include "../src/sequencer/TempoMap.h"
+
+static const uint32_t BEAT = TempoMap::ticks(GRUVBOK::Timing::MASTER_PPQN);
+
+void test_default_tempo() {
+    TempoMap tempo;
+
+    // 120 BPM: one beat every 500 ms
+    TEST_ASSERT_EQUAL_UINT32(0, tempo.positionAt(0));
+    TEST_ASSERT_EQUAL_UINT32(BEAT, tempo.positionAt(500000));
+    TEST_ASSERT_EQUAL_UINT32(500000, tempo.timeAt(BEAT));
+    TEST_ASSERT_EQUAL_UINT32(250000, tempo.timeAt(BEAT / 2));
+}
+
+void test_tempo_change_keeps_position() {
+    TempoMap tempo;
+    tempo.setBeatInterval(GRUVBOK::Timing::calculateBeatInterval(60.0f), 250000);
+
+    // Half a beat done at the old tempo, the other half takes 500 ms
+    TEST_ASSERT_EQUAL_UINT32(BEAT / 2, tempo.positionAt(250000));
+    TEST_ASSERT_EQUAL_UINT32(750000, tempo.timeAt(BEAT));
+    TEST_ASSERT_EQUAL_UINT32(BEAT * 2, tempo.positionAt(1750000));
+
+    // Back to 120 BPM later on
+    tempo.setBeatInterval(GRUVBOK::Timing::calculateBeatInterval(120.0f), 1750000);
+    TEST_ASSERT_EQUAL_UINT32(2250000, tempo.timeAt(BEAT * 3));
+}
+
+void test_round_trip_is_within_a_unit() {
+    TempoMap tempo;
+    tempo.setBeatInterval(GRUVBOK::Timing::calculateBeatInterval(137.0f), 1000);
+
+    for (uint32_t t = 1000; t < 20000000; t += 123457) {
+        uint32_t back = tempo.timeAt(tempo.positionAt(t));
+        TEST_ASSERT_UINT32_WITHIN(2, t, back);  // A position unit is ~1.1 us here
+    }
+}
+
+void test_wraps_with_the_clock() {
+    TempoMap tempo;
+    uint32_t start = 0xFFFFFF00;
+    tempo.setBeatInterval(GRUVBOK::Timing::calculateBeatInterval(120.0f), start);
+
+    uint32_t position = tempo.positionAt(start);
+    TEST_ASSERT_EQUAL_UINT32(position + BEAT, tempo.positionAt(start + 500000));  // micros() wrapped
+    TEST_ASSERT_EQUAL_UINT32(start + 500000, tempo.timeAt(position + BEAT));
+}
+
+// Expected position after a whole number of beats; the map may be off by
+// the sub-unit rounding of each re-anchor
+static void checkSteadyTempo(float bpm, uint64_t duration, uint32_t beatMicros) {
+    TempoMap tempo;
+    tempo.setBeatInterval(GRUVBOK::Timing::calculateBeatInterval(bpm), 0);
+
+    // Followed once a beat, like the scheduler's steps do, well past the
+    // 2^31 range of the original anchor
+    uint32_t beats = 0;
+    for (uint64_t t = 0; t <= duration; t += beatMicros, beats++) {
+        uint32_t now = (uint32_t)t;
+        tempo.follow(now);
+        uint32_t position = tempo.positionAt(now);
+        // Signed differences, so the check itself survives the wrap
+        TEST_ASSERT_INT_WITHIN(8, 0, (int32_t)(position - beats * BEAT));
+        TEST_ASSERT_INT_WITHIN(8, 0, (int32_t)(tempo.timeAt(position + BEAT) - (now + beatMicros)));
+    }
+}
+
+void test_steady_tempo_past_the_anchor_range() {
+    // 60 BPM: time passes anchor + 2^31 us (35.8 min) and micros() wraps
+    checkSteadyTempo(60.0f, 0x100000000ULL + 60000000ULL, 1000000);
+
+    // 800 BPM: the position runs out of range first (after ~7 minutes)
+    checkSteadyTempo(800.0f, 1200000000ULL, 75000);
+}
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_default_tempo);
+    RUN_TEST(test_tempo_change_keeps_position);
+    RUN_TEST(test_round_trip_is_within_a_unit);
+    RUN_TEST(test_wraps_with_the_clock);
+    RUN_TEST(test_steady_tempo_past_the_anchor_range);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
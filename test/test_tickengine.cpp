@@ -0,0 +1,228 @@
+#include <unity.h>
+#include "../src/core/SPSCQueue.h"
+#include "../src/sequencer/TickEngine.h"
+#include "../src/platform/TimerInterrupt.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+static uint32_t nowMicros() { return micros(); }
+static void busyWait(uint32_t us) { delayMicroseconds(us); }
+#else
+#include <chrono>
+#include <thread>
+static uint32_t nowMicros() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static void busyWait(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+#endif
+
+// ============================================================================
+// SPSCQueue
+// ============================================================================
+
+void test_queue_fifo_and_capacity() {
+    SPSCQueue<uint32_t, 8> queue;
+    uint32_t value;
+
+    TEST_ASSERT_EQUAL(7, queue.getCapacity());
+    TEST_ASSERT_FALSE(queue.pop(value));
+
+    // Run around the ring a few times
+    for (uint32_t round = 0; round < 5; round++) {
+        for (uint32_t i = 0; i < 7; i++) {
+            TEST_ASSERT_TRUE(queue.push(round * 10 + i));
+        }
+        TEST_ASSERT_FALSE(queue.push(99));  // Full
+        TEST_ASSERT_EQUAL(7, queue.size());
+
+        for (uint32_t i = 0; i < 7; i++) {
+            TEST_ASSERT_TRUE(queue.pop(value));
+            TEST_ASSERT_EQUAL(round * 10 + i, value);
+        }
+        TEST_ASSERT_TRUE(queue.isEmpty());
+    }
+}
+
+#ifndef ARDUINO
+void test_queue_concurrent_producer_consumer() {
+    static SPSCQueue<uint32_t, 64> queue;
+    const uint32_t COUNT = 200000;
+
+    std::thread producer([]() {
+        for (uint32_t i = 0; i < COUNT; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();  // Wait for the consumer to make room
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool inOrder = true;
+    while (expected < COUNT) {
+        uint32_t value;
+        if (queue.pop(value)) {
+            if (value != expected) inOrder = false;
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(inOrder);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+}
+#endif
+
+// ============================================================================
+// TickEngine (interrupt calls simulated)
+// ============================================================================
+
+void test_engine_idle_until_started() {
+    TickEngine engine;
+    TickEvent tick;
+
+    engine.onInterrupt(10000000);
+    TEST_ASSERT_FALSE(engine.poll(tick));
+}
+
+void test_engine_queues_only_step_ticks() {
+    TickEngine engine;
+    engine.setTempo(120.0f);
+    engine.start(1000);
+    TickEvent tick;
+
+    // Clock pulses go back to the interrupt to send, not into the queue
+    TEST_ASSERT_EQUAL(5, engine.onInterrupt(1000 + 124999));
+    TEST_ASSERT_FALSE(engine.poll(tick));
+
+    // Sixth pulse is also the first step, at the exact ideal time
+    TEST_ASSERT_EQUAL(1, engine.onInterrupt(1000 + 125000));
+    TEST_ASSERT_TRUE(engine.poll(tick));
+    TEST_ASSERT_EQUAL(24, tick.tick);
+    TEST_ASSERT_EQUAL(1000UL + 125000UL, tick.time);
+    TEST_ASSERT_FALSE(engine.poll(tick));
+}
+
+void test_engine_restart_drops_stale_ticks() {
+    TickEngine engine;
+    engine.start(0);
+    engine.onInterrupt(500000);  // Queue two beats of ticks
+
+    engine.start(500000);
+    TickEvent tick = {};
+    TEST_ASSERT_FALSE(engine.poll(tick));
+
+    engine.onInterrupt(500000 + 125000);
+    uint8_t steps = 0;
+    while (engine.poll(tick)) {
+        steps++;
+    }
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_EQUAL(24, tick.tick);
+}
+
+void test_engine_stop_and_overflow() {
+    TickEngine engine;
+    engine.start(0);
+
+    // Main loop never polls: the queue fills and the rest is counted
+    engine.onInterrupt(10000000);  // 10 s = 80 steps
+    TEST_ASSERT_EQUAL(80 - (TickEngine::QUEUE_SIZE - 1), engine.getOverflowCount());
+
+    // The first step after the gap shows how many were lost
+    TickEvent tick;
+    for (uint8_t i = 0; i < TickEngine::QUEUE_SIZE - 1; i++) {
+        TEST_ASSERT_TRUE(engine.poll(tick));
+    }
+    engine.onInterrupt(10000000 + 125000);
+    TEST_ASSERT_TRUE(engine.poll(tick));
+    TEST_ASSERT_EQUAL(81UL * GRUVBOK::Timing::TICKS_PER_STEP, tick.tick);
+
+    engine.stop();
+    engine.onInterrupt(20000000);
+    TEST_ASSERT_EQUAL(80 - (TickEngine::QUEUE_SIZE - 1), engine.getOverflowCount());
+}
+
+// ============================================================================
+// TickEngine driven by the timer interrupt, main loop under load
+// ============================================================================
+
+static TickEngine liveEngine;
+
+static void onLiveTick() {
+    liveEngine.onInterrupt(nowMicros());
+}
+
+void test_engine_timing_independent_of_loop_load() {
+    TimerInterrupt timer;
+    liveEngine.setTempo(800.0f);  // Clock tick every 3125 us, step every 18750 us
+
+    uint32_t start = nowMicros();
+    liveEngine.start(start);
+    TEST_ASSERT_TRUE(timer.begin(onLiveTick, GRUVBOK::Timing::TICK_ISR_PERIOD_US));
+
+    // Slow, irregular main loop: 0-8 ms per pass
+    uint32_t rng = 7;
+    uint32_t lastTick = 0;
+    uint32_t steps = 0;
+    bool continuous = true;
+    bool onGrid = true;
+
+    while (nowMicros() - start < 600000) {
+        rng = rng * 1664525UL + 1013904223UL;
+        busyWait((rng >> 16) % 8000);
+
+        TickEvent tick;
+        while (liveEngine.poll(tick)) {
+            if (tick.tick != lastTick + GRUVBOK::Timing::TICKS_PER_STEP) continuous = false;
+            lastTick = tick.tick;
+            steps++;
+
+            // Ideal step time, independent of when we got to it
+            uint32_t ideal = start + (uint32_t)(steps * 18750UL);
+            if (tick.time != ideal) onGrid = false;
+        }
+    }
+
+    timer.end();
+    liveEngine.stop();
+
+    TEST_ASSERT_TRUE(continuous);
+    TEST_ASSERT_TRUE(onGrid);
+    TEST_ASSERT_EQUAL(0, liveEngine.getOverflowCount());
+    TEST_ASSERT_TRUE(steps >= 30);  // 600 ms / 18.75 ms = 32
+}
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_queue_fifo_and_capacity);
+#ifndef ARDUINO
+    RUN_TEST(test_queue_concurrent_producer_consumer);
+#endif
+    RUN_TEST(test_engine_idle_until_started);
+    RUN_TEST(test_engine_queues_only_step_ticks);
+    RUN_TEST(test_engine_restart_drops_stale_ticks);
+    RUN_TEST(test_engine_stop_and_overflow);
+    RUN_TEST(test_engine_timing_independent_of_loop_load);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
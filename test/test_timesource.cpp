@@ -0,0 +1,71 @@
+#include <unity.h>
+#include "../src/platform/TimeSource.h"
+
+void test_extender_counts_wraps() {
+    WrapExtender extender;
+
+    TEST_ASSERT_TRUE(extender.extend(0xFFFFFF00) == 0xFFFFFF00ULL);
+    TEST_ASSERT_TRUE(extender.extend(0x00000010) == 0x100000010ULL);   // micros() wrapped
+    TEST_ASSERT_TRUE(extender.extend(0x80000000) == 0x180000000ULL);
+    TEST_ASSERT_TRUE(extender.extend(0x00000000) == 0x200000000ULL);   // And again
+}
+
+void test_extender_is_monotonic_through_many_wraps() {
+    WrapExtender extender;
+
+    // 300 days of uptime read every 20 minutes (about 100 wraps)
+    const uint64_t step = 20ULL * 60 * 1000000;
+    uint64_t previous = 0;
+    for (uint64_t t = 0; t < 300ULL * 24 * 3600 * 1000000; t += step) {
+        uint64_t now = extender.extend((uint32_t)t);
+        TEST_ASSERT_TRUE(now == t);
+        TEST_ASSERT_TRUE(now >= previous);
+        previous = now;
+    }
+}
+
+void test_manual_time_source() {
+    ManualTimeSource clock(1000);
+    TimeSource& source = clock;
+
+    TEST_ASSERT_TRUE(source.now() == 1000);
+    clock.advance(0xFFFFFFFFULL);
+    TEST_ASSERT_TRUE(source.now() == 0x1000003E7ULL);
+    clock.set(5);
+    TEST_ASSERT_TRUE(source.now() == 5);
+}
+
+void test_system_time_source_is_monotonic() {
+    TimeSource& source = SystemTimeSource::instance();
+    uint64_t previous = source.now();
+    for (uint16_t i = 0; i < 1000; i++) {
+        uint64_t now = source.now();
+        TEST_ASSERT_TRUE(now >= previous);
+        previous = now;
+    }
+}
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_extender_counts_wraps);
+    RUN_TEST(test_extender_is_monotonic_through_many_wraps);
+    RUN_TEST(test_manual_time_source);
+    RUN_TEST(test_system_time_source_is_monotonic);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif
@@ -0,0 +1,208 @@
+#include <unity.h>
+#include "../src/sequencer/TimingWheel.h"
+
+// Drain every node due at 'now' into out[], return how many
+static uint8_t drain(TimingWheel<>& wheel, uint32_t now, uint8_t* out) {
+    wheel.advance(now);
+    uint8_t n = 0;
+    uint8_t node;
+    while ((node = wheel.popReady()) != TimingWheel<>::NONE) {
+        out[n++] = node;
+    }
+    return n;
+}
+
+void test_wheel_empty() {
+    TimingWheel<> wheel;
+    uint8_t out[TimingWheel<>::CAPACITY];
+
+    TEST_ASSERT_EQUAL(0, wheel.size());
+    TEST_ASSERT_EQUAL(0, drain(wheel, 100000, out));
+    TEST_ASSERT_EQUAL(TimingWheel<>::NONE, wheel.popReady());
+}
+
+void test_wheel_time_order_across_levels() {
+    TimingWheel<> wheel;
+    wheel.reset(1000);
+    uint8_t out[TimingWheel<>::CAPACITY];
+
+    wheel.insert(0, 1000 + 70000);  // Level 2
+    wheel.insert(1, 1000 + 300);    // Level 1
+    wheel.insert(2, 1000 + 5);      // Level 0
+    wheel.insert(3, 1000 + 300);    // Same time as node 1
+    TEST_ASSERT_EQUAL(4, wheel.size());
+
+    TEST_ASSERT_EQUAL(0, drain(wheel, 1004, out));
+    TEST_ASSERT_EQUAL(1, drain(wheel, 1005, out));
+    TEST_ASSERT_EQUAL(2, out[0]);
+
+    TEST_ASSERT_EQUAL(0, drain(wheel, 1299, out));
+    TEST_ASSERT_EQUAL(2, drain(wheel, 1300, out));
+    TEST_ASSERT_EQUAL(1, out[0]);
+    TEST_ASSERT_EQUAL(3, out[1]);
+
+    TEST_ASSERT_EQUAL(0, drain(wheel, 70999, out));
+    TEST_ASSERT_EQUAL(1, drain(wheel, 71000, out));
+    TEST_ASSERT_EQUAL(0, out[0]);
+    TEST_ASSERT_EQUAL(0, wheel.size());
+}
+
+void test_wheel_fifo_after_cascade() {
+    TimingWheel<> wheel;
+    wheel.reset(0);
+    uint8_t out[TimingWheel<>::CAPACITY];
+
+    // Node 0 goes in an outer bucket; once the cursor is close, node 1 at
+    // the same time would land on an inner level. It must not overtake.
+    wheel.insert(0, 600);
+    drain(wheel, 511, out);  // Cursor lands exactly on the outer bucket start
+    wheel.insert(1, 600);
+    wheel.insert(2, 599);
+
+    TEST_ASSERT_EQUAL(3, drain(wheel, 600, out));
+    TEST_ASSERT_EQUAL(2, out[0]);
+    TEST_ASSERT_EQUAL(0, out[1]);
+    TEST_ASSERT_EQUAL(1, out[2]);
+}
+
+void test_wheel_late_insert_is_ready() {
+    TimingWheel<> wheel;
+    wheel.reset(0);
+    uint8_t out[TimingWheel<>::CAPACITY];
+
+    drain(wheel, 500, out);
+    wheel.insert(4, 400);  // Already passed
+    wheel.insert(5, 500);  // Already processed
+    TEST_ASSERT_EQUAL(2, drain(wheel, 500, out));
+    TEST_ASSERT_EQUAL(4, out[0]);
+    TEST_ASSERT_EQUAL(5, out[1]);
+}
+
+void test_wheel_wraps_32_bit_time() {
+    TimingWheel<> wheel;
+    wheel.reset(0xFFFFFF00UL);
+    uint8_t out[TimingWheel<>::CAPACITY];
+
+    wheel.insert(0, 0x00000010UL);  // After the wrap
+    wheel.insert(1, 0xFFFFFFF0UL);  // Before the wrap
+
+    TEST_ASSERT_EQUAL(1, drain(wheel, 0xFFFFFFFFUL, out));
+    TEST_ASSERT_EQUAL(1, out[0]);
+    TEST_ASSERT_EQUAL(0, drain(wheel, 0x0000000FUL, out));
+    TEST_ASSERT_EQUAL(1, drain(wheel, 0x00000010UL, out));
+    TEST_ASSERT_EQUAL(0, out[0]);
+}
+
+void test_wheel_matches_reference_order() {
+    // Pseudo-random inserts and advances, checked against a brute force
+    // "earliest time, then earliest insertion" search
+    TimingWheel<> wheel;
+    uint32_t refTime[TimingWheel<>::CAPACITY];
+    uint32_t refSeq[TimingWheel<>::CAPACITY];
+    bool used[TimingWheel<>::CAPACITY] = {false};
+    uint32_t seq = 0;
+    uint32_t now = 123456;
+    uint32_t rng = 12345;
+    wheel.reset(now);
+
+    for (uint16_t step = 0; step < 4000; step++) {
+        rng = rng * 1664525UL + 1013904223UL;
+        uint32_t r = rng >> 8;
+
+        if ((r & 1) == 0) {
+            // Insert into the first free node
+            uint8_t node = 0;
+            while (node < TimingWheel<>::CAPACITY && used[node]) node++;
+            if (node == TimingWheel<>::CAPACITY) continue;
+
+            uint32_t spread = (r & 6) == 0 ? 20000000UL : ((r & 6) == 2 ? 70000UL : 300UL);
+            uint32_t time = now + 1 + (r >> 4) % spread;
+            wheel.insert(node, time);
+            used[node] = true;
+            refTime[node] = time;
+            refSeq[node] = seq++;
+        } else {
+            uint32_t jump = (r & 8) ? (r >> 4) % 3000 : (r >> 4) % 3;
+            if ((r & 0xF0) == 0) jump = (r >> 8) % 30000000UL;
+            now += jump;
+            wheel.advance(now);
+
+            uint8_t node;
+            while ((node = wheel.popReady()) != TimingWheel<>::NONE) {
+                // Expected: the earliest remaining reference entry
+                uint8_t expected = TimingWheel<>::NONE;
+                for (uint8_t i = 0; i < TimingWheel<>::CAPACITY; i++) {
+                    if (!used[i]) continue;
+                    if (expected == TimingWheel<>::NONE ||
+                        (int32_t)(refTime[i] - refTime[expected]) < 0 ||
+                        (refTime[i] == refTime[expected] && refSeq[i] < refSeq[expected])) {
+                        expected = i;
+                    }
+                }
+                TEST_ASSERT_EQUAL(expected, node);
+                TEST_ASSERT_TRUE((int32_t)(refTime[node] - now) <= 0);
+                used[node] = false;
+            }
+
+            // Nothing due may be left behind
+            for (uint8_t i = 0; i < TimingWheel<>::CAPACITY; i++) {
+                if (used[i]) {
+                    TEST_ASSERT_TRUE((int32_t)(refTime[i] - now) > 0);
+                }
+            }
+        }
+    }
+}
+
+void test_wheel_remove() {
+    TimingWheel<> wheel;
+    wheel.reset(0);
+    uint8_t out[TimingWheel<>::CAPACITY];
+
+    wheel.insert(0, 10);        // Level 0, shares a bucket with node 1
+    wheel.insert(1, 10);
+    wheel.insert(2, 300);       // Level 1, alone in its bucket
+    wheel.insert(3, 5000000);   // Level 2
+    wheel.insert(4, 20);
+
+    wheel.remove(0);            // Bucket head
+    wheel.remove(2);            // Empties its bucket
+    wheel.remove(3);
+    TEST_ASSERT_EQUAL(2, wheel.size());
+
+    TEST_ASSERT_EQUAL(2, drain(wheel, 10000000, out));
+    TEST_ASSERT_EQUAL(1, out[0]);
+    TEST_ASSERT_EQUAL(4, out[1]);
+    TEST_ASSERT_EQUAL(0, wheel.size());
+
+    // Removing from the ready list
+    wheel.insert(5, 10000000);
+    wheel.insert(6, 10000000);
+    wheel.advance(10000000);
+    wheel.remove(5);
+    TEST_ASSERT_EQUAL(1, drain(wheel, 10000000, out));
+    TEST_ASSERT_EQUAL(6, out[0]);
+
+    // Removed nodes can be reused
+    wheel.insert(2, 10000400);
+    TEST_ASSERT_EQUAL(1, drain(wheel, 10000400, out));
+    TEST_ASSERT_EQUAL(2, out[0]);
+}
+
+void setup() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_wheel_empty);
+    RUN_TEST(test_wheel_time_order_across_levels);
+    RUN_TEST(test_wheel_fifo_after_cascade);
+    RUN_TEST(test_wheel_late_insert_is_ready);
+    RUN_TEST(test_wheel_wraps_32_bit_time);
+    RUN_TEST(test_wheel_matches_reference_order);
+    RUN_TEST(test_wheel_remove);
+
+    UNITY_END();
+}
+
+void loop() {
+    // Nothing to do here
+}
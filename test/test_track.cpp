@@ -84,9 +84,43 @@ void test_track_index_wrapping() {
     TEST_ASSERT_TRUE(track[5 & 0x0F].getSwitch());
 }
 
+void test_track_switch_mask_follows_every_write() {
+    Track track;
+    TEST_ASSERT_EQUAL(0x0000, track.getSwitchMask());
+
+    track[1].setSwitch(true);
+    track.getEvent(15).toggleSwitch();
+    TEST_ASSERT_EQUAL(0x8002, track.getSwitchMask());
+
+    // Pot writes leave the mask alone
+    track[1].setPot(2, 99);
+    TEST_ASSERT_EQUAL(0x8002, track.getSwitchMask());
+
+    // Whole-event writes
+    track[4] = Event(true, 1, 2, 3, 4);
+    track[1].setRaw(0);
+    TEST_ASSERT_EQUAL(0x8010, track.getSwitchMask());
+    track[6] = track[4];
+    track[15].clear();
+    TEST_ASSERT_EQUAL(0x0050, track.getSwitchMask());
+    TEST_ASSERT_EQUAL(3, track[6].getPot(2));
+
+    // Through a held reference, and with a wrapped index
+    EventRef held = track[21];  // Step 5
+    held.toggleSwitch();
+    TEST_ASSERT_EQUAL(0x0070, track.getSwitchMask());
+    TEST_ASSERT_EQUAL(3, track.countActiveEvents());
+
+    // The mask always matches the events
+    for (uint8_t i = 0; i < 16; i++) {
+        const Track& view = track;
+        TEST_ASSERT_EQUAL(view[i].getSwitch(), (track.getSwitchMask() >> i) & 1);
+    }
+}
+
 void test_track_memory_size() {
-    // Track should be 16 events × 4 bytes = 64 bytes
-    TEST_ASSERT_EQUAL(64, sizeof(Track));
+    // Track is 16 events × 4 bytes plus its switch mask (padded): 68 bytes
+    TEST_ASSERT_EQUAL(68, sizeof(Track));
 }
 
 void setup() {
@@ -98,6 +132,7 @@ void setup() {
     RUN_TEST(test_track_count_active_events);
     RUN_TEST(test_track_clear);
     RUN_TEST(test_track_index_wrapping);
+    RUN_TEST(test_track_switch_mask_follows_every_write);
     RUN_TEST(test_track_memory_size);
 
     UNITY_END();
@@ -0,0 +1,133 @@
+#include <unity.h>
+#include "../src/sequencer/VoiceTracker.h"
+
+void test_note_on_and_off() {
+    VoiceTracker voices;
+
+    TEST_ASSERT_EQUAL(VoiceTracker::NONE, voices.noteOn(2, 36));
+    TEST_ASSERT_TRUE(voices.isSounding(2, 36));
+    TEST_ASSERT_FALSE(voices.isSounding(3, 36));
+    TEST_ASSERT_EQUAL(1, voices.getVoiceCount(2));
+
+    TEST_ASSERT_TRUE(voices.noteOff(2, 36));
+    TEST_ASSERT_FALSE(voices.isSounding(2, 36));
+    TEST_ASSERT_EQUAL(0, voices.getTotalVoices());
+}
+
+void test_redundant_off_is_suppressed() {
+    VoiceTracker voices;
+
+    TEST_ASSERT_FALSE(voices.noteOff(1, 60));
+    voices.noteOn(1, 60);
+    TEST_ASSERT_TRUE(voices.noteOff(1, 60));
+    TEST_ASSERT_FALSE(voices.noteOff(1, 60));
+    TEST_ASSERT_EQUAL_UINT32(2, voices.getSuppressedOffCount());
+}
+
+void test_flam_keeps_main_hit_sounding() {
+    VoiceTracker voices;
+
+    // Flam note, then the main hit of the same pitch
+    voices.noteOn(2, 38);
+    voices.noteOn(2, 38);
+    TEST_ASSERT_EQUAL(1, voices.getVoiceCount(2));
+
+    // The short flam off must not cut the main hit
+    TEST_ASSERT_FALSE(voices.noteOff(2, 38));
+    TEST_ASSERT_TRUE(voices.isSounding(2, 38));
+    TEST_ASSERT_TRUE(voices.noteOff(2, 38));
+    TEST_ASSERT_FALSE(voices.isSounding(2, 38));
+}
+
+void test_polyphony_limit_steals_oldest() {
+    VoiceTracker voices;
+    voices.setPolyphony(3);
+
+    voices.noteOn(5, 60);
+    voices.noteOn(5, 64);
+    voices.noteOn(5, 67);
+    TEST_ASSERT_EQUAL(60, voices.noteOn(5, 72));
+    TEST_ASSERT_FALSE(voices.isSounding(5, 60));
+    TEST_ASSERT_EQUAL(3, voices.getVoiceCount(5));
+    TEST_ASSERT_EQUAL_UINT32(1, voices.getStolenVoiceCount());
+
+    // Other channels have their own voices
+    TEST_ASSERT_EQUAL(VoiceTracker::NONE, voices.noteOn(6, 60));
+
+    // The stolen note's own off is now redundant
+    TEST_ASSERT_FALSE(voices.noteOff(5, 60));
+
+    // Releasing a voice frees room without stealing
+    TEST_ASSERT_TRUE(voices.noteOff(5, 64));
+    TEST_ASSERT_EQUAL(VoiceTracker::NONE, voices.noteOn(5, 76));
+    TEST_ASSERT_EQUAL(67, voices.noteOn(5, 79));
+}
+
+void test_polyphony_is_clamped() {
+    VoiceTracker voices;
+    voices.setPolyphony(0);
+    TEST_ASSERT_EQUAL(1, voices.getPolyphony());
+    voices.setPolyphony(200);
+    TEST_ASSERT_EQUAL(VoiceTracker::MAX_VOICES, voices.getPolyphony());
+}
+
+void test_release_next_visits_every_sounding_note() {
+    VoiceTracker voices;
+    voices.noteOn(1, 0);
+    voices.noteOn(1, 127);
+    voices.noteOn(16, 64);
+    voices.noteOn(16, 64);  // Retrigger: still one note to release
+
+    uint8_t channel;
+    uint8_t pitch;
+    TEST_ASSERT_TRUE(voices.releaseNext(channel, pitch));
+    TEST_ASSERT_EQUAL(1, channel);
+    TEST_ASSERT_EQUAL(0, pitch);
+    TEST_ASSERT_TRUE(voices.releaseNext(channel, pitch));
+    TEST_ASSERT_EQUAL(1, channel);
+    TEST_ASSERT_EQUAL(127, pitch);
+    TEST_ASSERT_TRUE(voices.releaseNext(channel, pitch));
+    TEST_ASSERT_EQUAL(16, channel);
+    TEST_ASSERT_EQUAL(64, pitch);
+    TEST_ASSERT_FALSE(voices.releaseNext(channel, pitch));
+    TEST_ASSERT_EQUAL(0, voices.getTotalVoices());
+}
+
+void test_reset_channel() {
+    VoiceTracker voices;
+    voices.noteOn(3, 40);
+    voices.noteOn(4, 40);
+
+    voices.resetChannel(3);
+    TEST_ASSERT_FALSE(voices.isSounding(3, 40));
+    TEST_ASSERT_TRUE(voices.isSounding(4, 40));
+    TEST_ASSERT_FALSE(voices.noteOff(3, 40));
+}
+
+int runTests() {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_note_on_and_off);
+    RUN_TEST(test_redundant_off_is_suppressed);
+    RUN_TEST(test_flam_keeps_main_hit_sounding);
+    RUN_TEST(test_polyphony_limit_steals_oldest);
+    RUN_TEST(test_polyphony_is_clamped);
+    RUN_TEST(test_release_next_visits_every_sounding_note);
+    RUN_TEST(test_reset_channel);
+
+    return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+    runTests();
+}
+
+void loop() {
+    // Nothing to do here
+}
+#else
+int main() {
+    return runTests();
+}
+#endif